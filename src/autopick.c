@@ -125,6 +125,8 @@ enum _keyword_e {
 #define FLG_NOUN_END            (FLG_MAX - 1)
 
 
+static void _autopick_stale(void);
+
 static char KEY_ALL[] = "all";
 
 static char KEY_UNSENSED[] = "unsensed";
@@ -837,6 +839,7 @@ static void init_autopick(void)
         autopick_free_entry(&autopick_list[i]);
 
     max_autopick = 0;
+    _autopick_stale();
 
     /* There is always one entry "=g" */
     autopick_new_entry(&entry, easy_autopick_inscription, TRUE);
@@ -943,6 +946,7 @@ static void add_autopick_list(autopick_type *entry)
     autopick_list[max_autopick] = *entry;
 
     max_autopick++;
+    _autopick_stale();
 }
 
 
@@ -1238,10 +1242,8 @@ static bool _string_match(cptr source, cptr pattern)
     assert(!_string_match("wand of light", "^wand of lightning balls$"));
 */
 
-static bool is_autopick_aux(object_type *o_ptr, autopick_type *entry, cptr o_name)
+static bool _is_autopick_static(object_type *o_ptr, autopick_type *entry, cptr o_name)
 {
-    int j;
-
     /*** Unaware items ***/
     if (IS_FLG(FLG_UNAWARE) && _is_aware(o_ptr))
         return FALSE;
@@ -1606,10 +1608,6 @@ static bool is_autopick_aux(object_type *o_ptr, autopick_type *entry, cptr o_nam
     if (IS_FLG(FLG_COMMON) && object_is_rare(o_ptr))
         return FALSE;
 
-    /*** Wanted monster's corpse/skeletons ***/
-    if (IS_FLG(FLG_WANTED) && !object_is_shoukinkubi(o_ptr))
-        return FALSE;
-
     /*** Unique monster's corpse/skeletons/statues ***/
     if (IS_FLG(FLG_UNIQUE) &&
         ((o_ptr->tval != TV_CORPSE && o_ptr->tval != TV_STATUE) ||
@@ -1798,8 +1796,23 @@ static bool is_autopick_aux(object_type *o_ptr, autopick_type *entry, cptr o_nam
             return FALSE;
     }
 
-    /* Search-String */
-    if (!_string_match(o_name, entry->name))
+    /* Search-String (already matched if there is no name) */
+    if (o_name && !_string_match(o_name, entry->name))
+        return FALSE;
+
+    return TRUE;
+}
+
+/*
+ * The tests which depend on the pack and the bounties rather than on
+ * the object alone, so is_autopick() can never cache their answers
+ */
+static bool _is_autopick_now(object_type *o_ptr, autopick_type *entry)
+{
+    int j;
+
+    /*** Wanted monster's corpse/skeletons ***/
+    if (IS_FLG(FLG_WANTED) && !object_is_shoukinkubi(o_ptr))
         return FALSE;
 
     /* TRUE when it need not to be 'collecting' */
@@ -1823,14 +1836,447 @@ static bool is_autopick_aux(object_type *o_ptr, autopick_type *entry, cptr o_nam
     return FALSE;
 }
 
+static bool is_autopick_aux(object_type *o_ptr, autopick_type *entry, cptr o_name)
+{
+    return _is_autopick_static(o_ptr, entry, o_name) && _is_autopick_now(o_ptr, entry);
+}
+
+/*
+ * The rules compiled for is_autopick()
+ *
+ * Only the rules that could match an object's tval are tried, and the
+ * search strings of all of them are found with one pass over the name
+ * (an Aho-Corasick automaton) before any of the other tests. The answer
+ * is kept in a cache under a key made of everything it depends on, and a
+ * hit must match the whole key, so an answer is only worked out again
+ * once the object, the rules or the player change. Rules which also look
+ * at the pack or at the bounties can't be answered once and for all: the
+ * cache notes which of them would otherwise match, and only those are
+ * tried again.
+ *
+ * Any change to autopick_list[] must call _autopick_stale().
+ */
+typedef struct {
+    cptr text;          /* Search string, without the anchors */
+    int  len;
+    bool start;         /* Anchored with '^' */
+    bool end;           /* Anchored with '$' */
+    int  now;           /* Rank among the rules which need _is_autopick_now(), or -1 */
+} _rule_t;
+
+#define _NOW_MAX 32
+
+/* The cache: each key has one place, found from its hash */
+#define _NAME_WORDS 8
+#define _KEY_MAX   (21 + 3 * OF_ARRAY_SIZE + _NAME_WORDS)
+#define _CACHE_MAX 1024
+
+typedef struct {
+    u32b key[_KEY_MAX];
+    u32b now;           /* The earlier rules which depend on the pack */
+    int  idx;           /* The first rule which matches for good, or -1 */
+} _cache_t;
+
+static _cache_t _ap_cache[_CACHE_MAX];
+
+static bool     _ap_stale = TRUE;
+static u32b     _ap_stamp = 0;
+static int      _ap_rules_max = 0;
+static _rule_t *_ap_rules = NULL;
+static u32b    *_ap_hits = NULL;      /* Rules whose search string matched */
+static int      _ap_now_rules[_NOW_MAX];
+
+static int      _ap_tval_first[257];  /* Candidate rules for each tval ... */
+static int     *_ap_tval_rules = NULL;
+static int      _ap_tval_max = 0;
+
+static byte     _ap_sym[256];         /* Character to symbol (0 = in no rule) */
+static int      _ap_syms = 0;
+static int      _ap_states = 0;
+static int     *_ap_next = NULL;      /* Transitions, _ap_syms per state */
+static int     *_ap_out = NULL;       /* First rule ending at each state */
+static int     *_ap_out_next = NULL;  /* Next rule ending at the same state */
+static int     *_ap_dict = NULL;      /* Next suffix state with any rule */
+
+static void _autopick_stale(void)
+{
+    _ap_stale = TRUE;
+}
+
+static void _autopick_free_compiled(void)
+{
+    if (_ap_rules)
+    {
+        C_KILL(_ap_rules, _ap_rules_max, _rule_t);
+        C_KILL(_ap_hits, (_ap_rules_max + 31) / 32, u32b);
+        C_KILL(_ap_out_next, _ap_rules_max, int);
+    }
+    if (_ap_tval_rules) C_KILL(_ap_tval_rules, _ap_tval_max, int);
+    if (_ap_next)
+    {
+        C_KILL(_ap_next, _ap_states * _ap_syms, int);
+        C_KILL(_ap_out, _ap_states, int);
+        C_KILL(_ap_dict, _ap_states, int);
+    }
+    _ap_rules = NULL;
+    _ap_tval_rules = NULL;
+    _ap_next = NULL;
+}
+
+/*
+ * Mark the tvals a rule could possibly match. This only has to allow
+ * everything is_autopick_aux() might, so the nouns that depend on more
+ * than the tval allow all of them.
+ */
+static void _autopick_tvals(autopick_type *entry, bool *ok)
+{
+    int tv;
+
+    for (tv = 0; tv < 256; tv++)
+    {
+        bool b = TRUE;
+
+        if (IS_FLG(FLG_WEAPONS)) b = (TV_DIGGING <= tv && tv <= TV_SWORD);
+        else if (IS_FLG(FLG_FAVORITE_WEAPONS)) b = TRUE;
+        else if (IS_FLG(FLG_HAFTED)) b = (tv == TV_HAFTED);
+        else if (IS_FLG(FLG_DIGGERS)) b = (tv == TV_DIGGING);
+        else if (IS_FLG(FLG_SHOOTERS)) b = (tv == TV_BOW);
+        else if (IS_FLG(FLG_AMMO)) b = (TV_MISSILE_BEGIN <= tv && tv <= TV_MISSILE_END);
+        else if (IS_FLG(FLG_ARMORS)) b = (TV_ARMOR_BEGIN <= tv && tv <= TV_ARMOR_END);
+        else if (IS_FLG(FLG_SHIELDS)) b = (tv == TV_SHIELD);
+        else if (IS_FLG(FLG_SUITS)) b = (tv == TV_DRAG_ARMOR || tv == TV_HARD_ARMOR || tv == TV_SOFT_ARMOR);
+        else if (IS_FLG(FLG_CLOAKS)) b = (tv == TV_CLOAK);
+        else if (IS_FLG(FLG_HELMS)) b = (tv == TV_CROWN || tv == TV_HELM);
+        else if (IS_FLG(FLG_GLOVES)) b = (tv == TV_GLOVES);
+        else if (IS_FLG(FLG_BOOTS)) b = (tv == TV_BOOTS);
+        else if (IS_FLG(FLG_LIGHTS)) b = (tv == TV_LITE);
+        else if (IS_FLG(FLG_RINGS)) b = (tv == TV_RING);
+        else if (IS_FLG(FLG_AMULETS)) b = (tv == TV_AMULET);
+        else if (IS_FLG(FLG_WANDS)) b = (tv == TV_WAND);
+        else if (IS_FLG(FLG_STAVES)) b = (tv == TV_STAFF);
+        else if (IS_FLG(FLG_RODS)) b = (tv == TV_ROD);
+        else if (IS_FLG(FLG_POTIONS)) b = (tv == TV_POTION);
+        else if (IS_FLG(FLG_SCROLLS)) b = (tv == TV_SCROLL);
+        else if (IS_FLG(FLG_JUNKS)) b = (tv == TV_SKELETON || tv == TV_BOTTLE || tv == TV_JUNK || tv == TV_STATUE);
+        else if (IS_FLG(FLG_CORPSES)) b = (tv == TV_CORPSE);
+        else if (IS_FLG(FLG_SKELETONS)) b = (tv == TV_CORPSE || tv == TV_SKELETON);
+        else if (IS_FLG(FLG_SPELLBOOKS)) b = (tv >= TV_LIFE_BOOK);
+
+        /* Adjectives which only fit some tvals */
+        if (IS_FLG(FLG_UNREADABLE) || IS_FLG(FLG_REALM1) || IS_FLG(FLG_REALM2) ||
+            IS_FLG(FLG_FIRST) || IS_FLG(FLG_SECOND) || IS_FLG(FLG_THIRD) || IS_FLG(FLG_FOURTH))
+        {
+            if (tv < TV_LIFE_BOOK) b = FALSE;
+        }
+        if (IS_FLG(FLG_UNIQUE) && tv != TV_CORPSE && tv != TV_STATUE) b = FALSE;
+        if (IS_FLG(FLG_HUMAN) && tv != TV_CORPSE) b = FALSE;
+        if (IS_FLG(FLG_WANTED) && tv != TV_CORPSE) b = FALSE;
+        if (tv == TV_GOLD) b = FALSE;
+
+        ok[tv] = b;
+    }
+}
+
+static void _autopick_compile(void)
+{
+    int  i, s, sym, tv, total = 1, now = 0, head = 0, tail = 0;
+    int *fail, *queue;
+    bool ok[256];
+
+    _autopick_free_compiled();
+    _ap_stale = FALSE;
+    _ap_stamp++;
+
+    _ap_rules_max = MAX(1, max_autopick);
+    C_MAKE(_ap_rules, _ap_rules_max, _rule_t);
+    C_MAKE(_ap_hits, (_ap_rules_max + 31) / 32, u32b);
+    C_MAKE(_ap_out_next, _ap_rules_max, int);
+
+    /* Parse the search strings, and give their characters symbols */
+    C_WIPE(_ap_sym, 256, byte);
+    _ap_syms = 1;
+    for (i = 0; i < max_autopick; i++)
+    {
+        _rule_t *rule = &_ap_rules[i];
+        cptr     p = autopick_list[i].name;
+        autopick_type *entry = &autopick_list[i];
+
+        if (*p == '^')
+        {
+            rule->start = TRUE;
+            p++;
+        }
+        rule->text = p;
+        for (rule->len = 0; p[rule->len] && p[rule->len] != '$'; rule->len++)
+        {
+            int c = tolower((byte)p[rule->len]);
+
+            if (!_ap_sym[c])
+            {
+                _ap_sym[c] = _ap_syms;
+                _ap_sym[toupper(c)] = _ap_syms;
+                _ap_syms++;
+            }
+        }
+        rule->end = (p[rule->len] == '$');
+        rule->now = -1;
+        if (IS_FLG(FLG_COLLECTING) || IS_FLG(FLG_WANTED))
+        {
+            rule->now = now++;
+            if (rule->now < _NOW_MAX) _ap_now_rules[rule->now] = i;
+        }
+        total += rule->len;
+    }
+
+    /* The trie (0 is the root, and so never the target of an edge) */
+    C_MAKE(_ap_next, total * _ap_syms, int);
+    C_MAKE(_ap_out, total, int);
+    C_MAKE(_ap_dict, total, int);
+    for (s = 0; s < total; s++) _ap_out[s] = -1;
+    _ap_states = 1;
+    for (i = max_autopick - 1; i >= 0; i--)
+    {
+        _rule_t *rule = &_ap_rules[i];
+        int      j;
+
+        _ap_out_next[i] = -1;
+        if (!rule->len) continue;
+        for (s = 0, j = 0; j < rule->len; j++)
+        {
+            int *t = &_ap_next[s * _ap_syms + _ap_sym[(byte)rule->text[j]]];
+
+            if (!*t) *t = _ap_states++;
+            s = *t;
+        }
+        _ap_out_next[i] = _ap_out[s];
+        _ap_out[s] = i;
+    }
+
+    /* Failure links, breadth first, folded into the transitions */
+    C_MAKE(fail, total, int);
+    C_MAKE(queue, total, int);
+    _ap_dict[0] = -1;
+    for (sym = 1; sym < _ap_syms; sym++)
+    {
+        if (_ap_next[sym]) queue[tail++] = _ap_next[sym];
+    }
+    while (head < tail)
+    {
+        s = queue[head++];
+        _ap_dict[s] = (_ap_out[fail[s]] >= 0) ? fail[s] : _ap_dict[fail[s]];
+        for (sym = 1; sym < _ap_syms; sym++)
+        {
+            int *t = &_ap_next[s * _ap_syms + sym];
+            int  f = _ap_next[fail[s] * _ap_syms + sym];
+
+            if (*t)
+            {
+                fail[*t] = f;
+                queue[tail++] = *t;
+            }
+            else *t = f;
+        }
+    }
+    C_KILL(fail, total, int);
+    C_KILL(queue, total, int);
+
+    /* Keep the whole allocation size around for C_KILL */
+    _ap_states = total;
+
+    /* The candidate rules for each tval, in order */
+    C_WIPE(_ap_tval_first, 257, int);
+    for (i = 0; i < max_autopick; i++)
+    {
+        _autopick_tvals(&autopick_list[i], ok);
+        for (tv = 0; tv < 256; tv++) if (ok[tv]) _ap_tval_first[tv + 1]++;
+    }
+    for (tv = 0; tv < 256; tv++) _ap_tval_first[tv + 1] += _ap_tval_first[tv];
+    _ap_tval_max = MAX(1, _ap_tval_first[256]);
+    C_MAKE(_ap_tval_rules, _ap_tval_max, int);
+    {
+        int fill[256];
+
+        for (tv = 0; tv < 256; tv++) fill[tv] = _ap_tval_first[tv];
+        for (i = 0; i < max_autopick; i++)
+        {
+            _autopick_tvals(&autopick_list[i], ok);
+            for (tv = 0; tv < 256; tv++) if (ok[tv]) _ap_tval_rules[fill[tv]++] = i;
+        }
+    }
+}
+
+/*
+ * Find every rule whose search string matches the (lower case) name,
+ * just like _string_match()
+ */
+static void _autopick_match_names(cptr name)
+{
+    int n = strlen(name);
+    int pos, s = 0;
+
+    C_WIPE(_ap_hits, (_ap_rules_max + 31) / 32, u32b);
+
+    for (pos = 0; pos < n; pos++)
+    {
+        int t;
+
+        s = _ap_next[s * _ap_syms + _ap_sym[(byte)name[pos]]];
+        for (t = s; t > 0; t = _ap_dict[t])
+        {
+            int i;
+
+            for (i = _ap_out[t]; i >= 0; i = _ap_out_next[i])
+            {
+                _rule_t *rule = &_ap_rules[i];
+
+                if (rule->start && pos + 1 != rule->len) continue;
+                if (rule->end && pos + 1 != n) continue;
+                _ap_hits[i / 32] |= 1UL << (i % 32);
+            }
+        }
+    }
+}
+
+static bool _autopick_name_hit(int i, cptr name)
+{
+    _rule_t *rule = &_ap_rules[i];
+
+    if (rule->len) return (_ap_hits[i / 32] & (1UL << (i % 32))) ? TRUE : FALSE;
+
+    /* An empty search string: see _string_match() */
+    if (rule->start) return (!rule->end || !*name);
+    return (!rule->end && *name);
+}
+
+/*
+ * Everything the answer for an object depends on, except the pack and
+ * the bounties: the fields of the object that the rules, its value and
+ * its name read (not its marks or place), the rules, what the player
+ * knows about its kind, ego or artifact, and who the player is. Unused
+ * words are left zero, so keys can be compared whole.
+ */
+static void _autopick_key(object_type *o_ptr, u32b key[_KEY_MAX])
+{
+    object_kind *k_ptr = &k_info[o_ptr->k_idx];
+    int          i, n = 0;
+
+    C_WIPE(key, _KEY_MAX, u32b);
+
+    key[n++] = _ap_stamp;
+    key[n++] = o_ptr->k_idx;
+    key[n++] = o_ptr->tval | (o_ptr->sval << 8) | (o_ptr->number << 16) | (o_ptr->discount << 24);
+    key[n++] = (u16b)o_ptr->pval | ((u32b)(u16b)o_ptr->weight << 16);
+    key[n++] = (u16b)o_ptr->name1 | ((u32b)(u16b)o_ptr->name2 << 16);
+    key[n++] = (u16b)o_ptr->name3 | ((u32b)o_ptr->art_name << 16);
+    key[n++] = o_ptr->xtra3 | ((u32b)(u16b)o_ptr->xtra4 << 8);
+    key[n++] = (u32b)o_ptr->xtra5;
+    key[n++] = (u16b)o_ptr->timeout;
+    key[n++] = (u16b)o_ptr->to_h | ((u32b)(u16b)o_ptr->to_d << 16);
+    key[n++] = (u16b)o_ptr->to_a | ((u32b)(u16b)o_ptr->ac << 16);
+    key[n++] = o_ptr->dd | (o_ptr->ds << 8) | ((u32b)(u16b)o_ptr->mult << 16);
+    key[n++] = o_ptr->ident | (o_ptr->feeling << 8) | ((u32b)o_ptr->inscription << 16);
+    for (i = 0; i < OF_ARRAY_SIZE; i++)
+    {
+        key[n++] = o_ptr->flags[i];
+        key[n++] = o_ptr->known_flags[i];
+    }
+    key[n++] = o_ptr->curse_flags;
+    key[n++] = o_ptr->known_curse_flags;
+    key[n++] = o_ptr->rune;
+    key[n++] = (u16b)o_ptr->activation.type | (o_ptr->activation.power << 16) | ((u32b)o_ptr->activation.difficulty << 24);
+    key[n++] = (u16b)o_ptr->activation.cost | ((u32b)(u16b)o_ptr->activation.extra << 16);
+
+    /* Lore: identified egos and artifacts show only the flags learned */
+    key[n++] = (k_ptr->aware ? 1 : 0) | (k_ptr->tried ? 2 : 0) | (plain_descriptions ? 4 : 0);
+    if (object_is_fixed_artifact(o_ptr))
+    {
+        for (i = 0; i < OF_ARRAY_SIZE; i++)
+            key[n + i] = a_info[o_ptr->name1].known_flags[i];
+    }
+    else if (object_is_ego(o_ptr))
+    {
+        for (i = 0; i < OF_ARRAY_SIZE; i++)
+            key[n + i] = e_info[o_ptr->name2].known_flags[i];
+    }
+    n += OF_ARRAY_SIZE;
+
+    /* Smiths sign their work */
+    if (object_is_smith(o_ptr))
+    {
+        char *name = (char *)&key[n];
+
+        for (i = 0; i < _NAME_WORDS * 4 - 1 && player_name[i]; i++)
+            name[i] = player_name[i];
+    }
+    n += _NAME_WORDS;
+
+    key[n++] = p_ptr->prace | (p_ptr->pclass << 8) | (p_ptr->psubclass << 16);
+    key[n++] = p_ptr->realm1 | (p_ptr->realm2 << 8) | ((u32b)(u16b)p_ptr->current_r_idx << 16);
+
+    assert(n <= _KEY_MAX);
+}
+
+static _cache_t *_autopick_cache_find(const u32b key[_KEY_MAX])
+{
+    u32b h = 2166136261UL;
+    int  i;
+
+    for (i = 0; i < _KEY_MAX; i++)
+        h = (h ^ key[i]) * 16777619UL;
+    return &_ap_cache[(h ^ (h >> 16)) % _CACHE_MAX];
+}
+
+/*
+ * Forget every cached answer (for the benchmarks)
+ */
+void autopick_forget(void)
+{
+    _ap_stamp++;
+}
+
+/*
+ * The first of the noted rules which matches right now, or else idx
+ * (only rules before idx are ever noted)
+ */
+static int _autopick_resolve(object_type *o_ptr, u32b now, int idx)
+{
+    int rank;
+
+    for (rank = 0; now; rank++, now >>= 1)
+    {
+        if ((now & 1) && _is_autopick_now(o_ptr, &autopick_list[_ap_now_rules[rank]]))
+            return _ap_now_rules[rank];
+    }
+    return idx;
+}
+
+/*
+ * The plain way to find the first matching rule, trying them all in
+ * order (see autopick_verify())
+ */
+static int _is_autopick_scan(object_type *o_ptr, cptr o_name)
+{
+    int i;
+
+    for (i = 0; i < max_autopick; i++)
+    {
+        if (is_autopick_aux(o_ptr, &autopick_list[i], o_name))
+            return i;
+    }
+    return -1;
+}
+
 /*
  * A function for Auto-picker/destroyer
  * Examine whether the object matches to the list of keywords or not.
  */
 int is_autopick(object_type *o_ptr)
 {
-    int i;
-    char o_name[MAX_NLEN];
+    int       i, result = -1;
+    bool      cache = TRUE;
+    u32b      key[_KEY_MAX], now = 0;
+    _cache_t *entry;
+    char      o_name[MAX_NLEN];
 
     if (o_ptr->tval == TV_GOLD) return -1;
 
@@ -1845,23 +2291,83 @@ int is_autopick(object_type *o_ptr)
         return 0;
     }
 
+    if (_ap_stale) _autopick_compile();
+
+    /* Asked before? */
+    _autopick_key(o_ptr, key);
+    entry = _autopick_cache_find(key);
+    if (!memcmp(entry->key, key, sizeof(key)))
+        return _autopick_resolve(o_ptr, entry->now, entry->idx);
+
     /* Prepare object name string first */
     object_desc(o_name, o_ptr, (OD_NAME_ONLY | OD_NO_FLAVOR | OD_OMIT_PREFIX | OD_NO_PLURAL));
 
     /* Convert the string to lower case */
     str_tolower(o_name);
 
-    /* Look for a matching entry in the list */
-    for (i=0; i < max_autopick; i++)
+    /* Look for the first entry in the list which matches for good, noting
+     * the ones before it which only might */
+    _autopick_match_names(o_name);
+    for (i = _ap_tval_first[o_ptr->tval]; i < _ap_tval_first[o_ptr->tval + 1]; i++)
     {
-        autopick_type *entry = &autopick_list[i];
+        int      idx = _ap_tval_rules[i];
+        _rule_t *rule = &_ap_rules[idx];
 
-        if (is_autopick_aux(o_ptr, entry, o_name))
-            return i;
+        if (!_autopick_name_hit(idx, o_name)) continue;
+        if (!_is_autopick_static(o_ptr, &autopick_list[idx], NULL)) continue;
+
+        if (rule->now < 0)
+        {
+            result = idx;
+            break;
+        }
+        if (rule->now < _NOW_MAX)
+        {
+            now |= 1UL << rule->now;
+            continue;
+        }
+
+        /* Too many to note: answer this once without the cache */
+        cache = FALSE;
+        if (_is_autopick_now(o_ptr, &autopick_list[idx]))
+        {
+            result = idx;
+            break;
+        }
     }
 
-    /* No matching entry */
-    return -1;
+    if (cache)
+    {
+        C_COPY(entry->key, key, _KEY_MAX, u32b);
+        entry->now = now;
+        entry->idx = result;
+    }
+
+    return _autopick_resolve(o_ptr, now, result);
+}
+
+/*
+ * Check is_autopick() against trying every rule in order, for every
+ * object on the level and in the pack. Returns the number of objects
+ * for which they differ.
+ */
+int autopick_verify(void)
+{
+    int  i, bad = 0;
+    char o_name[MAX_NLEN];
+
+    for (i = 1; i < o_max + pack_max(); i++)
+    {
+        object_type *o_ptr = (i < o_max) ? &o_list[i] : pack_obj(i - o_max + 1);
+
+        if (!o_ptr || !o_ptr->k_idx || o_ptr->tval == TV_GOLD) continue;
+        if (o_ptr->inscription && my_strstr(quark_str(o_ptr->inscription), "=g")) continue;
+
+        object_desc(o_name, o_ptr, (OD_NAME_ONLY | OD_NO_FLAVOR | OD_OMIT_PREFIX | OD_NO_PLURAL));
+        str_tolower(o_name);
+        if (is_autopick(o_ptr) != _is_autopick_scan(o_ptr, o_name)) bad++;
+    }
+    return bad;
 }
 
 
@@ -1981,14 +2487,22 @@ static void msg_autopick(int idx, cptr action)
     }
 }
 
+static object_type autopick_last_destroyed_object;
+
+/*
+ * The objects kept here (see quark_collect())
+ */
+void autopick_for_each_obj(obj_f f)
+{
+    if (autopick_last_destroyed_object.k_idx) f(&autopick_last_destroyed_object);
+}
+
 /*
  * Automatically destroy an item if it is to be destroyed
  *
  * When always_pickup is 'yes', we disable auto-destroyer function of
  * auto-picker/destroyer, and do only easy-auto-destroyer.
  */
-static object_type autopick_last_destroyed_object;
-
 static void auto_destroy_obj(object_type *o_ptr, int autopick_idx)
 {
     bool destroy = FALSE;
@@ -115,6 +115,75 @@ bool is_hidden_door(cave_type *c_ptr)
 }
 
 
+/*
+ * Memo of recent "projectable()" and long range "los()" answers.
+ *
+ * Both depend only on the end points, the range and the terrain in between
+ * (never on monsters or the player), so an answer stays good until some grid
+ * changes its FF_LOS or FF_PROJECT flag. Rather than track which paths
+ * cross which grids, any such change simply starts a new epoch, which
+ * invalidates every entry at once. Monsters and the player moving about
+ * only change which entries get asked for.
+ *
+ * The memo is only used once the dungeon is complete, since level
+ * generation writes the terrain directly.
+ */
+#define LOS_MEMO_SIZE 4096
+#define LOS_MEMO_LOS  0x80000000UL
+
+typedef struct los_memo_type los_memo_type;
+struct los_memo_type
+{
+    u32b key;
+    u32b epoch;
+    s16b range;
+    bool result;
+};
+
+static los_memo_type los_memo[LOS_MEMO_SIZE];
+static u32b los_memo_epoch = 1;
+
+#define los_memo_key(Y1,X1,Y2,X2) \
+    (((u32b)(Y1) << 23) | ((u32b)(X1) << 15) | ((u32b)(Y2) << 8) | (u32b)(X2))
+
+static los_memo_type *los_memo_find(u32b key, int range)
+{
+    u32b hash = (u32b)((key ^ (u32b)range) * 2654435761UL) >> 20;
+    los_memo_type *m_ptr = &los_memo[hash & (LOS_MEMO_SIZE - 1)];
+
+    if ((m_ptr->epoch == los_memo_epoch) && (m_ptr->key == key) && (m_ptr->range == range))
+    {
+        los_memo_hits++;
+        return m_ptr;
+    }
+
+    los_memo_misses++;
+    m_ptr->key = key;
+    m_ptr->range = range;
+    m_ptr->epoch = 0;
+    return m_ptr;
+}
+
+static void los_memo_save(los_memo_type *m_ptr, bool result)
+{
+    m_ptr->result = result;
+    m_ptr->epoch = los_memo_epoch;
+}
+
+/*
+ * Forget every memorized answer (the terrain changed)
+ */
+void los_memo_wipe(void)
+{
+    /* Epoch zero marks unused entries */
+    if (!++los_memo_epoch)
+    {
+        C_WIPE(los_memo, LOS_MEMO_SIZE, los_memo_type);
+        los_memo_epoch = 1;
+    }
+}
+
+
 /*
  * A simple, fast, integer-based line-of-sight algorithm. By Joseph Hall,
  * 4116 Brewster Drive, Raleigh NC 27606. Email to jnh@ecemwl.ncsu.edu.
@@ -150,7 +219,7 @@ bool is_hidden_door(cave_type *c_ptr)
  *
  * Use the "update_view()" function to determine player line-of-sight.
  */
-bool los(int y1, int x1, int y2, int x2)
+static bool los_aux(int y1, int x1, int y2, int x2)
 {
     /* Delta */
     int dx, dy;
@@ -373,6 +442,235 @@ bool los(int y1, int x1, int y2, int x2)
 }
 
 
+/*
+ * Precomputed "los()" paths for every offset within MAX_SIGHT.
+ *
+ * The grids which "los_aux()" examines depend only on the offset between
+ * the two end points, never on what it finds on the way, so we walk each
+ * offset once and record the grids in the order they are examined. A query
+ * then reduces to testing the recorded grids until one of them blocks.
+ *
+ * Each grid is stored as (dy + MAX_SIGHT, dx + MAX_SIGHT). The path for
+ * offset "i" occupies los_path_y/x[los_path_start[i]..los_path_start[i+1]).
+ * For the "knight's moves" los_path_knight_y/x hold the single grid which,
+ * if open, grants los at once (otherwise the path decides), and 255 means
+ * there is no such grid.
+ */
+#define LOS_SPAN (2 * MAX_SIGHT + 1)
+#define LOS_IDX(DY,DX) (((DY) + MAX_SIGHT) * LOS_SPAN + ((DX) + MAX_SIGHT))
+#define LOS_PATH_MAX (LOS_SPAN * LOS_SPAN * MAX_SIGHT * 2)
+
+static bool los_path_ready = FALSE;
+static s32b los_path_start[LOS_SPAN * LOS_SPAN + 1];
+static byte los_path_y[LOS_PATH_MAX];
+static byte los_path_x[LOS_PATH_MAX];
+static byte los_path_knight_y[LOS_SPAN * LOS_SPAN];
+static byte los_path_knight_x[LOS_SPAN * LOS_SPAN];
+
+#define los_path_push(Y,X) \
+{\
+    los_path_y[n] = (byte)((Y) + MAX_SIGHT); \
+    los_path_x[n] = (byte)((X) + MAX_SIGHT); \
+    n++; \
+}
+
+/*
+ * Record the grids "los_aux(0, 0, dy, dx)" would examine.
+ * This must step exactly like "los_aux()" above.
+ */
+static s32b los_path_walk(int dy, int dx, s32b n)
+{
+    int ax = ABS(dx), ay = ABS(dy);
+    int sx = (dx < 0) ? -1 : 1;
+    int sy = (dy < 0) ? -1 : 1;
+    int qx, qy, tx, ty, f1, f2, m;
+
+    /* Adjacent (or identical) grids */
+    if ((ax < 2) && (ay < 2)) return n;
+
+    /* Directly South/North */
+    if (!dx)
+    {
+        for (ty = sy; ty != dy; ty += sy) los_path_push(ty, 0);
+        return n;
+    }
+
+    /* Directly East/West */
+    if (!dy)
+    {
+        for (tx = sx; tx != dx; tx += sx) los_path_push(0, tx);
+        return n;
+    }
+
+    f2 = (ax * ay);
+    f1 = f2 << 1;
+
+    /* Travel horizontally */
+    if (ax >= ay)
+    {
+        qy = ay * ay;
+        m = qy << 1;
+        tx = sx;
+        if (qy == f2)
+        {
+            ty = sy;
+            qy -= f1;
+        }
+        else
+        {
+            ty = 0;
+        }
+
+        while (dx - tx)
+        {
+            los_path_push(ty, tx);
+            qy += m;
+            if (qy < f2)
+            {
+                tx += sx;
+            }
+            else if (qy > f2)
+            {
+                ty += sy;
+                los_path_push(ty, tx);
+                qy -= f1;
+                tx += sx;
+            }
+            else
+            {
+                ty += sy;
+                qy -= f1;
+                tx += sx;
+            }
+        }
+    }
+
+    /* Travel vertically */
+    else
+    {
+        qx = ax * ax;
+        m = qx << 1;
+        ty = sy;
+        if (qx == f2)
+        {
+            tx = sx;
+            qx -= f1;
+        }
+        else
+        {
+            tx = 0;
+        }
+
+        while (dy - ty)
+        {
+            los_path_push(ty, tx);
+            qx += m;
+            if (qx < f2)
+            {
+                ty += sy;
+            }
+            else if (qx > f2)
+            {
+                tx += sx;
+                los_path_push(ty, tx);
+                qx -= f1;
+                ty += sy;
+            }
+            else
+            {
+                tx += sx;
+                qx -= f1;
+                ty += sy;
+            }
+        }
+    }
+
+    return n;
+}
+
+static void los_path_init(void)
+{
+    int dy, dx;
+    s32b n = 0;
+
+    for (dy = -MAX_SIGHT; dy <= MAX_SIGHT; dy++)
+    {
+        for (dx = -MAX_SIGHT; dx <= MAX_SIGHT; dx++)
+        {
+            int i = LOS_IDX(dy, dx);
+
+            los_path_knight_y[i] = los_path_knight_x[i] = 255;
+            if ((ABS(dx) == 1) && (ABS(dy) == 2))
+            {
+                los_path_knight_y[i] = dy / 2 + MAX_SIGHT;
+                los_path_knight_x[i] = MAX_SIGHT;
+            }
+            else if ((ABS(dy) == 1) && (ABS(dx) == 2))
+            {
+                los_path_knight_y[i] = MAX_SIGHT;
+                los_path_knight_x[i] = dx / 2 + MAX_SIGHT;
+            }
+
+            los_path_start[i] = n;
+            n = los_path_walk(dy, dx, n);
+        }
+    }
+    los_path_start[LOS_SPAN * LOS_SPAN] = n;
+    assert(n <= LOS_PATH_MAX);
+
+    los_path_ready = TRUE;
+}
+
+
+/*
+ * Determine if a line of sight can be traced from (y1,x1) to (y2,x2).
+ * See "los_aux()" for the algorithm; nearby grids use the paths above.
+ * With "arg_reference", every answer is worked out by "los_aux()".
+ */
+bool los(int y1, int x1, int y2, int x2)
+{
+    int dy = y2 - y1;
+    int dx = x2 - x1;
+    int i;
+    s32b n, end;
+
+    if (arg_reference) return los_aux(y1, x1, y2, x2);
+
+    if ((ABS(dy) > MAX_SIGHT) || (ABS(dx) > MAX_SIGHT))
+    {
+        los_memo_type *m_ptr;
+        bool result;
+
+        if (!character_dungeon) return los_aux(y1, x1, y2, x2);
+
+        m_ptr = los_memo_find(los_memo_key(y1, x1, y2, x2) | LOS_MEMO_LOS, 0);
+        if (m_ptr->epoch) return m_ptr->result;
+
+        result = los_aux(y1, x1, y2, x2);
+        los_memo_save(m_ptr, result);
+        return result;
+    }
+
+    if (!los_path_ready) los_path_init();
+
+    i = LOS_IDX(dy, dx);
+    y1 -= MAX_SIGHT;
+    x1 -= MAX_SIGHT;
+
+    /* Knight's moves */
+    if ((los_path_knight_y[i] != 255) &&
+        cave_los_bold(y1 + los_path_knight_y[i], x1 + los_path_knight_x[i]))
+        return TRUE;
+
+    for (n = los_path_start[i], end = los_path_start[i + 1]; n < end; n++)
+    {
+        if (!cave_los_bold(y1 + los_path_y[n], x1 + los_path_x[n])) return FALSE;
+    }
+
+    /* Assume los */
+    return TRUE;
+}
+
 
 
 
@@ -923,7 +1221,7 @@ void apply_default_feat_lighting(byte f_attr[F_LIT_MAX], byte f_char[F_LIT_MAX])
  * "x_ptr->xxx", is quicker than "x_info[x].xxx", if this is incorrect
  * then a whole lot of code should be changed... XXX XXX
  */
-void map_info(int y, int x, byte *ap, char *cp, byte *tap, char *tcp)
+static void _map_info_aux(int y, int x, byte *ap, char *cp, byte *tap, char *tcp)
 {
     /* Get the cave */
     cave_type *c_ptr = &cave[y][x];
@@ -1356,6 +1654,18 @@ void map_info(int y, int x, byte *ap, char *cp, byte *tap, char *tcp)
     }
 }
 
+/*
+ * Shimmering monsters and hallucinations draw from their own stream,
+ * so that how often the map is redrawn never changes the game.
+ */
+void map_info(int y, int x, byte *ap, char *cp, byte *tap, char *tcp)
+{
+    int stream = Rand_stream_set(RAND_STREAM_VIEW);
+
+    _map_info_aux(y, x, ap, cp, tap, tcp);
+    Rand_stream_set(stream);
+}
+
 void py_get_display_char_attr(char *c, byte *a)
 {
     monster_race *r_ptr;
@@ -1606,10 +1916,40 @@ void display_dungeon(void)
 }
 
 
+/*
+ * Map grids waiting to be redrawn (see lite_spot_batch_begin()).
+ * One bit per grid, and the range of rows holding any.
+ */
+static u32b _spot_dirty[MAX_HGT][(MAX_WID + 31) / 32];
+static int  _spot_dirty_y1 = MAX_HGT;
+static int  _spot_dirty_y2 = -1;
+static int  _spot_batch = 0;
+
+/*
+ * Queue a run of map grids. Big tiles need two columns each, so
+ * they still go one at a time.
+ */
+static void _queue_map_run(int x, int y, int n, byte *a, char *c, byte *ta, char *tc)
+{
+    int i;
+
+    if (n <= 0) return;
+    if (!use_bigtile)
+    {
+        Term_queue_line(x, y, n, a, c, ta, tc);
+        return;
+    }
+    for (i = 0; i < n; i++)
+        Term_queue_bigchar(x + i, y, a[i], c[i], ta[i], tc[i]);
+}
+
 /*
  * Redraw (on the screen) a given MAP location
  *
  * This function should only be called on "legal" grids
+ *
+ * Inside a lite_spot batch the grid is only noted, and drawn once
+ * when the batch ends, however often it was asked for.
  */
 void lite_spot(int y, int x)
 {
@@ -1619,6 +1959,21 @@ void lite_spot(int y, int x)
 
         if (msg_line_contains(ui.y, ui.x)) return;
 
+        if (_spot_batch)
+        {
+            u32b bit = 1UL << (x & 31);
+
+            if (_spot_dirty[y][x >> 5] & bit)
+            {
+                map_redraw_merged++;
+                return;
+            }
+            _spot_dirty[y][x >> 5] |= bit;
+            if (y < _spot_dirty_y1) _spot_dirty_y1 = y;
+            if (y > _spot_dirty_y2) _spot_dirty_y2 = y;
+            return;
+        }
+
         if (in_bounds2(y, x))
         {
             byte a, ta;
@@ -1626,24 +1981,115 @@ void lite_spot(int y, int x)
 
             map_info(y, x, &a, &c, &ta, &tc);
             Term_queue_bigchar(ui.x, ui.y, a, c, ta, tc);
+            map_redraw_grids++;
+            map_redraw_frames++;
             p_ptr->window |= (PW_OVERHEAD | PW_DUNGEON);
         }
     }
 }
 
+/*
+ * Start collecting lite_spot() calls instead of drawing them.
+ *
+ * The view and light updates redraw every grid whose state changed,
+ * and the same grid is often asked for by several of them in one
+ * update_stuff(). Batches nest; only the outermost one draws.
+ */
+void lite_spot_batch_begin(void)
+{
+    _spot_batch++;
+}
+
+/*
+ * Draw the grids collected so far, a row at a time in runs of
+ * neighbouring grids. If the whole map is about to be redrawn anyway
+ * they are simply forgotten. Anything that waits for a key in the
+ * middle of a batch (like a -more- prompt) should call this first.
+ */
+void lite_spot_flush(void)
+{
+    int   y, x, n, start = 0, drawn = 0;
+    rect_t map_rect = ui_map_rect();
+    byte  a[MAX_WID], ta[MAX_WID];
+    char  c[MAX_WID], tc[MAX_WID];
+
+    if (_spot_dirty_y2 < 0) return;
+
+    for (y = _spot_dirty_y1; y <= _spot_dirty_y2; y++)
+    {
+        int row = map_rect.y + y - viewport_origin.y;
+
+        for (x = 0, n = 0; x < MAX_WID; x++)
+        {
+            bool ok = FALSE;
+
+            /* Skip clean words a whole at a time */
+            if (!(x & 31) && !_spot_dirty[y][x >> 5])
+                x += 31;
+
+            /* The map may have moved or the message line grown since */
+            else if ((_spot_dirty[y][x >> 5] & (1UL << (x & 31))) &&
+                     cave_xy_is_visible(x, y) &&
+                     !msg_line_contains(row, map_rect.x + x - viewport_origin.x))
+            {
+                ok = TRUE;
+            }
+
+            if (ok && (p_ptr->redraw & PR_MAP))
+            {
+                map_redraw_merged++;
+                ok = FALSE;
+            }
+
+            if (!ok)
+            {
+                _queue_map_run(start, row, n, a, c, ta, tc);
+                n = 0;
+                continue;
+            }
+
+            if (!n) start = map_rect.x + x - viewport_origin.x;
+            map_info(y, x, &a[n], &c[n], &ta[n], &tc[n]);
+            n++;
+            drawn++;
+        }
+        _queue_map_run(start, row, n, a, c, ta, tc);
+
+        C_WIPE(_spot_dirty[y], (MAX_WID + 31) / 32, u32b);
+    }
+
+    if (drawn)
+    {
+        map_redraw_grids += drawn;
+        map_redraw_frames++;
+        p_ptr->window |= (PW_OVERHEAD | PW_DUNGEON);
+    }
+
+    _spot_dirty_y1 = MAX_HGT;
+    _spot_dirty_y2 = -1;
+}
+
+void lite_spot_batch_end(void)
+{
+    if (--_spot_batch > 0) return;
+    lite_spot_flush();
+}
+
 /*
  * Prints the map of the dungeon
  *
- * Note that, for efficiency, we contain an "optimized" version
- * of both "lite_spot()" and "print_rel()", and that we use the
- * "lite_spot()" function to display the player grid, if needed.
+ * Each row is queued in runs around the message line, so only the
+ * grids that actually changed since the last frame reach the screen.
+ * We use the "lite_spot()" function to display the player grid, if
+ * needed.
  */
 void prt_map(void)
 {
     point_t uip;
-    int     v;
-    rect_t  msg_rect = msg_line_rect();
+    int     v, n;
     rect_t  map_rect = ui_map_rect();
+    byte    a[MAX_WID], ta[MAX_WID];
+    char    c[MAX_WID], tc[MAX_WID];
 
     /* Access the cursor state */
     (void)Term_get_cursor(&v);
@@ -1651,33 +2097,50 @@ void prt_map(void)
     /* Hide the cursor */
     (void)Term_set_cursor(0);
 
-    for (uip = rect_topleft(map_rect); uip.y < map_rect.y + map_rect.cy; uip.y++)
-    {
-        if (msg_line_contains(uip.y, -1))
-        {
-            int x = msg_rect.x + msg_rect.cx;
-            Term_erase(x, uip.y, map_rect.cx - x);
-        }
-        else
-            Term_erase(uip.x, uip.y, map_rect.cx);
-    }
-
     for (uip.y = map_rect.y; uip.y < map_rect.y + map_rect.cy; uip.y++)
     {
+        int start = map_rect.x;
+
+        n = 0;
         for (uip.x = map_rect.x; uip.x < map_rect.x + map_rect.cx; uip.x++)
         {
             point_t cp = ui_pt_to_cave_pt(uip);
-            byte a, ta;
-            char c, tc;
 
-            if (msg_line_contains(uip.y, uip.x)) continue;
-            if (!in_bounds2(cp.y, cp.x)) continue;
+            if (msg_line_contains(uip.y, uip.x))
+            {
+                _queue_map_run(start, uip.y, n, a, c, ta, tc);
+                start = uip.x + 1;
+                n = 0;
+                continue;
+            }
+
+            /* Very wide terminals take more than one run */
+            if (n == MAX_WID)
+            {
+                _queue_map_run(start, uip.y, n, a, c, ta, tc);
+                start = uip.x;
+                n = 0;
+            }
 
-            map_info(cp.y, cp.x, &a, &c, &ta, &tc);
-            Term_queue_bigchar(uip.x, uip.y, a, c, ta, tc);
+            /* Blank out the grids beyond the edge of the cave */
+            if (!in_bounds2(cp.y, cp.x))
+            {
+                a[n] = Term->attr_blank;
+                c[n] = Term->char_blank;
+                ta[n] = 0;
+                tc[n] = 0;
+            }
+            else
+            {
+                map_info(cp.y, cp.x, &a[n], &c[n], &ta[n], &tc[n]);
+            }
+            n++;
         }
+        _queue_map_run(start, uip.y, n, a, c, ta, tc);
     }
 
+    map_redraw_full++;
+
     /* Display player */
     lite_spot(py, px);
 
@@ -2309,10 +2772,11 @@ void do_cmd_view_map(void)
  * is always cleared when we are done.
  *
  *
- * The current "update_lite()" and "update_view()" algorithms use the
- * "CAVE_TEMP" flag, and the array of grids which are marked as "CAVE_TEMP",
- * to keep track of which grids were previously marked as "CAVE_LITE" or
- * "CAVE_VIEW", which allows us to optimize the "screen updates".
+ * The current "update_lite()" algorithm uses the "CAVE_TEMP" flag, and the
+ * array of grids which are marked as "CAVE_TEMP", to keep track of which
+ * grids were previously marked as "CAVE_LITE", which allows us to optimize
+ * the "screen updates". The "update_view()" algorithm does the same for
+ * "CAVE_VIEW" with a packed bit copy of the previous view instead.
  *
  * The "CAVE_TEMP" flag, and the array of "CAVE_TEMP" grids, is also used
  * for various other purposes, such as spreading lite or darkness during
@@ -2952,7 +3416,7 @@ void update_mon_lite(void)
         monster_race *r_ptr;
 
         /* Loop through monsters, adding newly lit squares to changes list */
-        for (i = 1; i < m_max; i++)
+        for_each_live_mon(i)
         {
             m_ptr = &m_list[i];
             r_ptr = &r_info[m_ptr->r_idx];
@@ -3254,18 +3718,89 @@ void clear_mon_lite(void)
 
 
 /*
- * Clear the viewable space
+ * Packed "los" and "view" sets for "update_view()".
+ *
+ * view_los_row[y] has a bit set for each grid of row y which supports los,
+ * so the view code can test a grid with a single load instead of chasing
+ * the feature flags. Rows are rebuilt lazily: "cave_set_feat()" patches
+ * single grids in place, while level changes and the other wholesale
+ * rewrites of the cave (which always pass through "forget_view()") just
+ * mark every row stale.
+ *
+ * view_bits[] holds two copies of the "view" set as bits, one for the
+ * current view and one for the view being computed, so that comparing the
+ * old and the new view is done a word at a time rather than a grid at a
+ * time. Only rows view_bits_y1..view_bits_y2 of a copy can be non-zero.
  */
-void forget_view(void)
-{
-    int i;
+#define VIEW_WORDS ((MAX_WID + 31) / 32)
+#define VIEW_BIT(X) (1UL << ((X) & 31))
 
-    cave_type *c_ptr;
+static u32b view_los_row[MAX_HGT][VIEW_WORDS];
+static bool view_los_ok[MAX_HGT];
 
-    /* None to forget */
-    if (!view_n) return;
+static u32b view_bits[2][MAX_HGT][VIEW_WORDS];
+static int view_bits_y1[2], view_bits_y2[2];
+static int view_cur = 0;
 
-    /* Clear them all */
+#define view_los_bold(Y,X) \
+    (view_los_row[(Y)][(X) >> 5] & VIEW_BIT(X))
+
+static void view_los_refresh(int y1, int y2)
+{
+    int y, x;
+
+    for (y = y1; y <= y2; y++)
+    {
+        if (view_los_ok[y]) continue;
+
+        C_WIPE(view_los_row[y], VIEW_WORDS, u32b);
+        for (x = 0; x < MAX_WID; x++)
+        {
+            if (cave_los_bold(y, x)) view_los_row[y][x >> 5] |= VIEW_BIT(x);
+        }
+        view_los_ok[y] = TRUE;
+    }
+}
+
+/*
+ * Note that the feature at (y,x) was changed behind our back
+ */
+void view_los_note(int y, int x)
+{
+    los_memo_wipe();
+
+    if (!view_los_ok[y]) return;
+
+    if (cave_los_bold(y, x)) view_los_row[y][x >> 5] |= VIEW_BIT(x);
+    else view_los_row[y][x >> 5] &= ~VIEW_BIT(x);
+}
+
+/*
+ * Forget the packed los rows (the whole cave was rewritten)
+ */
+void view_los_wipe(void)
+{
+    los_memo_wipe();
+    C_WIPE(view_los_ok, MAX_HGT, bool);
+}
+
+
+/*
+ * Clear the viewable space
+ */
+void forget_view(void)
+{
+    int i;
+
+    cave_type *c_ptr;
+
+    /* The cave is about to change wholesale */
+    view_los_wipe();
+
+    /* None to forget */
+    if (!view_n) return;
+
+    /* Clear them all */
     for (i = 0; i < view_n; i++)
     {
         int y = view_y[i];
@@ -3277,6 +3812,9 @@ void forget_view(void)
         /* Forget that the grid is viewable */
         c_ptr->info &= ~(CAVE_VIEW);
 
+        /* Forget the packed copy too */
+        view_bits[view_cur][y][x >> 5] &= ~VIEW_BIT(x);
+
         /* if (!panel_contains(y, x)) continue; */
 
         /* Update the screen */
@@ -3299,12 +3837,39 @@ void forget_view(void)
 {\
     if (!((C)->info & (CAVE_VIEW))){\
     (C)->info |= (CAVE_VIEW); \
+    view_bits[view_cur][(Y)][(X) >> 5] |= VIEW_BIT(X); \
     view_y[view_n] = (Y); \
     view_x[view_n] = (X); \
     view_n++;}\
 }
 
 
+/*
+ * Hack -- "los()" from the player, for grids within MAX_SIGHT,
+ * using the precomputed paths and the packed los rows.
+ */
+static bool view_los(int y, int x)
+{
+    int i = LOS_IDX(y - py, x - px);
+    int y1 = py - MAX_SIGHT;
+    int x1 = px - MAX_SIGHT;
+    s32b n, end;
+
+    if (arg_reference) return los_aux(py, px, y, x);
+
+    /* Knight's moves */
+    if ((los_path_knight_y[i] != 255) &&
+        view_los_bold(y1 + los_path_knight_y[i], x1 + los_path_knight_x[i]))
+        return TRUE;
+
+    for (n = los_path_start[i], end = los_path_start[i + 1]; n < end; n++)
+    {
+        if (!view_los_bold(y1 + los_path_y[n], x1 + los_path_x[n])) return FALSE;
+    }
+
+    return TRUE;
+}
+
 
 /*
  * Helper function for "update_view()" below
@@ -3341,8 +3906,8 @@ static bool update_view_aux(int y, int x, int y1, int x1, int y2, int x2)
 
 
     /* Check for walls */
-    f1 = (cave_los_grid(g1_c_ptr));
-    f2 = (cave_los_grid(g2_c_ptr));
+    f1 = (view_los_bold(y1, x1) != 0);
+    f2 = (view_los_bold(y2, x2) != 0);
 
     /* Totally blocked by physical walls */
     if (!f1 && !f2) return (TRUE);
@@ -3361,7 +3926,7 @@ static bool update_view_aux(int y, int x, int y1, int x1, int y2, int x2)
 
 
     /* Check for walls */
-    wall = (!cave_los_grid(c_ptr));
+    wall = (!view_los_bold(y, x));
 
 
     /* Check the "ease" of visibility */
@@ -3407,7 +3972,7 @@ static bool update_view_aux(int y, int x, int y1, int x1, int y2, int x2)
 
 
     /* Hack -- check line of sight */
-    if (los(py, px, y, x))
+    if (view_los(y, x))
     {
         cave_view_hack(c_ptr, y, x);
 
@@ -3514,7 +4079,7 @@ static bool update_view_aux(int y, int x, int y1, int x1, int y2, int x2)
  */
 void update_view(void)
 {
-    int n, m, d, k, y, x, z;
+    int n, m, d, k, y, x, z, old;
 
     int se, sw, ne, nw, es, en, ws, wn;
 
@@ -3536,29 +4101,24 @@ void update_view(void)
 
     /*** Step 0 -- Begin ***/
 
-    /* Save the old "view" grids for later */
-    for (n = 0; n < view_n; n++)
-    {
-        y = view_y[n];
-        x = view_x[n];
+    if (!los_path_ready) los_path_init();
 
-        /* Access the grid */
-        c_ptr = &cave[y][x];
+    /* Bring the packed los rows up to date */
+    view_los_refresh(MAX(0, py - MAX_SIGHT), MIN(MAX_HGT - 1, py + MAX_SIGHT));
 
+    /* The old "view" grids stay behind in the packed copy */
+    for (n = 0; n < view_n; n++)
+    {
         /* Mark the grid as not in "view" */
-        c_ptr->info &= ~(CAVE_VIEW);
-
-        /* Mark the grid as "seen" */
-        c_ptr->info |= (CAVE_TEMP);
-
-        /* Add it to the "seen" set */
-        temp_y[temp_n] = y;
-        temp_x[temp_n] = x;
-        temp_n++;
+        cave[view_y[n]][view_x[n]].info &= ~(CAVE_VIEW);
     }
 
-    /* Start over with the "view" array */
+    /* Start over with the "view" array (and the other packed copy) */
     view_n = 0;
+    old = view_cur;
+    view_cur = !view_cur;
+    view_bits_y1[view_cur] = MAX(0, py - MAX_SIGHT);
+    view_bits_y2[view_cur] = MIN(MAX_HGT - 1, py + MAX_SIGHT);
 
     /*** Step 1 -- adjacent grids ***/
 
@@ -3588,7 +4148,7 @@ void update_view(void)
         c_ptr = &cave[y+d][x+d];
         c_ptr->info |= (CAVE_XTRA);
         cave_view_hack(c_ptr, y+d, x+d);
-        if (!cave_los_grid(c_ptr)) break;
+        if (!view_los_bold(y+d, x+d)) break;
     }
 
     /* Scan south-west */
@@ -3598,7 +4158,7 @@ void update_view(void)
         c_ptr = &cave[y+d][x-d];
         c_ptr->info |= (CAVE_XTRA);
         cave_view_hack(c_ptr, y+d, x-d);
-        if (!cave_los_grid(c_ptr)) break;
+        if (!view_los_bold(y+d, x-d)) break;
     }
 
     /* Scan north-east */
@@ -3608,7 +4168,7 @@ void update_view(void)
         c_ptr = &cave[y-d][x+d];
         c_ptr->info |= (CAVE_XTRA);
         cave_view_hack(c_ptr, y-d, x+d);
-        if (!cave_los_grid(c_ptr)) break;
+        if (!view_los_bold(y-d, x+d)) break;
     }
 
     /* Scan north-west */
@@ -3618,7 +4178,7 @@ void update_view(void)
         c_ptr = &cave[y-d][x-d];
         c_ptr->info |= (CAVE_XTRA);
         cave_view_hack(c_ptr, y-d, x-d);
-        if (!cave_los_grid(c_ptr)) break;
+        if (!view_los_bold(y-d, x-d)) break;
     }
 
 
@@ -3631,7 +4191,7 @@ void update_view(void)
         c_ptr = &cave[y+d][x];
         c_ptr->info |= (CAVE_XTRA);
         cave_view_hack(c_ptr, y+d, x);
-        if (!cave_los_grid(c_ptr)) break;
+        if (!view_los_bold(y+d, x)) break;
     }
 
     /* Initialize the "south strips" */
@@ -3644,7 +4204,7 @@ void update_view(void)
         c_ptr = &cave[y-d][x];
         c_ptr->info |= (CAVE_XTRA);
         cave_view_hack(c_ptr, y-d, x);
-        if (!cave_los_grid(c_ptr)) break;
+        if (!view_los_bold(y-d, x)) break;
     }
 
     /* Initialize the "north strips" */
@@ -3657,7 +4217,7 @@ void update_view(void)
         c_ptr = &cave[y][x+d];
         c_ptr->info |= (CAVE_XTRA);
         cave_view_hack(c_ptr, y, x+d);
-        if (!cave_los_grid(c_ptr)) break;
+        if (!view_los_bold(y, x+d)) break;
     }
 
     /* Initialize the "east strips" */
@@ -3670,7 +4230,7 @@ void update_view(void)
         c_ptr = &cave[y][x-d];
         c_ptr->info |= (CAVE_XTRA);
         cave_view_hack(c_ptr, y, x-d);
-        if (!cave_los_grid(c_ptr)) break;
+        if (!view_los_bold(y, x-d)) break;
     }
 
     /* Initialize the "west strips" */
@@ -3930,39 +4490,78 @@ void update_view(void)
         c_ptr->info &= ~(CAVE_XTRA);
 
         /* Update only newly viewed grids */
-        if (c_ptr->info & (CAVE_TEMP)) continue;
+        if (view_bits[old][y][x >> 5] & VIEW_BIT(x)) continue;
 
         /* Add it to later visual update */
         cave_note_and_redraw_later(c_ptr, y, x);
     }
 
-    /* Wipe the old grids, update as needed */
-    for (n = 0; n < temp_n; n++)
+    /* Wipe the old grids, update the ones no longer in view */
+    for (y = view_bits_y1[old]; y <= view_bits_y2[old]; y++)
     {
-        y = temp_y[n];
-        x = temp_x[n];
-
-        /* Access the grid */
-        c_ptr = &cave[y][x];
+        for (n = 0; n < VIEW_WORDS; n++)
+        {
+            u32b lost = view_bits[old][y][n] & ~view_bits[view_cur][y][n];
 
-        /* No longer in the array */
-        c_ptr->info &= ~(CAVE_TEMP);
+            view_bits[old][y][n] = 0;
 
-        /* Update only non-viewable grids */
-        if (c_ptr->info & (CAVE_VIEW)) continue;
+            for (x = n << 5; lost; x++, lost >>= 1)
+            {
+                if (!(lost & 1)) continue;
 
-        /* Add it to later visual update */
-        cave_redraw_later(c_ptr, y, x);
+                /* Add it to later visual update */
+                cave_redraw_later(&cave[y][x], y, x);
+            }
+        }
     }
 
-    /* None left */
-    temp_n = 0;
-
     /* Mega-Hack -- Visual update later */
     p_ptr->update |= (PU_DELAY_VIS);
 }
 
 
+/*
+ * Debug -- check the precomputed los paths and the packed los and view
+ * sets against "los_aux()" and the cave near the player. Returns the
+ * number of disagreements (which should always be zero).
+ */
+int view_verify(void)
+{
+    int y, x, n = 0, bad = 0;
+
+    if (!los_path_ready) los_path_init();
+    view_los_refresh(MAX(0, py - MAX_SIGHT), MIN(MAX_HGT - 1, py + MAX_SIGHT));
+
+    for (y = py - MAX_SIGHT; y <= py + MAX_SIGHT; y++)
+    {
+        for (x = px - MAX_SIGHT; x <= px + MAX_SIGHT; x++)
+        {
+            bool ok;
+
+            if (!in_bounds2(y, x)) continue;
+
+            ok = los_aux(py, px, y, x);
+            if (!view_los_bold(y, x) != !cave_los_bold(y, x)) bad++;
+            if (los(py, px, y, x) != ok) bad++;
+            if (view_los(y, x) != ok) bad++;
+        }
+    }
+
+    for (y = 0; y < MAX_HGT; y++)
+    {
+        for (x = 0; x < MAX_WID; x++)
+        {
+            if (!(view_bits[view_cur][y][x >> 5] & VIEW_BIT(x))) continue;
+            if (!(cave[y][x].info & CAVE_VIEW)) bad++;
+            n++;
+        }
+    }
+    if (n != view_n) bad++;
+
+    return bad;
+}
+
+
 /*
  * Mega-Hack -- Delayed visual update
  * Only used if update_view(), update_lite() or update_mon_lite() was called
@@ -4002,6 +4601,48 @@ void delayed_visual_update(void)
 }
 
 
+/*
+ * Flow queue: every grid the flow reaches is queued exactly once per pass,
+ * so a queue the size of the largest level can never overflow. After a
+ * pass, it doubles as the list of grids holding flow information, so the
+ * next pass only needs to wipe those instead of the whole level.
+ */
+#define FLOW_MAX (MAX_HGT * MAX_WID)
+
+static byte flow_qy[FLOW_MAX];
+static byte flow_qx[FLOW_MAX];
+static int flow_n = 0;
+
+/*
+ * Cost buckets for doors: entering a closed door costs 4 rather than 1,
+ * so tentative costs are at most 4 ahead of the grid being processed and
+ * 5 circular buckets suffice. Each grid enters a given bucket at most
+ * once per cost, so each bucket can hold every grid on the level.
+ */
+#define FLOW_BUCKETS 5
+
+static byte flow_by[FLOW_BUCKETS][FLOW_MAX];
+static byte flow_bx[FLOW_BUCKETS][FLOW_MAX];
+
+/*
+ * Flow class of each feature: 0 blocks flow, 1 can be walked, and 4 is
+ * a closed door (the extra cost of opening or bashing it).
+ */
+static byte *flow_feat = NULL;
+
+static void init_flow_feat(void)
+{
+    int i;
+
+    C_MAKE(flow_feat, max_f_idx, byte);
+    for (i = 0; i < max_f_idx; i++)
+    {
+        if (have_flag(f_info[i].flags, FF_MOVE)) flow_feat[i] = 1;
+        else if (is_closed_door(i)) flow_feat[i] = 4;
+    }
+}
+
+
 /*
  * Hack -- forget the "flow" information
  */
@@ -4021,6 +4662,11 @@ void forget_flow(void)
         }
     }
     current_flow_depth = 0;
+
+    /* Nothing left to wipe */
+    flow_n = 0;
+
+    flow_cache_wipe();
 }
 
 
@@ -4035,115 +4681,600 @@ static u16b flow_y = 0;
 
 
 /*
- * Hack -- fill in the "cost" field of every grid that the player
- * can "reach" with the number of steps needed to reach that grid.
- * This also yields the "distance" of the player from every grid.
- *
- * In addition, mark the "when" of the grids that can reach
- * the player with the incremented value of "flow_n".
- *
- * Hack -- use the "seen" array as a "circular queue".
- *
- * We do not need a priority queue because the cost from grid
- * to grid is always "one" and we process them in order.
+ * Hack -- fill in the "cost" field of every grid that the player
+ * can "reach" with the number of steps needed to reach that grid,
+ * counting closed doors as 4 steps. Also fill in the "dist" field
+ * with the plain distance of the player from every grid.
+ *
+ * The distances come from a breadth first search, which is limited
+ * to MONSTER_FLOW_DEPTH steps. If it passed any doors, the costs then
+ * come from a second, bucketed, pass over the same grids (Dial's
+ * algorithm); otherwise, they are just the distances.
+ *
+ * Both fields are bytes, so they saturate at 255.
+ */
+static void update_flow_aux(int max_flow_depth)
+{
+    int x, y, d, i, c;
+    int head, tail, left;
+    int doors = 0;
+    int bucket_n[FLOW_BUCKETS] = {0};
+
+    current_flow_depth = 0;
+
+    if (!flow_feat) init_flow_feat();
+
+    /* Erase the flow information from the last pass */
+    for (i = 0; i < flow_n; i++)
+    {
+        cave_type *c_ptr = &cave[flow_qy[i]][flow_qx[i]];
+
+        c_ptr->cost = 0;
+        c_ptr->dist = 0;
+    }
+
+    /* Save player position */
+    flow_y = py;
+    flow_x = px;
+
+    /* Add the player's grid to the queue */
+    flow_qy[0] = py;
+    flow_qx[0] = px;
+    head = 1;
+
+    /* Find the distances */
+    for (tail = 0; tail < head; tail++)
+    {
+        int ty = flow_qy[tail];
+        int tx = flow_qx[tail];
+        int n = cave[ty][tx].dist + 1;
+
+        /* Hack -- limit flow depth */
+        if (n > max_flow_depth) break;
+
+        /* Add the "children" */
+        for (d = 0; d < 8; d++)
+        {
+            cave_type *c_ptr;
+            int step;
+
+            /* Child location */
+            y = ty + ddy_ddd[d];
+            x = tx + ddx_ddd[d];
+
+            /* Ignore player's grid */
+            if (!in_bounds(y, x)) continue;
+            if (player_bold(y, x)) continue;
+
+            c_ptr = &cave[y][x];
+
+            /* Ignore "pre-stamped" entries */
+            if (c_ptr->dist) continue;
+
+            /* Ignore "walls" and "rubble" */
+            step = flow_feat[c_ptr->feat];
+            if (!step) continue;
+            if (step > 1) doors++;
+
+            /* Save the distance (and the cost, in case there are no doors) */
+            c_ptr->dist = n;
+            c_ptr->cost = n;
+
+            /* Enqueue that entry */
+            flow_qy[head] = y;
+            flow_qx[head] = x;
+            head++;
+        }
+    }
+
+    /* Remember what to erase next time */
+    flow_n = head;
+    if (head > 1) current_flow_depth = cave[flow_qy[head - 1]][flow_qx[head - 1]].dist;
+
+    /* Doors make some costs differ from the distances */
+    if (!doors) return;
+
+    /* Forget the costs, except for the player's grid */
+    for (i = 1; i < head; i++) cave[flow_qy[i]][flow_qx[i]].cost = 0;
+
+    /* Find the costs, cheapest first */
+    flow_by[0][0] = py;
+    flow_bx[0][0] = px;
+    bucket_n[0] = 1;
+    left = 1;
+
+    for (c = 0; left; c++)
+    {
+        int b = c % FLOW_BUCKETS;
+
+        for (i = 0; i < bucket_n[b]; i++)
+        {
+            int ty = flow_by[b][i];
+            int tx = flow_bx[b][i];
+            cave_type *t_ptr = &cave[ty][tx];
+
+            /* Skip stale entries (this grid was reached more cheaply) */
+            if (MIN(c, 255) != t_ptr->cost) continue;
+
+            /* Only expand grids the distance search expanded */
+            if (t_ptr->dist >= max_flow_depth) continue;
+
+            /* Add the "children" */
+            for (d = 0; d < 8; d++)
+            {
+                cave_type *c_ptr;
+                int m, nb;
+
+                /* Child location */
+                y = ty + ddy_ddd[d];
+                x = tx + ddx_ddd[d];
+
+                /* Ignore player's grid */
+                if (!in_bounds(y, x)) continue;
+                if (player_bold(y, x)) continue;
+
+                c_ptr = &cave[y][x];
+
+                /* Ignore grids the distance search never reached */
+                if (!c_ptr->dist) continue;
+
+                m = c + flow_feat[c_ptr->feat];
+
+                /* Ignore "pre-stamped" entries */
+                if (c_ptr->cost && c_ptr->cost <= MIN(m, 255)) continue;
+
+                /* Save the flow cost */
+                c_ptr->cost = MIN(m, 255);
+
+                /* Enqueue that entry */
+                nb = m % FLOW_BUCKETS;
+                flow_by[nb][bucket_n[nb]] = y;
+                flow_bx[nb][bucket_n[nb]] = x;
+                bucket_n[nb]++;
+                left++;
+            }
+        }
+
+        /* Empty this bucket for cost c + FLOW_BUCKETS */
+        left -= bucket_n[b];
+        bucket_n[b] = 0;
+    }
+}
+
+
+/*
+ * The reference version of "update_flow_aux()": the original pass, which
+ * wipes the whole level and relaxes both fields at once through a circular
+ * queue. It is only used with "arg_reference" and by "flow_verify()". The
+ * queue is as large as the level and the costs saturate rather than wrap,
+ * which the original did not guarantee on the largest levels.
+ */
+static void update_flow_reference(int max_flow_depth)
+{
+    int x, y, d;
+    int flow_head = 1;
+    int flow_tail = 0;
+
+    current_flow_depth = 0;
+
+    /* Erase all of the current flow information */
+    for (y = 0; y < cur_hgt; y++)
+    {
+        for (x = 0; x < cur_wid; x++)
+        {
+            cave[y][x].cost = 0;
+            cave[y][x].dist = 0;
+        }
+    }
+
+    /* Nothing left to wipe */
+    flow_n = 0;
+
+    /* Save player position */
+    flow_y = py;
+    flow_x = px;
+
+    /* Add the player's grid to the queue */
+    flow_qy[0] = py;
+    flow_qx[0] = px;
+
+    /* Now process the queue */
+    while (flow_head != flow_tail)
+    {
+        int ty, tx;
+
+        /* Extract the next entry */
+        ty = flow_qy[flow_tail];
+        tx = flow_qx[flow_tail];
+
+        /* Forget that entry */
+        if (++flow_tail == FLOW_MAX) flow_tail = 0;
+
+        /* Add the "children" */
+        for (d = 0; d < 8; d++)
+        {
+            int old_head = flow_head;
+            int m = cave[ty][tx].cost + 1;
+            int n = cave[ty][tx].dist + 1;
+            cave_type *c_ptr;
+
+            /* Child location */
+            y = ty + ddy_ddd[d];
+            x = tx + ddx_ddd[d];
+
+            /* Ignore player's grid */
+            if (!in_bounds(y, x)) continue;
+            if (player_bold(y, x)) continue;
+
+            c_ptr = &cave[y][x];
+
+            if (is_closed_door(c_ptr->feat)) m += 3;
+            if (m > 255) m = 255;
+
+            /* Ignore "pre-stamped" entries */
+            if (c_ptr->dist != 0 && c_ptr->dist <= n && c_ptr->cost <= m) continue;
+
+            /* Ignore "walls" and "rubble" */
+            if (!cave_have_flag_grid(c_ptr, FF_MOVE) && !is_closed_door(c_ptr->feat)) continue;
+
+            /* Save the flow cost */
+            if (c_ptr->cost == 0 || c_ptr->cost > m) c_ptr->cost = m;
+            if (c_ptr->dist == 0 || c_ptr->dist > n) c_ptr->dist = n;
+
+            current_flow_depth = MAX(current_flow_depth, n);
+
+            /* Hack -- limit flow depth */
+            if (n == max_flow_depth) continue;
+
+            /* Enqueue that entry */
+            flow_qy[flow_head] = y;
+            flow_qx[flow_head] = x;
+
+            /* Advance the queue */
+            if (++flow_head == FLOW_MAX) flow_head = 0;
+
+            /* Hack -- notice overflow by forgetting new entry */
+            if (flow_head == flow_tail) flow_head = old_head;
+        }
+    }
+}
+
+
+void update_flow(void)
+{
+    int max_flow_depth = MONSTER_FLOW_DEPTH;
+
+    current_flow_depth = 0;
+    if (p_ptr->action == ACTION_GLITTER)
+        max_flow_depth = 1000;
+
+    /* The "dist" field is only a byte */
+    if (max_flow_depth > 255) max_flow_depth = 255;
+
+    /* Paranoia -- make sure the array is empty */
+    if (temp_n) return;
+
+    /* The last way-point is on the map */
+    if (running && in_bounds(flow_y, flow_x))
+    {
+        /* The way point is in sight - do not update. (Speedup) */
+        if (cave[flow_y][flow_x].info & CAVE_VIEW) return;
+    }
+
+    if (arg_reference) update_flow_reference(max_flow_depth);
+    else update_flow_aux(max_flow_depth);
+}
+
+
+static byte flow_save_cost[MAX_HGT][MAX_WID];
+static byte flow_save_dist[MAX_HGT][MAX_WID];
+static byte flow_save_qy[FLOW_MAX];
+static byte flow_save_qx[FLOW_MAX];
+
+/*
+ * Debug -- recompute the player's flow both ways from where the player
+ * stands and compare the "cost" and "dist" fields. Everything is put back
+ * afterwards, so the game goes on as if nothing had happened. Returns the
+ * number of disagreeing grids (which should always be zero).
+ */
+int flow_verify(void)
+{
+    int y, x, bad = 0;
+    int max_flow_depth = MONSTER_FLOW_DEPTH;
+    int save_n = flow_n, save_depth = current_flow_depth;
+    u16b save_y = flow_y, save_x = flow_x;
+    int depth;
+
+    if (temp_n) return 0;
+
+    if (p_ptr->action == ACTION_GLITTER) max_flow_depth = 255;
+
+    for (y = 0; y < cur_hgt; y++)
+    {
+        for (x = 0; x < cur_wid; x++)
+        {
+            flow_save_cost[y][x] = cave[y][x].cost;
+            flow_save_dist[y][x] = cave[y][x].dist;
+        }
+    }
+    memcpy(flow_save_qy, flow_qy, flow_n);
+    memcpy(flow_save_qx, flow_qx, flow_n);
+
+    /* The new pass, kept in the first door bucket (free again) */
+    update_flow_aux(max_flow_depth);
+    depth = current_flow_depth;
+    for (y = 0; y < cur_hgt; y++)
+    {
+        for (x = 0; x < cur_wid; x++)
+        {
+            flow_by[0][y * MAX_WID + x] = cave[y][x].cost;
+            flow_bx[0][y * MAX_WID + x] = cave[y][x].dist;
+        }
+    }
+
+    /* The reference pass */
+    update_flow_reference(max_flow_depth);
+    if (current_flow_depth != depth) bad++;
+
+    /* Compare, and put the old fields back */
+    for (y = 0; y < cur_hgt; y++)
+    {
+        for (x = 0; x < cur_wid; x++)
+        {
+            cave_type *c_ptr = &cave[y][x];
+
+            if (c_ptr->cost != flow_by[0][y * MAX_WID + x]) bad++;
+            else if (c_ptr->dist != flow_bx[0][y * MAX_WID + x]) bad++;
+
+            c_ptr->cost = flow_save_cost[y][x];
+            c_ptr->dist = flow_save_dist[y][x];
+        }
+    }
+    memcpy(flow_qy, flow_save_qy, save_n);
+    memcpy(flow_qx, flow_save_qx, save_n);
+    flow_n = save_n;
+    current_flow_depth = save_depth;
+    flow_y = save_y;
+    flow_x = save_x;
+
+    return bad;
+}
+
+
+/*
+ * Flow fields towards other goals than the player (a pet's target, a
+ * ring bearer's victim, a pack's guard post, a fleeing monster's hiding
+ * place). Every monster heading for the same grid shares one field, which
+ * is computed the first time it is needed and kept until the terrain in
+ * its area changes (see "flow_cache_note()") or it is the least recently
+ * used one when another goal comes along.
+ *
+ * Each grid holds one more than its distance from the goal (so the goal
+ * itself holds 1), or 0 if the goal is out of reach. Closed doors count
+ * as a single step, like the "dist" field of the player's flow.
+ *
+ * Targets move, so a monster far from its goal may follow the field of a
+ * goal a little way off (see "flow_field_get()"): it only needs the first
+ * step, and that is the same for any nearby goal in the same area.
+ */
+#define FLOW_CACHE_MAX 8
+
+/* How far off a goal may be, as a fraction of the distance to it */
+#define FLOW_SLACK 4
+
+typedef struct {
+    bool valid;
+    byte y, x;
+    u32b used;
+    byte dist[MAX_HGT][MAX_WID];
+} flow_field_type;
+
+static flow_field_type flow_cache[FLOW_CACHE_MAX];
+static u32b flow_cache_used = 0;
+
+void flow_cache_wipe(void)
+{
+    int i;
+
+    for (i = 0; i < FLOW_CACHE_MAX; i++) flow_cache[i].valid = FALSE;
+}
+
+/*
+ * The grid (y, x) is about to become passable or impassable. Only a field
+ * which reached the grid or one of its neighbours can change.
+ */
+void flow_cache_note(int y, int x)
+{
+    int i, d;
+
+    for (i = 0; i < FLOW_CACHE_MAX; i++)
+    {
+        flow_field_type *f_ptr = &flow_cache[i];
+
+        if (!f_ptr->valid) continue;
+
+        for (d = 0; d < 9; d++)
+        {
+            int yy = y + ddy_ddd[d];
+            int xx = x + ddx_ddd[d];
+
+            if (!in_bounds2(yy, xx)) continue;
+            if (!f_ptr->dist[yy][xx]) continue;
+
+            f_ptr->valid = FALSE;
+            break;
+        }
+    }
+}
+
+/*
+ * Compute the field for a goal. The bucket arrays of "update_flow()" are
+ * only used during that function, so borrow the first one as our queue.
+ */
+static void flow_field_fill(flow_field_type *f_ptr, int gy, int gx)
+{
+    byte *qy = flow_by[0];
+    byte *qx = flow_bx[0];
+    int head, tail, d;
+
+    if (!flow_feat) init_flow_feat();
+
+    memset(f_ptr->dist, 0, sizeof(f_ptr->dist));
+    f_ptr->y = gy;
+    f_ptr->x = gx;
+    f_ptr->valid = TRUE;
+
+    f_ptr->dist[gy][gx] = 1;
+    qy[0] = gy;
+    qx[0] = gx;
+    head = 1;
+
+    for (tail = 0; tail < head; tail++)
+    {
+        int ty = qy[tail];
+        int tx = qx[tail];
+        int n = f_ptr->dist[ty][tx] + 1;
+
+        /* Hack -- limit flow depth */
+        if (n > MONSTER_FLOW_DEPTH + 1) break;
+
+        for (d = 0; d < 8; d++)
+        {
+            int y = ty + ddy_ddd[d];
+            int x = tx + ddx_ddd[d];
+
+            if (!in_bounds(y, x)) continue;
+            if (f_ptr->dist[y][x]) continue;
+            if (!flow_feat[cave[y][x].feat]) continue;
+
+            f_ptr->dist[y][x] = n;
+            qy[head] = y;
+            qx[head] = x;
+            head++;
+        }
+    }
+}
+
+/*
+ * Find a field leading from (y, x) to (gy, gx). A field for a goal no
+ * further from (gy, gx) than 1/FLOW_SLACK of the way will do, as long as
+ * it reaches both (y, x) and (gy, gx); otherwise, compute one in the least
+ * recently used slot.
  */
-void update_flow(void)
+static flow_field_type *flow_field_get(int gy, int gx, int y, int x)
 {
-    int x, y, d;
-    int flow_head = 1;
-    int flow_tail = 0;
-    int max_flow_depth = MONSTER_FLOW_DEPTH;
+    flow_field_type *f_ptr = NULL;
+    flow_field_type *old_ptr = NULL;
+    int slack = distance(y, x, gy, gx) / FLOW_SLACK;
+    int i;
 
-    current_flow_depth = 0;
-    if (p_ptr->action == ACTION_GLITTER)
-        max_flow_depth = 1000;
+    for (i = 0; i < FLOW_CACHE_MAX; i++)
+    {
+        flow_field_type *f2_ptr = &flow_cache[i];
 
-    /* Paranoia -- make sure the array is empty */
-    if (temp_n) return;
+        /* Remember the best slot to replace */
+        if (!old_ptr || (old_ptr->valid && (!f2_ptr->valid || f2_ptr->used < old_ptr->used)))
+            old_ptr = f2_ptr;
 
-    /* The last way-point is on the map */
-    if (running && in_bounds(flow_y, flow_x))
-    {
-        /* The way point is in sight - do not update. (Speedup) */
-        if (cave[flow_y][flow_x].info & CAVE_VIEW) return;
-    }
+        if (!f2_ptr->valid) continue;
+        if (!f2_ptr->dist[gy][gx]) continue;
 
-    /* Erase all of the current flow information */
-    for (y = 0; y < cur_hgt; y++)
-    {
-        for (x = 0; x < cur_wid; x++)
+        /* Take the exact goal, else the nearest one close enough */
+        if (f2_ptr->y == gy && f2_ptr->x == gx)
         {
-            cave[y][x].cost = 0;
-            cave[y][x].dist = 0;
+            f_ptr = f2_ptr;
+            break;
         }
+        if (distance(f2_ptr->y, f2_ptr->x, gy, gx) > slack) continue;
+        if (!f2_ptr->dist[y][x]) continue;
+        if (f_ptr && distance(f_ptr->y, f_ptr->x, gy, gx) <= distance(f2_ptr->y, f2_ptr->x, gy, gx)) continue;
+
+        f_ptr = f2_ptr;
     }
 
-    /* Save player position */
-    flow_y = py;
-    flow_x = px;
+    if (!f_ptr)
+    {
+        f_ptr = old_ptr;
+        flow_field_fill(f_ptr, gy, gx);
+    }
 
-    /* Add the player's grid to the queue */
-    temp_y[0] = py;
-    temp_x[0] = px;
+    f_ptr->used = ++flow_cache_used;
+    return f_ptr;
+}
 
-    /* Now process the queue */
-    while (flow_head != flow_tail)
-    {
-        int ty, tx;
+/*
+ * Find the first step from (y, x) along a shortest path to (gy, gx),
+ * ignoring anything but terrain. Return FALSE if there is no such path
+ * (or the goal is more than MONSTER_FLOW_DEPTH steps away).
+ */
+bool flow_step(int gy, int gx, int y, int x, int *ny, int *nx)
+{
+    flow_field_type *f_ptr;
+    int d, cur, best;
 
-        /* Extract the next entry */
-        ty = temp_y[flow_tail];
-        tx = temp_x[flow_tail];
+    if (!in_bounds2(gy, gx)) return FALSE;
 
-        /* Forget that entry */
-        if (++flow_tail == TEMP_MAX) flow_tail = 0;
+    f_ptr = flow_field_get(gy, gx, y, x);
 
-        /* Add the "children" */
-        for (d = 0; d < 8; d++)
-        {
-            int old_head = flow_head;
-            int m = cave[ty][tx].cost + 1;
-            int n = cave[ty][tx].dist + 1;
-            cave_type *c_ptr;
+    /* Any reachable grid beats an unreachable one */
+    cur = f_ptr->dist[y][x];
+    if (!cur) cur = 256;
 
-            /* Child location */
-            y = ty + ddy_ddd[d];
-            x = tx + ddx_ddd[d];
+    for (best = cur, d = 0; d < 8; d++)
+    {
+        int yy = y + ddy_ddd[d];
+        int xx = x + ddx_ddd[d];
+        int n;
 
-            /* Ignore player's grid */
-            if (!in_bounds(y, x)) continue;
-            if (player_bold(y, x)) continue;
+        if (!in_bounds2(yy, xx)) continue;
 
-            c_ptr = &cave[y][x];
+        n = f_ptr->dist[yy][xx];
+        if (!n || n >= best) continue;
 
-            if (is_closed_door(c_ptr->feat)) m += 3;
+        best = n;
+        (*ny) = yy;
+        (*nx) = xx;
+    }
 
-            /* Ignore "pre-stamped" entries */
-            if (c_ptr->dist != 0 && c_ptr->dist <= n && c_ptr->cost <= m) continue;
+    return best < cur;
+}
 
-            /* Ignore "walls" and "rubble" */
-            if (!cave_have_flag_grid(c_ptr, FF_MOVE) && !is_closed_door(c_ptr->feat)) continue;
+/*
+ * The number of steps from (y, x) to (gy, gx), ignoring anything but
+ * terrain, or -1 if there is no such path (or it is too long). The field
+ * must be for the exact goal, so no slack is allowed.
+ */
+int flow_distance(int gy, int gx, int y, int x)
+{
+    flow_field_type *f_ptr;
 
-            /* Save the flow cost */
-            if (c_ptr->cost == 0 || c_ptr->cost > m) c_ptr->cost = m;
-            if (c_ptr->dist == 0 || c_ptr->dist > n) c_ptr->dist = n;
+    if (!in_bounds2(gy, gx) || !in_bounds2(y, x)) return -1;
 
-            current_flow_depth = MAX(current_flow_depth, n);
+    f_ptr = flow_field_get(gy, gx, gy, gx);
+    return f_ptr->dist[y][x] - 1;
+}
 
-            /* Hack -- limit flow depth */
-            if (n == max_flow_depth) continue;
+/*
+ * Debug -- recompute every cached field and compare it with the cached
+ * one, to check that "flow_cache_note()" misses nothing. Returns the
+ * number of fields which differ (which should always be zero).
+ */
+int flow_cache_verify(void)
+{
+    static flow_field_type check;
+    int i, bad = 0;
 
-            /* Enqueue that entry */
-            temp_y[flow_head] = y;
-            temp_x[flow_head] = x;
+    for (i = 0; i < FLOW_CACHE_MAX; i++)
+    {
+        flow_field_type *f_ptr = &flow_cache[i];
 
-            /* Advance the queue */
-            if (++flow_head == TEMP_MAX) flow_head = 0;
+        if (!f_ptr->valid) continue;
 
-            /* Hack -- notice overflow by forgetting new entry */
-            if (flow_head == flow_tail) flow_head = old_head;
-        }
+        flow_field_fill(&check, f_ptr->y, f_ptr->x);
+        if (memcmp(check.dist, f_ptr->dist, sizeof(check.dist))) bad++;
     }
+
+    return bad;
 }
 
 
@@ -4484,7 +5615,7 @@ void cave_set_feat(int y, int x, int feat)
 {
     cave_type *c_ptr = &cave[y][x];
     feature_type *f_ptr = &f_info[feat];
-    bool old_los, old_mirror;
+    bool old_los, old_project, old_mirror;
 
     if (!character_dungeon)
     {
@@ -4512,14 +5643,22 @@ void cave_set_feat(int y, int x, int feat)
     }
 
     old_los = cave_have_flag_bold(y, x, FF_LOS);
+    old_project = cave_have_flag_bold(y, x, FF_PROJECT);
     old_mirror = is_mirror_grid(c_ptr);
 
+    /* Flow fields through this grid are no longer valid */
+    if (flow_feat && !flow_feat[c_ptr->feat] != !flow_feat[feat]) flow_cache_note(y, x);
+
     /* Clear mimic type */
     c_ptr->mimic = 0;
 
     /* Change the feature */
     c_ptr->feat = feat;
 
+    /* Patch the packed los row, forget memorized paths */
+    if (old_los != have_flag(f_ptr->flags, FF_LOS)) view_los_note(y, x);
+    else if (old_project != have_flag(f_ptr->flags, FF_PROJECT)) los_memo_wipe();
+
     /* Remove flag for mirror/glyph */
     c_ptr->info &= ~(CAVE_OBJECT);
 
@@ -4594,6 +5733,299 @@ void cave_set_feat(int y, int x, int feat)
 }
 
 
+/*
+ * The spatial index: for each block of SPATIAL_SIZE x SPATIAL_SIZE grids,
+ * the number of grids in it holding a monster ("spatial_mon") and the
+ * number holding a pile of objects ("spatial_obj"). Queries for whatever
+ * is near a grid visit only the blocks that are not empty, instead of the
+ * whole of "m_list" or "o_list".
+ *
+ * Every change to the "m_idx" or "o_idx" of a grid on the current level
+ * must go through cave_set_m_idx() or cave_set_o_idx(), which keep the
+ * counts. Code that rewrites the whole cave at once (see clear_cave() and
+ * the wilderness scrolling) may instead rebuild them afterwards.
+ */
+void cave_set_m_idx(int y, int x, int m_idx)
+{
+    cave_type *c_ptr = &cave[y][x];
+
+    if (!c_ptr->m_idx != !m_idx)
+    {
+        if (m_idx) spatial_mon[spatial_idx(y, x)]++;
+        else spatial_mon[spatial_idx(y, x)]--;
+    }
+    c_ptr->m_idx = m_idx;
+}
+
+void cave_set_o_idx(int y, int x, int o_idx)
+{
+    cave_type *c_ptr = &cave[y][x];
+
+    if (!c_ptr->o_idx != !o_idx)
+    {
+        if (o_idx) spatial_obj[spatial_idx(y, x)]++;
+        else spatial_obj[spatial_idx(y, x)]--;
+    }
+    c_ptr->o_idx = o_idx;
+}
+
+static void _spatial_count(byte *mon, byte *obj)
+{
+    int y, x;
+
+    C_WIPE(mon, SPATIAL_HGT * SPATIAL_WID, byte);
+    C_WIPE(obj, SPATIAL_HGT * SPATIAL_WID, byte);
+
+    for (y = 0; y < MAX_HGT; y++)
+    {
+        for (x = 0; x < MAX_WID; x++)
+        {
+            if (cave[y][x].m_idx) mon[spatial_idx(y, x)]++;
+            if (cave[y][x].o_idx) obj[spatial_idx(y, x)]++;
+        }
+    }
+}
+
+void spatial_rebuild(void)
+{
+    _spatial_count(spatial_mon, spatial_obj);
+}
+
+/*
+ * Count the blocks whose counts are wrong, and the live monsters and
+ * floor objects that are not where the cave says they are (for debugging)
+ */
+int spatial_verify(void)
+{
+    byte mon[SPATIAL_HGT * SPATIAL_WID];
+    byte obj[SPATIAL_HGT * SPATIAL_WID];
+    int  i, bad = 0;
+
+    _spatial_count(mon, obj);
+    for (i = 0; i < SPATIAL_HGT * SPATIAL_WID; i++)
+    {
+        if (mon[i] != spatial_mon[i]) bad++;
+        if (obj[i] != spatial_obj[i]) bad++;
+    }
+
+    for_each_live_mon(i)
+    {
+        monster_type *m_ptr = &m_list[i];
+
+        if (cave[m_ptr->fy][m_ptr->fx].m_idx != i) bad++;
+    }
+
+    for (i = 1; i < o_max; i++)
+    {
+        object_type *o_ptr = &o_list[i];
+        s16b         this_o_idx;
+
+        if (!o_ptr->k_idx || o_ptr->held_m_idx) continue;
+
+        for (this_o_idx = cave[o_ptr->loc.y][o_ptr->loc.x].o_idx; this_o_idx; this_o_idx = o_list[this_o_idx].next_o_idx)
+        {
+            if (this_o_idx == i) break;
+        }
+        if (!this_o_idx) bad++;
+    }
+
+    return bad;
+}
+
+/*
+ * Put the "n" indices in "idx" in order, by way of a bitmap of "max" bits
+ * (quicker than sorting, since there may be hundreds of them)
+ */
+static void _spatial_sort(s16b *idx, int n, int max)
+{
+    static u32b *bits = NULL;
+    static int   words = 0;
+    int          i, w;
+
+    if (n < 2) return;
+
+    if (words < (max + 31) / 32)
+    {
+        if (bits) C_KILL(bits, words, u32b);
+        words = (max + 31) / 32;
+        C_MAKE(bits, words, u32b);
+    }
+
+    for (i = 0; i < n; i++) bits[idx[i] >> 5] |= 1UL << (idx[i] & 31);
+
+    for (n = 0, w = 0; w < words; w++)
+    {
+        u32b b = bits[w];
+
+        if (!b) continue;
+        bits[w] = 0;
+        for (i = 0; b; i++, b >>= 1)
+        {
+            if (b & 1) idx[n++] = w * 32 + i;
+        }
+    }
+}
+
+/*
+ * How many grids of the non-empty blocks of "counts" lie in a rectangle
+ * (which must be in bounds), as an estimate of the cost of a search
+ */
+static int _spatial_area(const byte *counts, int y1, int x1, int y2, int x2)
+{
+    int by, bx, area = 0;
+
+    for (by = y1 >> SPATIAL_SHIFT; by <= y2 >> SPATIAL_SHIFT; by++)
+    {
+        int h = MIN(y2, (by << SPATIAL_SHIFT) + SPATIAL_SIZE - 1) - MAX(y1, by << SPATIAL_SHIFT) + 1;
+
+        for (bx = x1 >> SPATIAL_SHIFT; bx <= x2 >> SPATIAL_SHIFT; bx++)
+        {
+            if (!counts[by * SPATIAL_WID + bx]) continue;
+            area += h * (MIN(x2, (bx << SPATIAL_SHIFT) + SPATIAL_SIZE - 1) - MAX(x1, bx << SPATIAL_SHIFT) + 1);
+        }
+    }
+    return area;
+}
+
+/*
+ * Find the monsters in a rectangle of grids (inclusive), in order of
+ * index, as a sweep of "m_list" would. Returns how many were put in
+ * "who", which must have room for max_m_idx of them.
+ *
+ * Where the blocks to look at hold more grids than there are monsters
+ * (a big rectangle on a quiet level), the sweep is quicker, so do that.
+ */
+int mon_in_rect(int y1, int x1, int y2, int x2, s16b *who)
+{
+    int by, bx, y, x, i, area;
+    int n = 0;
+
+    if (y1 < 0) y1 = 0;
+    if (x1 < 0) x1 = 0;
+    if (y2 > MAX_HGT - 1) y2 = MAX_HGT - 1;
+    if (x2 > MAX_WID - 1) x2 = MAX_WID - 1;
+    if (y1 > y2 || x1 > x2) return 0;
+
+    area = _spatial_area(spatial_mon, y1, x1, y2, x2);
+    if (!area) return 0;
+    if (area > 4 * m_cnt)
+    {
+        for_each_live_mon(i)
+        {
+            monster_type *m_ptr = &m_list[i];
+
+            if (m_ptr->fy < y1 || m_ptr->fy > y2 || m_ptr->fx < x1 || m_ptr->fx > x2) continue;
+            who[n++] = i;
+        }
+        return n;
+    }
+
+    for (by = y1 >> SPATIAL_SHIFT; by <= y2 >> SPATIAL_SHIFT; by++)
+    {
+        int ys = MAX(y1, by << SPATIAL_SHIFT);
+        int ye = MIN(y2, (by << SPATIAL_SHIFT) + SPATIAL_SIZE - 1);
+
+        for (bx = x1 >> SPATIAL_SHIFT; bx <= x2 >> SPATIAL_SHIFT; bx++)
+        {
+            int xs = MAX(x1, bx << SPATIAL_SHIFT);
+            int xe = MIN(x2, (bx << SPATIAL_SHIFT) + SPATIAL_SIZE - 1);
+            int left = spatial_mon[by * SPATIAL_WID + bx];
+
+            /* Stop as soon as every monster in the block is found */
+            for (y = ys; y <= ye && left; y++)
+            {
+                for (x = xs; x <= xe && left; x++)
+                {
+                    if (!cave[y][x].m_idx) continue;
+                    who[n++] = cave[y][x].m_idx;
+                    left--;
+                }
+            }
+        }
+    }
+
+    _spatial_sort(who, n, max_m_idx);
+    return n;
+}
+
+/*
+ * Find the monsters within distance() "r" of a grid, in order of index
+ */
+int mon_in_radius(int y, int x, int r, s16b *who)
+{
+    int i, n = 0;
+    int k = mon_in_rect(y - r, x - r, y + r, x + r, who);
+
+    for (i = 0; i < k; i++)
+    {
+        monster_type *m_ptr = &m_list[who[i]];
+
+        if (distance(y, x, m_ptr->fy, m_ptr->fx) <= r) who[n++] = who[i];
+    }
+    return n;
+}
+
+/*
+ * Find the objects lying on the floor within distance() "r" of a grid,
+ * in order of index. "what" must have room for max_o_idx of them.
+ */
+int obj_in_radius(int y, int x, int r, s16b *what)
+{
+    int y1 = MAX(0, y - r), x1 = MAX(0, x - r);
+    int y2 = MIN(MAX_HGT - 1, y + r), x2 = MIN(MAX_WID - 1, x + r);
+    int by, bx, yy, xx, i, area;
+    int n = 0;
+
+    if (y1 > y2 || x1 > x2) return 0;
+
+    area = _spatial_area(spatial_obj, y1, x1, y2, x2);
+    if (!area) return 0;
+    if (area > 4 * o_cnt)
+    {
+        for (i = 1; i < o_max; i++)
+        {
+            object_type *o_ptr = &o_list[i];
+
+            if (!o_ptr->k_idx || o_ptr->held_m_idx) continue;
+            if (distance(y, x, o_ptr->loc.y, o_ptr->loc.x) > r) continue;
+            what[n++] = i;
+        }
+        return n;
+    }
+
+    for (by = y1 >> SPATIAL_SHIFT; by <= y2 >> SPATIAL_SHIFT; by++)
+    {
+        int ys = MAX(y1, by << SPATIAL_SHIFT);
+        int ye = MIN(y2, (by << SPATIAL_SHIFT) + SPATIAL_SIZE - 1);
+
+        for (bx = x1 >> SPATIAL_SHIFT; bx <= x2 >> SPATIAL_SHIFT; bx++)
+        {
+            int xs = MAX(x1, bx << SPATIAL_SHIFT);
+            int xe = MIN(x2, (bx << SPATIAL_SHIFT) + SPATIAL_SIZE - 1);
+            int left = spatial_obj[by * SPATIAL_WID + bx];
+
+            for (yy = ys; yy <= ye && left; yy++)
+            {
+                for (xx = xs; xx <= xe && left; xx++)
+                {
+                    s16b this_o_idx;
+
+                    if (!cave[yy][xx].o_idx) continue;
+                    left--;
+                    if (distance(y, x, yy, xx) > r) continue;
+
+                    for (this_o_idx = cave[yy][xx].o_idx; this_o_idx; this_o_idx = o_list[this_o_idx].next_o_idx)
+                        what[n++] = this_o_idx;
+                }
+            }
+        }
+    }
+
+    _spatial_sort(what, n, max_o_idx);
+    return n;
+}
+
+
 int conv_dungeon_feat(int newfeat)
 {
     feature_type *f_ptr = &f_info[newfeat];
@@ -5037,7 +6469,16 @@ bool _projectable(int y1, int x1, int y2, int x2)
 
 bool projectable(int y1, int x1, int y2, int x2)
 {
-    bool result = _projectable(y1, x1, y2, x2);
+    los_memo_type *m_ptr;
+    bool result;
+
+    if (!character_dungeon || arg_reference) return _projectable(y1, x1, y2, x2);
+
+    m_ptr = los_memo_find(los_memo_key(y1, x1, y2, x2), project_length);
+    if (m_ptr->epoch) return m_ptr->result;
+
+    result = _projectable(y1, x1, y2, x2);
+    los_memo_save(m_ptr, result);
 #if 0
     if (p_ptr->wizard)
     {
@@ -5052,6 +6493,42 @@ bool projectable(int y1, int x1, int y2, int x2)
 }
 
 
+/*
+ * Debug -- work out every current answer in the memo again and compare.
+ * Returns the number of stale answers (which should always be zero).
+ */
+int los_memo_verify(void)
+{
+    int i, bad = 0;
+    int old_length = project_length;
+
+    for (i = 0; i < LOS_MEMO_SIZE; i++)
+    {
+        los_memo_type *m_ptr = &los_memo[i];
+        int y1, x1, y2, x2;
+        bool result;
+
+        if (m_ptr->epoch != los_memo_epoch) continue;
+
+        y1 = (m_ptr->key >> 23) & 0xff;
+        x1 = (m_ptr->key >> 15) & 0xff;
+        y2 = (m_ptr->key >> 8) & 0x7f;
+        x2 = m_ptr->key & 0xff;
+
+        if (m_ptr->key & LOS_MEMO_LOS) result = los_aux(y1, x1, y2, x2);
+        else
+        {
+            project_length = m_ptr->range;
+            result = _projectable(y1, x1, y2, x2);
+        }
+        if (result != m_ptr->result) bad++;
+    }
+
+    project_length = old_length;
+    return bad;
+}
+
+
 /*
  * Standard "find me a location" function
  *
@@ -1986,6 +1986,8 @@ static void hit_trap(bool break_trap)
                         evil_ptr->target_x = good_ptr->fx;
                         good_ptr->target_y = evil_ptr->fy;
                         good_ptr->target_x = evil_ptr->fx;
+                        mon_sched_wake(evil_idx);
+                        mon_sched_wake(good_idx);
                     }
                 }
             }
@@ -2678,8 +2680,8 @@ static void do_monster_knockback(int x, int y, int dist)
             {
                 int m_idx = cave[oy][ox].m_idx;
 
-                cave[oy][ox].m_idx = 0;
-                cave[ty][tx].m_idx = m_idx;
+                cave_set_m_idx(oy, ox, 0);
+                cave_set_m_idx(ty, tx, m_idx);
                 m_ptr->fy = ty;
                 m_ptr->fx = tx;
 
@@ -3804,8 +3806,8 @@ static bool py_attack_aux(int y, int x, bool *fear, bool *mdeath, s16b hand, int
                             {
                                 int m_idx = cave[oy][ox].m_idx;
 
-                                cave[oy][ox].m_idx = 0;
-                                cave[ty][tx].m_idx = m_idx;
+                                cave_set_m_idx(oy, ox, 0);
+                                cave_set_m_idx(ty, tx, m_idx);
                                 m_ptr->fy = ty;
                                 m_ptr->fx = tx;
 
@@ -4286,7 +4288,7 @@ bool random_opponent(int *y, int *x)
     return FALSE;
 }
 
-bool py_attack(int y, int x, int mode)
+static bool _py_attack(int y, int x, int mode)
 {
     bool            fear = FALSE;
     bool            mdeath = FALSE;
@@ -4548,8 +4550,8 @@ bool py_attack(int y, int x, int mode)
                             continue;
                         }
 
-                        c_ptr->m_idx = 0;
-                        cave[ny][nx].m_idx = m_idx;
+                        cave_set_m_idx(y, x, 0);
+                        cave_set_m_idx(ny, nx, m_idx);
                         m_ptr->fy = ny;
                         m_ptr->fx = nx;
 
@@ -4710,6 +4712,15 @@ bool py_attack(int y, int x, int mode)
     return mdeath;
 }
 
+bool py_attack(int y, int x, int mode)
+{
+    int  stream = Rand_stream_set(RAND_STREAM_COMBAT);
+    bool result = _py_attack(y, x, mode);
+
+    Rand_stream_set(stream);
+    return result;
+}
+
 
 bool pattern_seq(int c_y, int c_x, int n_y, int n_x)
 {
@@ -4988,8 +4999,8 @@ bool move_player_effect(int ny, int nx, u32b mpe_mode)
         if (!(mpe_mode & MPE_DONT_SWAP_MON))
         {
             /* Swap two monsters */
-            c_ptr->m_idx = om_idx;
-            oc_ptr->m_idx = nm_idx;
+            cave_set_m_idx(ny, nx, om_idx);
+            cave_set_m_idx(oy, ox, nm_idx);
 
             if (om_idx > 0) /* Monster on old spot (or p_ptr->riding) */
             {
@@ -3043,7 +3043,7 @@ bool do_cmd_fire_aux1(obj_ptr bow, obj_ptr arrows)
     obj_release(arrows, OBJ_RELEASE_QUIET);
     return TRUE;
 }
-void do_cmd_fire_aux2(obj_ptr bow, obj_ptr arrows, int sx, int sy, int tx, int ty)
+static void _do_cmd_fire_aux2(obj_ptr bow, obj_ptr arrows, int sx, int sy, int tx, int ty)
 {
     int  i, break_chance, y, x, ny, nx, prev_y, prev_x, dd;
     int  tdis, thits, tmul;
@@ -3678,8 +3678,8 @@ void do_cmd_fire_aux2(obj_ptr bow, obj_ptr arrows, int sx, int sy, int tx, int t
                                 /* Stopped by monsters */
                                 if (!cave_empty_bold(ny, nx)) break;
 
-                                cave[ny][nx].m_idx = m_idx;
-                                cave[oy][ox].m_idx = 0;
+                                cave_set_m_idx(ny, nx, m_idx);
+                                cave_set_m_idx(oy, ox, 0);
 
                                 m_ptr->fx = nx;
                                 m_ptr->fy = ny;
@@ -3811,6 +3811,14 @@ void do_cmd_fire_aux2(obj_ptr bow, obj_ptr arrows, int sx, int sy, int tx, int t
     if (p_ptr->concent) reset_concentration(FALSE);
 }
 
+void do_cmd_fire_aux2(obj_ptr bow, obj_ptr arrows, int sx, int sy, int tx, int ty)
+{
+    int stream = Rand_stream_set(RAND_STREAM_COMBAT);
+
+    _do_cmd_fire_aux2(bow, arrows, sx, sy, tx, ty);
+    Rand_stream_set(stream);
+}
+
 
 bool do_cmd_fire(void)
 {
@@ -609,7 +609,7 @@ static void do_cmd_options_cheat(cptr info)
 }
 #endif
 
-static option_type autosave_info[2] =
+static option_type autosave_info[3] =
 {
     { &autosave_l,      TRUE, 255, 0x01, 0x00,
         "autosave_l",    "Autosave when entering new levels" },
@@ -618,6 +618,9 @@ static option_type autosave_info[2] =
     { &autosave_t,      FALSE, 255, 0x02, 0x00,
         "autosave_t",   "Timed autosave" },
 
+    { &compress_savefile, FALSE, 255, 0x00, 0x00,
+        "compress_savefile", "Compress the savefile" },
+
 };
 
 
@@ -646,7 +649,7 @@ static void do_cmd_options_autosave(cptr info)
 {
     char    ch;
 
-    int     i, k = 0, n = 2;
+    int     i, k = 0, n = 3;
 
     char    buf[80];
 
@@ -679,7 +682,7 @@ static void do_cmd_options_autosave(cptr info)
             c_prt(a, buf, i + 2, 0);
         }
 
-        prt(format("Timed autosave frequency: every %d turns",  autosave_freq), 5, 0);
+        prt(format("Timed autosave frequency: every %d turns",  autosave_freq), n + 3, 0);
 
 
 
@@ -737,7 +740,7 @@ static void do_cmd_options_autosave(cptr info)
             {
                 autosave_freq = toggle_frequency(autosave_freq);
                 prt(format("Timed autosave frequency: every %d turns",
-                       autosave_freq), 5, 0);
+                       autosave_freq), n + 3, 0);
                 break;
             }
 
@@ -1189,7 +1192,7 @@ option_fields[OPT_NUM] =
     { 'd', "Base Delay Factor", 12 },
     { 'h', "Hitpoint Warning", 13 },
     { 'm', "Mana Color Threshold", 14 },
-    { 'a', "Autosave Options", 15 },
+    { 'a', "Autosave and Savefile Options", 15 },
     { 'w', "Window Flags", 16 },
 
     { 'b', "Birth Options (Browse Only)", 18 },
@@ -4725,7 +4728,7 @@ static void do_cmd_knowledge_pets(void)
     }
 
     /* Process the monsters (backwards) */
-    for (i = m_max - 1; i >= 1; i--)
+    for_each_live_mon_back(i)
     {
         /* Access the monster */
         m_ptr = &m_list[i];
@@ -19,7 +19,7 @@
 #define VER_MAJOR 6
 #define VER_MINOR 0
 #define VER_PATCH 5
-#define VER_EXTRA 0
+#define VER_EXTRA 2
 
 #define GAME_MODE_BEGINNER  0
 #define GAME_MODE_NORMAL    1
@@ -85,6 +85,17 @@
 #define WILD_SCROLL_CY  (MAX_HGT/3)
 #define WILD_SCROLL_CX  (MAX_WID/3)
 
+/*
+ * The spatial index counts monsters and object piles in blocks of
+ * SPATIAL_SIZE x SPATIAL_SIZE grids (see cave_set_m_idx() in cave.c)
+ */
+#define SPATIAL_SHIFT   3
+#define SPATIAL_SIZE    (1 << SPATIAL_SHIFT)
+#define SPATIAL_HGT     ((MAX_HGT + SPATIAL_SIZE - 1) >> SPATIAL_SHIFT)
+#define SPATIAL_WID     ((MAX_WID + SPATIAL_SIZE - 1) >> SPATIAL_SHIFT)
+#define spatial_idx(Y,X) \
+    (((Y) >> SPATIAL_SHIFT) * SPATIAL_WID + ((X) >> SPATIAL_SHIFT))
+
 /*
  * Arena constants
  */
@@ -238,8 +249,9 @@
 #define MACRO_MAX       256
 
 /*
- * OPTION: Maximum number of "quarks" (see "io.c")
+ * OPTION: Initial number of "quarks" (see "util.c")
  * Default: assume at most 512 different inscriptions are used
+ * (the table grows as needed)
  */
 #define QUARK_MAX       1024
 /* Was 512... 256 quarks added for random artifacts */
@@ -3820,6 +3832,17 @@ enum r_drop_e
 #define is_hostile(A) \
      (bool)((is_friendly(A) || is_pet(A)) ? FALSE : TRUE)
 
+/*
+ * Visit each live monster in "m_list", in order of index, skipping the
+ * dead a word of "m_live" at a time. Monsters may be born or die during
+ * the sweep, just as with a plain scan up to "m_max".
+ */
+#define for_each_live_mon(I) \
+     for ((I) = mon_live_next(0); (I); (I) = mon_live_next(I))
+
+#define for_each_live_mon_back(I) \
+     for ((I) = mon_live_prev(m_max); (I); (I) = mon_live_prev(I))
+
 /* Hack -- Determine monster race appearance index is same as race index */
 #define is_original_ap(A) \
      (bool)(((A)->ap_r_idx == (A)->r_idx) ? TRUE : FALSE)
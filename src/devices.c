@@ -3544,7 +3544,7 @@ cptr do_effect(effect_t *effect, int mode, int boost)
         if (cast)
         {
             int i;
-            for (i = m_max - 1; i >= 1; i--)
+            for_each_live_mon_back(i)
             {
                 if (!m_list[i].r_idx) continue;
                 if (r_info[m_list[i].r_idx].flags1 & RF1_UNIQUE)
@@ -4284,7 +4284,7 @@ cptr do_effect(effect_t *effect, int mode, int boost)
 
             C_MAKE(who, max_m_idx, u16b);
 
-            for (pet_ctr = m_max - 1; pet_ctr >= 1; pet_ctr--)
+            for_each_live_mon_back(pet_ctr)
             {
                 if (is_pet(&m_list[pet_ctr]) && (p_ptr->riding != pet_ctr))
                     who[max_pet++] = pet_ctr;
@@ -6648,7 +6648,7 @@ cptr do_effect(effect_t *effect, int mode, int boost)
             }
             if (!count)
             {
-                for (i = m_max - 1; i > 0; i--)
+                for_each_live_mon_back(i)
                 {
                     m_ptr = &m_list[i];
                     if (!m_ptr->r_idx) continue;
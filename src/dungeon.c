@@ -19,6 +19,17 @@
 static bool load = TRUE;
 static int wild_regen = 20;
 
+#ifdef USE_TEST
+/*
+ * Cpu time spent processing the player, the monsters and the world,
+ * for the headless benchmark front end (main-test.c)
+ */
+clock_t sim_clock[3];
+# define sim_timed(I, CALL) { clock_t _start = clock(); CALL; sim_clock[(I)] += clock() - _start; }
+#else
+# define sim_timed(I, CALL) CALL
+#endif
+
 /*
  * Return a "feeling" (or NULL) about an item. Method 1 (Heavy).
  *
@@ -634,7 +645,7 @@ static void regen_monsters(void)
 
 
     /* Regenerate everyone */
-    for (i = 1; i < m_max; i++)
+    for_each_live_mon(i)
     {
         /* Check the i'th monster */
         monster_type *m_ptr = &m_list[i];
@@ -2307,7 +2318,7 @@ static byte get_dungeon_feeling(void)
     if (!dun_level) return 0;
 
     /* Examine each monster */
-    for (i = 1; i < m_max; i++)
+    for_each_live_mon(i)
     {
         monster_type *m_ptr = &m_list[i];
         monster_race *r_ptr;
@@ -2593,6 +2604,9 @@ static void process_world(void)
         }
     }
 
+    /*** Note background saves that are done ***/
+    savefile_poll();
+
     /*** Attempt timed autosave ***/
     if (autosave_t && autosave_freq && !p_ptr->inside_battle)
     {
@@ -2880,8 +2894,12 @@ static void process_world(void)
     /* Process timed damage and regeneration */
     process_world_aux_hp_and_sp();
 
-    /* Process timeout */
+    /* Process timeout. Each effect that runs out asks for the bonuses
+       again, so let those pile up and work them out once */
+    update_hold = TRUE;
     process_world_aux_timeout();
+    update_hold = FALSE;
+    handle_stuff();
 
     /* Process light */
     process_world_aux_light();
@@ -3982,7 +4000,7 @@ static void process_player(void)
 
     if (p_ptr->inside_battle)
     {
-        for(i = 1; i < m_max; i++)
+        for_each_live_mon(i)
         {
             monster_type *m_ptr = &m_list[i];
 
@@ -4470,7 +4488,7 @@ static void process_player(void)
                 shimmer_monsters = FALSE;
 
                 /* Shimmer multi-hued monsters */
-                for (i = 1; i < m_max; i++)
+                for_each_live_mon(i)
                 {
                     monster_type *m_ptr;
                     monster_race *r_ptr;
@@ -4494,7 +4512,7 @@ static void process_player(void)
             {
                 repair_monsters = FALSE;
 
-                for (i = 1; i < m_max; i++)
+                for_each_live_mon(i)
                 {
                     monster_type *m_ptr;
 
@@ -4751,19 +4769,20 @@ static void dungeon(bool load_game)
         /* Hack -- Compact the monster list occasionally */
         if ((m_cnt + 32 > max_m_idx) && !p_ptr->inside_battle) compact_monsters(64);
 
-        /* Hack -- Compress the monster list occasionally */
-        if ((m_cnt + 32 < m_max) && !p_ptr->inside_battle) compact_monsters(0);
+        /* Hack -- Compress the monster list once holes are a good part of
+           it (m_pop() refills them, so they only build up as it shrinks) */
+        if ((m_cnt + MAX(32, m_max / 4) < m_max) && !p_ptr->inside_battle) compact_monsters(0);
 
 
         /* Hack -- Compact the object list occasionally */
         if (o_cnt + 32 > max_o_idx) compact_objects(64);
 
-        /* Hack -- Compress the object list occasionally */
-        if (o_cnt + 32 < o_max) compact_objects(0);
+        /* Hack -- Compress the object list once holes are a good part of it */
+        if (o_cnt + MAX(32, o_max / 4) < o_max) compact_objects(0);
 
 
         /* Process the player */
-        process_player();
+        sim_timed(0, process_player());
 
         /* Handle "p_ptr->notice" */
         notice_stuff();
@@ -4781,7 +4800,7 @@ static void dungeon(bool load_game)
         if (!p_ptr->playing || p_ptr->is_dead) break;
 
         /* Process all of the monsters */
-        process_monsters();
+        sim_timed(1, process_monsters());
 
 #ifdef _DEBUG
         if (p_ptr->action == ACTION_GLITTER)
@@ -4809,7 +4828,7 @@ static void dungeon(bool load_game)
 
 
         /* Process the world */
-        process_world();
+        sim_timed(2, process_world());
 
         /* Handle "p_ptr->notice" */
         notice_stuff();
@@ -5079,7 +5098,7 @@ void play_game(bool new_game)
 
     /* The Windows port blocks until the user chooses a menu for a New game, or
        to load an existing game. Thus, it will display its own start screen ... */
-    if (strcmp(ANGBAND_SYS, "win") != 0)
+    if (strcmp(ANGBAND_SYS, "win") != 0 && strcmp(ANGBAND_SYS, "test") != 0)
     {
         /* On X11, you need to flush() before Term->hgt is accurate! */
         Term_flush();
@@ -5130,6 +5149,9 @@ void play_game(bool new_game)
         process_player_name(FALSE);
     }
 
+    /* Hack -- reproducible new games */
+    if (new_game && arg_seed) Rand_quick = TRUE;
+
     /* Init the RNG */
     if (Rand_quick)
     {
@@ -5145,6 +5167,9 @@ void play_game(bool new_game)
 
 #endif
 
+        /* Hack -- reproducible games */
+        if (arg_seed) seed = arg_seed;
+
         /* Use the complex RNG */
         Rand_quick = FALSE;
 
@@ -1019,10 +1019,248 @@ void equip_xtra_might(int pval)
     }
 }
 
+/* Bonus Cache: Each slot remembers what its object grants on its own (flags,
+   pval bonuses and resistances) together with the fields of the object it
+   was worked out from: those _bonus_calc() reads, directly or through
+   obj_flags(). A pass compares them and only works out again the slots
+   whose object has changed, by swapping or in place; everything that
+   depends on the rest of the player is still done on every pass. */
+typedef struct {
+    s16b        k_idx;
+    s16b        pval;
+    s16b        name1;
+    s16b        name2;
+    byte        xtra1;
+    byte        xtra3;
+    s16b        xtra4;
+    u32b        flags[OF_ARRAY_SIZE];
+} _bonus_key_t;
+
+typedef struct {
+    _bonus_key_t key;
+    u32b        flgs[OF_ARRAY_SIZE];
+    s16b        stat_add[MAX_STATS];
+    s16b        resist[RES_MAX];
+    s16b        dev, device_power, stl, srh, fos;
+    s16b        see_infra, skill_dig, pspeed, num_fire, life;
+    s16b        spell_power, spell_cap, magic_resistance, regen;
+} _bonus_t, *_bonus_ptr;
+
+static _bonus_t _bonus[EQUIP_MAX + 1];
+
+static bool _bonus_match(_bonus_ptr bonus, obj_ptr obj)
+{
+    _bonus_key_t *key = &bonus->key;
+    int           i;
+
+    if (key->k_idx != obj->k_idx || key->pval != obj->pval) return FALSE;
+    if (key->name1 != obj->name1 || key->name2 != obj->name2) return FALSE;
+    if (key->xtra1 != obj->xtra1 || key->xtra3 != obj->xtra3) return FALSE;
+    if (key->xtra4 != obj->xtra4) return FALSE;
+    for (i = 0; i < OF_ARRAY_SIZE; i++)
+    {
+        if (key->flags[i] != obj->flags[i]) return FALSE;
+    }
+    return TRUE;
+}
+
+static void _bonus_calc(obj_ptr obj, _bonus_ptr bonus)
+{
+    u32b *flgs = bonus->flgs;
+    int   pval = obj->pval;
+    int   i;
+
+    WIPE(bonus, _bonus_t);
+    bonus->key.k_idx = obj->k_idx;
+    bonus->key.pval = obj->pval;
+    bonus->key.name1 = obj->name1;
+    bonus->key.name2 = obj->name2;
+    bonus->key.xtra1 = obj->xtra1;
+    bonus->key.xtra3 = obj->xtra3;
+    bonus->key.xtra4 = obj->xtra4;
+    for (i = 0; i < OF_ARRAY_SIZE; i++)
+        bonus->key.flags[i] = obj->flags[i];
+    obj_flags(obj, flgs);
+
+    if (have_flag(flgs, OF_STR)) bonus->stat_add[A_STR] += pval;
+    if (have_flag(flgs, OF_INT)) bonus->stat_add[A_INT] += pval;
+    if (have_flag(flgs, OF_WIS)) bonus->stat_add[A_WIS] += pval;
+    if (have_flag(flgs, OF_DEX)) bonus->stat_add[A_DEX] += pval;
+    if (have_flag(flgs, OF_CON)) bonus->stat_add[A_CON] += pval;
+    if (have_flag(flgs, OF_CHR)) bonus->stat_add[A_CHR] += pval;
+
+    if (have_flag(flgs, OF_DEC_STR)) bonus->stat_add[A_STR] -= pval;
+    if (have_flag(flgs, OF_DEC_INT)) bonus->stat_add[A_INT] -= pval;
+    if (have_flag(flgs, OF_DEC_WIS)) bonus->stat_add[A_WIS] -= pval;
+    if (have_flag(flgs, OF_DEC_DEX)) bonus->stat_add[A_DEX] -= pval;
+    if (have_flag(flgs, OF_DEC_CON)) bonus->stat_add[A_CON] -= pval;
+    if (have_flag(flgs, OF_DEC_CHR)) bonus->stat_add[A_CHR] -= pval;
+
+    if (have_flag(flgs, OF_MAGIC_MASTERY))
+        bonus->dev += 8*pval;
+
+    if (have_flag(flgs, OF_DEVICE_POWER))
+        bonus->device_power += pval;
+
+    if (have_flag(flgs, OF_DEC_MAGIC_MASTERY))
+    {
+        bonus->dev -= 8*pval;
+        bonus->device_power -= pval;
+    }
+
+    if (have_flag(flgs, OF_STEALTH)) bonus->stl += pval;
+    if (have_flag(flgs, OF_DEC_STEALTH)) bonus->stl -= pval;
+    if (have_flag(flgs, OF_SEARCH)) bonus->srh += (pval * 5);
+    if (have_flag(flgs, OF_SEARCH)) bonus->fos += (pval * 5);
+    if (have_flag(flgs, OF_INFRA)) bonus->see_infra += pval;
+    if (have_flag(flgs, OF_TUNNEL)) bonus->skill_dig += (pval * 20);
+    if (have_flag(flgs, OF_SPEED)) bonus->pspeed += pval;
+    if (have_flag(flgs, OF_DEC_SPEED)) bonus->pspeed -= pval;
+
+    if (have_flag(flgs, OF_XTRA_SHOTS))
+        bonus->num_fire += 15 * pval;
+
+    if (have_flag(flgs, OF_LIFE))
+        bonus->life += 3*pval;
+    if (have_flag(flgs, OF_DEC_LIFE))
+        bonus->life -= 3*pval;
+
+    if (have_flag(flgs, OF_SPELL_POWER)) bonus->spell_power += pval;
+    if (have_flag(flgs, OF_DEC_SPELL_POWER)) bonus->spell_power -= pval;
+    if (have_flag(flgs, OF_SPELL_CAP))   bonus->spell_cap += pval;
+    if (have_flag(flgs, OF_DEC_SPELL_CAP))   bonus->spell_cap -= pval;
+    if (have_flag(flgs, OF_MAGIC_RESISTANCE))   bonus->magic_resistance += 5*pval;
+
+    if (have_flag(flgs, OF_REGEN))       bonus->regen += 100;
+
+    res_calc_amts(flgs, bonus->resist);
+}
+
+static _bonus_ptr _slot_bonus(slot_t slot, obj_ptr obj)
+{
+    _bonus_ptr bonus = &_bonus[slot];
+
+    if (!_bonus_match(bonus, obj))
+        _bonus_calc(obj, bonus);
+
+    return bonus;
+}
+
+static void _bonus_apply(_bonus_ptr bonus)
+{
+    int i;
+
+    for (i = 0; i < MAX_STATS; i++)
+        p_ptr->stat_add[i] += bonus->stat_add[i];
+    for (i = 0; i < RES_MAX; i++)
+        p_ptr->resist[i] += bonus->resist[i];
+
+    p_ptr->skills.dev += bonus->dev;
+    p_ptr->device_power += bonus->device_power;
+    p_ptr->skills.stl += bonus->stl;
+    p_ptr->skills.srh += bonus->srh;
+    p_ptr->skills.fos += bonus->fos;
+    p_ptr->see_infra += bonus->see_infra;
+    p_ptr->skill_dig += bonus->skill_dig;
+    p_ptr->pspeed += bonus->pspeed;
+    p_ptr->shooter_info.num_fire += bonus->num_fire;
+    p_ptr->life += bonus->life;
+    p_ptr->spell_power += bonus->spell_power;
+    p_ptr->spell_cap += bonus->spell_cap;
+    p_ptr->magic_resistance += bonus->magic_resistance;
+    p_ptr->regen += bonus->regen;
+}
+
+static void _flags_apply(u32b flgs[OF_ARRAY_SIZE])
+{
+    if (have_flag(flgs, OF_SLOW_DIGEST)) p_ptr->slow_digest = TRUE;
+    if (have_flag(flgs, OF_TELEPATHY))   p_ptr->telepathy = TRUE;
+    if (have_flag(flgs, OF_ESP_ANIMAL))  p_ptr->esp_animal = TRUE;
+    if (have_flag(flgs, OF_ESP_UNDEAD))  p_ptr->esp_undead = TRUE;
+    if (have_flag(flgs, OF_ESP_DEMON))   p_ptr->esp_demon = TRUE;
+    if (have_flag(flgs, OF_ESP_ORC))     p_ptr->esp_orc = TRUE;
+    if (have_flag(flgs, OF_ESP_TROLL))   p_ptr->esp_troll = TRUE;
+    if (have_flag(flgs, OF_ESP_GIANT))   p_ptr->esp_giant = TRUE;
+    if (have_flag(flgs, OF_ESP_DRAGON))  p_ptr->esp_dragon = TRUE;
+    if (have_flag(flgs, OF_ESP_HUMAN))   p_ptr->esp_human = TRUE;
+    if (have_flag(flgs, OF_ESP_EVIL))    p_ptr->esp_evil = TRUE;
+    if (have_flag(flgs, OF_ESP_GOOD))    p_ptr->esp_good = TRUE;
+    if (have_flag(flgs, OF_ESP_NONLIVING)) p_ptr->esp_nonliving = TRUE;
+    if (have_flag(flgs, OF_ESP_UNIQUE))  p_ptr->esp_unique = TRUE;
+
+    if (have_flag(flgs, OF_SEE_INVIS))   p_ptr->see_inv = TRUE;
+    if (have_flag(flgs, OF_LEVITATION))  p_ptr->levitation = TRUE;
+    if (have_flag(flgs, OF_FREE_ACT))    p_ptr->free_act = TRUE;
+    if (have_flag(flgs, OF_HOLD_LIFE))   p_ptr->hold_life = TRUE;
+
+    if (have_flag(flgs, OF_REFLECT))  p_ptr->reflect = TRUE;
+    if (have_flag(flgs, OF_AURA_FIRE))  p_ptr->sh_fire = TRUE;
+    if (have_flag(flgs, OF_AURA_ELEC))  p_ptr->sh_elec = TRUE;
+    if (have_flag(flgs, OF_AURA_COLD))  p_ptr->sh_cold = TRUE;
+    if (have_flag(flgs, OF_AURA_SHARDS))  p_ptr->sh_shards = TRUE;
+    if (have_flag(flgs, OF_AURA_REVENGE))  p_ptr->sh_retaliation = TRUE;
+    if (have_flag(flgs, OF_NO_MAGIC)) p_ptr->anti_magic = TRUE;
+    if (have_flag(flgs, OF_NO_TELE))  p_ptr->anti_tele = TRUE;
+    if (have_flag(flgs, OF_NO_SUMMON)) p_ptr->anti_summon = TRUE;
+
+    if (have_flag(flgs, OF_SUST_STR)) p_ptr->sustain_str = TRUE;
+    if (have_flag(flgs, OF_SUST_INT)) p_ptr->sustain_int = TRUE;
+    if (have_flag(flgs, OF_SUST_WIS)) p_ptr->sustain_wis = TRUE;
+    if (have_flag(flgs, OF_SUST_DEX)) p_ptr->sustain_dex = TRUE;
+    if (have_flag(flgs, OF_SUST_CON)) p_ptr->sustain_con = TRUE;
+    if (have_flag(flgs, OF_SUST_CHR)) p_ptr->sustain_chr = TRUE;
+}
+
+void equip_forget_bonuses(void)
+{
+    C_WIPE(_bonus, EQUIP_MAX + 1, _bonus_t);
+}
+
+/* Debug check: every slot whose cached bonuses would be taken as they
+   stand must match its object worked out afresh, and (when no update is
+   pending) a cached pass of calc_bonuses() must leave the player as a
+   pass that works every slot out afresh does. The player and the cache
+   are put back afterwards, so checking never changes the game. Returns
+   the number of disagreements. */
+int equip_verify_bonuses(void)
+{
+    static player_type saved, cached;
+    _bonus_t fresh;
+    slot_t   slot;
+    int      bad = 0;
+
+    for (slot = 1; slot <= _template->max; slot++)
+    {
+        obj_ptr obj = inv_obj(_inv, slot);
+
+        if (!obj || !_bonus_match(&_bonus[slot], obj)) continue;
+        _bonus_calc(obj, &fresh);
+        if (memcmp(&fresh, &_bonus[slot], sizeof(_bonus_t))) bad++;
+    }
+
+    if (!character_dungeon || (p_ptr->update & PU_BONUS)) return bad;
+
+    COPY(&saved, p_ptr, player_type);
+    calc_bonuses();
+    COPY(&cached, p_ptr, player_type);
+
+    COPY(p_ptr, &saved, player_type);
+    equip_forget_bonuses();
+    calc_bonuses();
+    if (memcmp(&cached, p_ptr, sizeof(player_type))) bad++;
+
+    COPY(p_ptr, &saved, player_type);
+    return bad;
+}
+
 void equip_calc_bonuses(void)
 {
     slot_t slot;
     int    i;
+    u32b   all_flgs[OF_ARRAY_SIZE];
+
+    /* The reference routine works every slot out afresh */
+    if (arg_reference) equip_forget_bonuses();
 
     /* Find the weapons */
     for (slot = 1; slot <= _template->max; slot++)
@@ -1172,15 +1410,23 @@ void equip_calc_bonuses(void)
     }
 
     /* Scan equipment for bonuses. */
+    for (i = 0; i < OF_ARRAY_SIZE; i++)
+        all_flgs[i] = 0;
+
     for (slot = 1; slot <= _template->max; slot++)
     {
-        obj_ptr obj = inv_obj(_inv, slot);
-        u32b    flgs[OF_ARRAY_SIZE];
-        int     bonus_to_h, bonus_to_d;
+        obj_ptr    obj = inv_obj(_inv, slot);
+        _bonus_ptr bonus;
+        u32b      *flgs;
+        int        bonus_to_h, bonus_to_d;
 
         if (!obj) continue;
 
-        obj_flags(obj, flgs);
+        bonus = _slot_bonus(slot, obj);
+        _bonus_apply(bonus);
+        flgs = bonus->flgs;
+        for (i = 0; i < OF_ARRAY_SIZE; i++)
+            all_flgs[i] |= flgs[i];
 
         p_ptr->cursed |= obj->curse_flags;
         if (p_ptr->cursed)
@@ -1213,41 +1459,6 @@ void equip_calc_bonuses(void)
             rune_calc_stats(obj, p_ptr->stat_add);
         }
 
-        if (have_flag(flgs, OF_STR)) p_ptr->stat_add[A_STR] += obj->pval;
-        if (have_flag(flgs, OF_INT)) p_ptr->stat_add[A_INT] += obj->pval;
-        if (have_flag(flgs, OF_WIS)) p_ptr->stat_add[A_WIS] += obj->pval;
-        if (have_flag(flgs, OF_DEX)) p_ptr->stat_add[A_DEX] += obj->pval;
-        if (have_flag(flgs, OF_CON)) p_ptr->stat_add[A_CON] += obj->pval;
-        if (have_flag(flgs, OF_CHR)) p_ptr->stat_add[A_CHR] += obj->pval;
-
-        if (have_flag(flgs, OF_DEC_STR)) p_ptr->stat_add[A_STR] -= obj->pval;
-        if (have_flag(flgs, OF_DEC_INT)) p_ptr->stat_add[A_INT] -= obj->pval;
-        if (have_flag(flgs, OF_DEC_WIS)) p_ptr->stat_add[A_WIS] -= obj->pval;
-        if (have_flag(flgs, OF_DEC_DEX)) p_ptr->stat_add[A_DEX] -= obj->pval;
-        if (have_flag(flgs, OF_DEC_CON)) p_ptr->stat_add[A_CON] -= obj->pval;
-        if (have_flag(flgs, OF_DEC_CHR)) p_ptr->stat_add[A_CHR] -= obj->pval;
-
-        if (have_flag(flgs, OF_MAGIC_MASTERY))
-            p_ptr->skills.dev += 8*obj->pval;
-
-        if (have_flag(flgs, OF_DEVICE_POWER))
-            p_ptr->device_power += obj->pval;
-
-        if (have_flag(flgs, OF_DEC_MAGIC_MASTERY))
-        {
-            p_ptr->skills.dev -= 8*obj->pval;
-            p_ptr->device_power -= obj->pval;
-        }
-
-        if (have_flag(flgs, OF_STEALTH)) p_ptr->skills.stl += obj->pval;
-        if (have_flag(flgs, OF_DEC_STEALTH)) p_ptr->skills.stl -= obj->pval;
-        if (have_flag(flgs, OF_SEARCH)) p_ptr->skills.srh += (obj->pval * 5);
-        if (have_flag(flgs, OF_SEARCH)) p_ptr->skills.fos += (obj->pval * 5);
-        if (have_flag(flgs, OF_INFRA)) p_ptr->see_infra += obj->pval;
-        if (have_flag(flgs, OF_TUNNEL)) p_ptr->skill_dig += (obj->pval * 20);
-        if (have_flag(flgs, OF_SPEED)) p_ptr->pspeed += obj->pval;
-        if (have_flag(flgs, OF_DEC_SPEED)) p_ptr->pspeed -= obj->pval;
-
         if (have_flag(flgs, OF_BLOWS) || have_flag(flgs, OF_DEC_BLOWS))
         {
             int hand = _template->slots[slot].hand;
@@ -1342,14 +1553,6 @@ void equip_calc_bonuses(void)
             _weapon_info_flag(slot, flgs, OF_BRAND_VAMP); /* Dragon Armor (Death), Helm of the Vampire */
         }
 
-        if (have_flag(flgs, OF_XTRA_SHOTS))
-            p_ptr->shooter_info.num_fire += 15 * obj->pval;
-
-        if (have_flag(flgs, OF_LIFE))
-            p_ptr->life += 3*obj->pval;
-        if (have_flag(flgs, OF_DEC_LIFE))
-            p_ptr->life -= 3*obj->pval;
-
         if (have_flag(flgs, OF_AGGRAVATE))   p_ptr->cursed |= OFC_AGGRAVATE;
         if (have_flag(flgs, OF_DRAIN_EXP))   p_ptr->cursed |= OFC_DRAIN_EXP;
         if (have_flag(flgs, OF_TY_CURSE))    p_ptr->cursed |= OFC_TY_CURSE;
@@ -1380,35 +1583,9 @@ void equip_calc_bonuses(void)
                 p_ptr->easy_spell = TRUE;
         }
 
-        if (have_flag(flgs, OF_SPELL_POWER)) p_ptr->spell_power += obj->pval;
-        if (have_flag(flgs, OF_DEC_SPELL_POWER)) p_ptr->spell_power -= obj->pval;
-        if (have_flag(flgs, OF_SPELL_CAP))   p_ptr->spell_cap += obj->pval;
-        if (have_flag(flgs, OF_DEC_SPELL_CAP))   p_ptr->spell_cap -= obj->pval;
-        if (have_flag(flgs, OF_MAGIC_RESISTANCE))   p_ptr->magic_resistance += 5*obj->pval;
-
         if (have_flag(flgs, OF_XTRA_MIGHT) && obj->tval != TV_BOW)
             equip_xtra_might(obj->pval);
 
-        if (have_flag(flgs, OF_SLOW_DIGEST)) p_ptr->slow_digest = TRUE;
-        if (have_flag(flgs, OF_REGEN))       p_ptr->regen += 100;
-        if (have_flag(flgs, OF_TELEPATHY))   p_ptr->telepathy = TRUE;
-        if (have_flag(flgs, OF_ESP_ANIMAL))  p_ptr->esp_animal = TRUE;
-        if (have_flag(flgs, OF_ESP_UNDEAD))  p_ptr->esp_undead = TRUE;
-        if (have_flag(flgs, OF_ESP_DEMON))   p_ptr->esp_demon = TRUE;
-        if (have_flag(flgs, OF_ESP_ORC))     p_ptr->esp_orc = TRUE;
-        if (have_flag(flgs, OF_ESP_TROLL))   p_ptr->esp_troll = TRUE;
-        if (have_flag(flgs, OF_ESP_GIANT))   p_ptr->esp_giant = TRUE;
-        if (have_flag(flgs, OF_ESP_DRAGON))  p_ptr->esp_dragon = TRUE;
-        if (have_flag(flgs, OF_ESP_HUMAN))   p_ptr->esp_human = TRUE;
-        if (have_flag(flgs, OF_ESP_EVIL))    p_ptr->esp_evil = TRUE;
-        if (have_flag(flgs, OF_ESP_GOOD))    p_ptr->esp_good = TRUE;
-        if (have_flag(flgs, OF_ESP_NONLIVING)) p_ptr->esp_nonliving = TRUE;
-        if (have_flag(flgs, OF_ESP_UNIQUE))  p_ptr->esp_unique = TRUE;
-
-        if (have_flag(flgs, OF_SEE_INVIS))   p_ptr->see_inv = TRUE;
-        if (have_flag(flgs, OF_LEVITATION))  p_ptr->levitation = TRUE;
-        if (have_flag(flgs, OF_FREE_ACT))    p_ptr->free_act = TRUE;
-        if (have_flag(flgs, OF_HOLD_LIFE))   p_ptr->hold_life = TRUE;
         if (have_flag(flgs, OF_WARNING))
         {
             if (!obj->inscription || !(my_strchr(quark_str(obj->inscription),'$')))
@@ -1426,25 +1603,6 @@ void equip_calc_bonuses(void)
             }
         }
 
-        res_calc_bonuses(flgs);
-
-        if (have_flag(flgs, OF_REFLECT))  p_ptr->reflect = TRUE;
-        if (have_flag(flgs, OF_AURA_FIRE))  p_ptr->sh_fire = TRUE;
-        if (have_flag(flgs, OF_AURA_ELEC))  p_ptr->sh_elec = TRUE;
-        if (have_flag(flgs, OF_AURA_COLD))  p_ptr->sh_cold = TRUE;
-        if (have_flag(flgs, OF_AURA_SHARDS))  p_ptr->sh_shards = TRUE;
-        if (have_flag(flgs, OF_AURA_REVENGE))  p_ptr->sh_retaliation = TRUE;
-        if (have_flag(flgs, OF_NO_MAGIC)) p_ptr->anti_magic = TRUE;
-        if (have_flag(flgs, OF_NO_TELE))  p_ptr->anti_tele = TRUE;
-        if (have_flag(flgs, OF_NO_SUMMON)) p_ptr->anti_summon = TRUE;
-
-        if (have_flag(flgs, OF_SUST_STR)) p_ptr->sustain_str = TRUE;
-        if (have_flag(flgs, OF_SUST_INT)) p_ptr->sustain_int = TRUE;
-        if (have_flag(flgs, OF_SUST_WIS)) p_ptr->sustain_wis = TRUE;
-        if (have_flag(flgs, OF_SUST_DEX)) p_ptr->sustain_dex = TRUE;
-        if (have_flag(flgs, OF_SUST_CON)) p_ptr->sustain_con = TRUE;
-        if (have_flag(flgs, OF_SUST_CHR)) p_ptr->sustain_chr = TRUE;
-
         if (have_flag(flgs, OF_DUAL_WIELDING))
         {
             switch (_template->slots[slot].type)
@@ -1603,6 +1761,9 @@ void equip_calc_bonuses(void)
             _weaponmastery(slot, obj->pval);
         }
     }
+
+    /* Flags that merely switch something on need testing only once */
+    _flags_apply(all_flgs);
 }
 
 void equip_init(void)
@@ -1615,6 +1776,7 @@ void equip_init(void)
 
     inv_free(_inv);
     _inv = inv_alloc("Equipment", INV_EQUIP, EQUIP_MAX);
+    equip_forget_bonuses();
 }
 
 /* Attempt to gracefully handle changes to body type between
@@ -60,6 +60,8 @@ extern void    equip_remove(slot_t slot);
     /* helper fn ... try equip_takeoff instead */
 
 extern void    equip_calc_bonuses(void);
+extern void    equip_forget_bonuses(void);
+extern int     equip_verify_bonuses(void);
 extern void    equip_xtra_might(int pval);
 extern inv_ptr equip_filter(obj_p p);
 extern void    equip_for_each(obj_f f);
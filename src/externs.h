@@ -128,12 +128,15 @@ extern bool arg_monochrome;
 extern bool arg_force_original;
 extern bool arg_force_roguelike;
 extern bool arg_bigtile;
+extern u32b arg_seed;
+extern bool arg_reference;
 extern bool character_generated;
 extern bool character_dungeon;
 extern bool character_loaded;
 extern bool character_saved;
 extern bool character_icky;
 extern bool character_xtra;
+extern bool update_hold;
 extern bool creating_savefile;
 extern u32b seed_flavor;
 extern u32b seed_town;
@@ -181,8 +184,10 @@ extern bool repair_monsters;
 extern bool repair_objects;
 extern s16b o_max;
 extern s16b o_cnt;
+extern s16b o_free_list;
 extern s16b m_max;
 extern s16b m_cnt;
+extern s16b m_free_list;
 extern s16b hack_m_idx;
 extern int hack_m_spell;
 extern s16b hack_m_idx_ii;
@@ -256,7 +261,6 @@ extern bool display_food_bar;    /* Like the monster health bar, only tastier! *
 extern bool display_hp_bar; /* Display player HP just like the monster health bar */
 extern bool display_sp_bar; /* Display player SP just like the monster health bar */
 extern bool display_percentages; /* 63% rather than [******----] */
-extern bool compress_savefile;    /* Compress messages in savefiles */
 extern bool abbrev_extra;    /* Describe obj's extra resistances by abbreviation */
 extern bool abbrev_all;    /* Describe obj's all resistances by abbreviation */
 extern bool exp_need;    /* Show the experience needed for next level */
@@ -275,6 +279,7 @@ extern bool always_small_levels;    /* Always create unusually small dungeon lev
 extern bool empty_levels;    /* Allow empty 'arena' levels */
 extern bool bound_walls_perm;    /* Boundary walls become 'permanent wall' */
 extern bool last_words;    /* Leave last words when your character dies */
+extern bool compress_savefile;    /* Compress the savefile */
 
 #ifdef WORLD_SCORE
 extern bool send_score;    /* Send score dump to the world score server */
@@ -404,6 +409,8 @@ extern char angband_term_name[8][16];
 extern byte angband_color_table[256][4];
 extern char angband_sound_name[SOUND_MAX][16];
 extern cave_type *cave[MAX_HGT];
+extern byte *spatial_mon;
+extern byte *spatial_obj;
 extern saved_floor_type saved_floors[MAX_SAVED_FLOORS];
 extern s16b max_floor_id;
 extern u32b saved_floor_file_sign;
@@ -418,10 +425,14 @@ extern s16b pack_info_count;
 
 extern s16b *mproc_list[MAX_MTIMED];
 extern s16b mproc_max[MAX_MTIMED];
+extern u32b *m_idle;
+extern u32b *m_live;
 extern s16b alloc_kind_size;
 extern alloc_entry *alloc_kind_table;
+extern u32b alloc_kind_stamp;
 extern s16b alloc_race_size;
 extern alloc_entry *alloc_race_table;
+extern u32b alloc_race_stamp;
 extern byte misc_to_attr[256];
 extern char misc_to_char[256];
 extern byte tval_to_attr[128];
@@ -597,6 +608,9 @@ extern errr process_autopick_file_command(char *buf);
 #define AUTOPICK_COLOR_CODED 0x01
 extern string_ptr autopick_line_from_entry(autopick_type *entry, int options);
 extern int is_autopick(object_type *o_ptr);
+extern int autopick_verify(void);
+extern void autopick_forget(void);
+extern void autopick_for_each_obj(obj_f f);
 extern void autopick_alter_obj(obj_ptr o_ptr, bool allow_destroy);
 extern void autopick_get_floor(void);
 extern bool autopick_autoregister(object_type *o_ptr);
@@ -629,6 +643,8 @@ extern bool is_closed_door(int feat);
 extern bool is_hidden_door(cave_type *c_ptr);
 extern bool is_jammed_door(int feat);
 extern bool los(int y1, int x1, int y2, int x2);
+extern void los_memo_wipe(void);
+extern int  los_memo_verify(void);
 extern void update_local_illumination(int y, int x);
 extern bool player_can_see_bold(int y, int x);
 extern bool cave_valid_bold(int y, int x);
@@ -640,6 +656,9 @@ extern void print_rel(char c, byte a, int y, int x);
 extern void note_spot(int y, int x);
 extern void display_dungeon(void);
 extern void lite_spot(int y, int x);
+extern void lite_spot_batch_begin(void);
+extern void lite_spot_batch_end(void);
+extern void lite_spot_flush(void);
 extern void prt_map(void);
 extern void prt_path(int y, int x, int xtra_flgs);
 extern void display_map(int *cy, int *cx);
@@ -648,17 +667,39 @@ extern void forget_lite(void);
 extern void update_lite(void);
 extern void forget_view(void);
 extern void update_view(void);
+extern void view_los_note(int y, int x);
+extern void view_los_wipe(void);
+extern int  view_verify(void);
 extern void update_mon_lite(void);
 extern void clear_mon_lite(void);
 extern void delayed_visual_update(void);
 extern void forget_flow(void);
 extern void update_flow(void);
+extern int  flow_verify(void);
+extern void flow_cache_wipe(void);
+extern void flow_cache_note(int y, int x);
+extern int  flow_cache_verify(void);
+extern bool flow_step(int gy, int gx, int y, int x, int *ny, int *nx);
+extern int  flow_distance(int gy, int gx, int y, int x);
 extern int  current_flow_depth;
+extern u32b los_memo_hits;
+extern u32b los_memo_misses;
+extern u32b map_redraw_grids;
+extern u32b map_redraw_frames;
+extern u32b map_redraw_full;
+extern u32b map_redraw_merged;
 extern void update_smell(void);
 extern void map_area(int range);
 extern void wiz_lite(bool ninja);
 extern void wiz_dark(void);
 extern void cave_set_feat(int y, int x, int feat);
+extern void cave_set_m_idx(int y, int x, int m_idx);
+extern void cave_set_o_idx(int y, int x, int o_idx);
+extern void spatial_rebuild(void);
+extern int spatial_verify(void);
+extern int mon_in_rect(int y1, int x1, int y2, int x2, s16b *who);
+extern int mon_in_radius(int y, int x, int r, s16b *who);
+extern int obj_in_radius(int y, int x, int r, s16b *what);
 extern int conv_dungeon_feat(int newfeat);
 extern int feat_state(int feat, int action);
 extern void cave_alter_feat(int y, int x, int action);
@@ -900,6 +941,9 @@ extern void enter_level(int level);
 extern s32b turn_real(s32b hoge);
 extern void prevent_turn_overflow(void);
 extern void process_world_aux_movement(void);  /* yuk!  refactor the recall code instead */
+#ifdef USE_TEST
+extern clock_t sim_clock[3];
+#endif
 extern void fame_on_failure(void);
 extern void recharged_notice(object_type *o_ptr);
 extern byte value_check_aux1(object_type *o_ptr); /* pseudo-id */
@@ -974,8 +1018,11 @@ extern void stair_creation(bool down_only);
 extern int enter_quest;
 extern bool place_quest_monsters(void);
 extern void wipe_generate_cave_flags(void);
+extern void clear_cave_lists(void);
 extern void clear_cave(void);
-extern void generate_cave(void);
+extern gen_ctx_type *gen_ctx_alloc(void);
+extern void gen_ctx_swap(gen_ctx_type *ctx);
+extern void generate_cave(gen_ctx_type *ctx);
 
 /* init1.c */
 extern byte color_char_to_attr(char c);
@@ -984,6 +1031,7 @@ extern void drop_here(object_type *j_ptr, int y, int x);
 extern errr process_dungeon_file(cptr name, int options); /* XXX */
 typedef errr (*parser_f)(char *line, int options);
 extern errr parse_edit_file(cptr name, parser_f f, int options);
+extern void parse_edit_file_flush(void);
 extern errr init_v_info(int options);
 extern int parse_lookup_monster(cptr name, int options);
 extern int parse_lookup_artifact(cptr name, int options);
@@ -1014,6 +1062,10 @@ extern bool retaliation_hack;
 extern int retaliation_count;
 extern bool make_attack_normal(int m_idx);
 extern void process_monsters(void);
+extern void mon_sched_wake(int m_idx);
+extern void mon_sched_update(int m_idx);
+extern void mon_sched_wipe(void);
+extern int mon_sched_verify(void);
 extern int get_mproc_idx(int m_idx, int mproc_type);
 extern void mproc_init(void);
 extern bool set_monster_csleep(int m_idx, int v);
@@ -1069,6 +1121,11 @@ extern void set_friendly(monster_type *m_ptr);
 extern void set_pet(monster_type *m_ptr);
 extern void set_hostile(monster_type *m_ptr);
 extern void anger_monster(monster_type *m_ptr);
+extern u32b mon_move_hits;
+extern u32b mon_move_misses;
+extern void mon_move_init(void);
+extern void mon_move_update(monster_race *r_ptr);
+extern int mon_move_verify(void);
 extern bool monster_can_cross_terrain(s16b feat, monster_race *r_ptr, u16b mode);
 extern bool monster_can_enter(int y, int x, monster_race *r_ptr, u16b mode);
 extern bool are_enemies(monster_type *m_ptr1, monster_type *m_ptr2);
@@ -1107,7 +1164,11 @@ extern bool mon_has_summon_spell(int m_idx);
 extern monster_type *mon_get_parent(monster_type *m_ptr);
 extern void mon_set_parent(monster_type *m_ptr, int pm_idx);
 extern s16b m_pop(void);
+extern int mon_live_next(int m_idx);
+extern int mon_live_prev(int m_idx);
+extern int mon_live_verify(void);
 extern errr get_mon_num_prep(monster_hook_type monster_hook, monster_hook_type monster_hook2);
+extern int mon_alloc_verify(void);
 extern s16b get_mon_num(int level);
 extern void monster_desc(char *desc, monster_type *m_ptr, int mode);
 extern int lore_do_probe(int r_idx);
@@ -1218,6 +1279,7 @@ extern void wipe_o_list(void);
 extern s16b o_pop(void);
 extern s16b get_obj_num(int level);
 extern errr get_obj_num_prep(void);
+extern int obj_alloc_verify(void);
 extern bool object_is_aware(object_type *o_ptr);
 extern void object_aware(object_type *o_ptr);
 extern void object_tried(object_type *o_ptr);
@@ -1301,6 +1363,7 @@ extern void stop_mouth(void);
 
 /* save.c */
 extern bool save_player(void);
+extern bool save_player_async(void);
 extern bool load_player(void);
 extern void remove_loc(void);
 extern bool save_floor(saved_floor_type *sf_ptr, u32b mode);
@@ -1553,10 +1616,13 @@ extern void text_to_ascii(char *buf, cptr str);
 extern void ascii_to_text(char *buf, cptr str);
 extern errr macro_add(cptr pat, cptr act);
 extern sint macro_find_exact(cptr pat);
+extern u32b macro_replay(cptr keys, bool scan);
 extern char inkey(void);
 extern cptr quark_str(s16b num);
 extern void quark_init(void);
 extern s16b quark_add(cptr str);
+extern int quark_collect(void);
+extern int quark_verify(void);
 
 extern void screen_save(void);
 extern void screen_save_aux(void);
@@ -2065,6 +2131,9 @@ extern vec_ptr stats_rand_arts(void);
 extern void stats_add_rand_art(object_type *o_ptr);
 extern vec_ptr stats_egos(void);
 extern void stats_add_ego(object_type *o_ptr);
+extern void stats_for_each_obj(obj_f f);
+extern int wiz_batch_stats(FILE *fff, int which_dungeon, int min_depth, int max_depth, int reps, int workers);
+extern bool wiz_bench(FILE *fff, cptr name, int reps);
 
 /* wiz_obj.c */
 extern void wiz_obj_create(void);
@@ -2314,6 +2383,7 @@ extern bool magic_eater_can_regen(void);
 extern int  magic_eater_regen_amt(int tval);
 extern bool magic_eater_auto_id(object_type *o_ptr);
 extern bool magic_eater_auto_detect_traps(void);
+extern void magic_eater_for_each_obj(obj_f f);
 
 extern void magic_eater_browse(void);
 extern void magic_eater_cast(int tval);
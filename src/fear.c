@@ -157,7 +157,7 @@ int fear_threat_level(void)
     int ml = 0;
     int i;
 
-    for (i = 1; i < m_max; i++)
+    for_each_live_mon(i)
     {
         monster_type *m_ptr = &m_list[i];
         monster_race *r_ptr = &r_info[m_ptr->r_idx];
@@ -318,7 +318,7 @@ void fear_recover_p(void)
 void fear_process_p(void)
 {
     int i, r_level;
-    for (i = 1; i < m_max; i++)
+    for_each_live_mon(i)
     {
         monster_type *m_ptr = &m_list[i];
         monster_race *r_ptr;
@@ -2925,7 +2925,7 @@ void do_cmd_save_game(int is_autosave)
     signals_ignore_tstp();
 
     /* Save the player */
-    if (save_player())
+    if (is_autosave ? save_player_async() : save_player())
     {
         if (!is_autosave)
             prt("Saving game... done.", 0, 0);
@@ -3535,16 +3535,50 @@ void exit_game_panic(void)
 
 
 /*
- * Get a random line from a file
- * Based on the monster speech patch by Matt Graham,
+ * The files read by get_rnd_line() are loaded once and indexed: monster
+ * speech is looked up on monster turns, and shouldn't mean reading the
+ * file again each time. A file is a list of "N:" headers, each followed
+ * by the lines to choose from, up to an empty line (a header's lines run
+ * on past any further headers, which share them). N:<num> is for that
+ * entry, N:M and N:F for male and female monsters, and N:* for anything;
+ * the first header which applies is the one used.
  */
-errr get_rnd_line(cptr file_name, int entry, char *output)
+typedef struct {
+    int line;   /* Line number of the header (0 if none) */
+    int first;  /* Its lines in _rnd_file_t.lines */
+    int count;
+} _rnd_section_t, *_rnd_section_ptr;
+
+typedef struct {
+    vec_ptr        lines;
+    int_map_ptr    entries;  /* N:<num> sections, by number */
+    _rnd_section_t any;
+    _rnd_section_t male;
+    _rnd_section_t female;
+    int            error;    /* Line number of the first bad header (0 if none) */
+} _rnd_file_t, *_rnd_file_ptr;
+
+static str_map_ptr _rnd_files = NULL;
+
+static void _rnd_file_free(_rnd_file_ptr file)
 {
-    FILE    *fp;
-    char    buf[1024];
-    int     counter, test;
-    int     line_num = 0;
+    vec_free(file->lines);
+    int_map_free(file->entries);
+    free(file);
+}
+
+static _rnd_file_ptr _rnd_file(cptr file_name)
+{
+    _rnd_file_ptr file;
+    vec_ptr       open;
+    FILE         *fp;
+    char          buf[1024];
+    int           i, test, line_num = 0;
 
+    if (!_rnd_files) _rnd_files = str_map_alloc((str_map_free_f)_rnd_file_free);
+
+    file = str_map_find(_rnd_files, file_name);
+    if (file) return file;
 
     /* Build the filename */
     path_build(buf, sizeof(buf), ANGBAND_DIR_FILE, file_name);
@@ -3553,90 +3587,129 @@ errr get_rnd_line(cptr file_name, int entry, char *output)
     fp = my_fopen(buf, "r");
 
     /* Failed */
-    if (!fp) return -1;
+    if (!fp) return NULL;
+
+    file = malloc(sizeof(_rnd_file_t));
+    memset(file, 0, sizeof(_rnd_file_t));
+    file->lines = vec_alloc((vec_free_f)string_free);
+    file->entries = int_map_alloc(free);
+
+    /* Sections still collecting lines */
+    open = vec_alloc(NULL);
 
-    /* Find the entry of the monster */
     while (TRUE)
     {
-        /* Get a line from the file */
-        if (my_fgets(fp, buf, sizeof(buf)) == 0)
-        {
-            /* Count the lines */
-            line_num++;
+        _rnd_section_ptr section = NULL;
+        bool             done = my_fgets(fp, buf, sizeof(buf)) != 0;
 
-            /* Look for lines starting with 'N:' */
-            if ((buf[0] == 'N') && (buf[1] == ':'))
+        /* An empty line (or the end of the file) ends the sections */
+        if (done || !buf[0])
+        {
+            for (i = 0; i < vec_length(open); i++)
             {
-                /* Allow default lines */
-                if (buf[2] == '*')
-                {
-                    /* Default lines */
-                    break;
-                }
-                else if (buf[2] == 'M')
-                {
-                    if (r_info[entry].flags1 & RF1_MALE) break;
-                }
-                else if (buf[2] == 'F')
-                {
-                    if (r_info[entry].flags1 & RF1_FEMALE) break;
-                }
-                /* Get the monster number */
-                else if (sscanf(&(buf[2]), "%d", &test) != EOF)
-                {
-                    /* Is it the right number? */
-                    if (test == entry) break;
-                }
-                else
-                {
-                    /* Error while converting the number */
-                    msg_format("Error in line %d of %s!", line_num, file_name);
-                    my_fclose(fp);
-                    return -1;
-                }
+                section = vec_get(open, i);
+                section->count = vec_length(file->lines) - section->first;
             }
+            vec_clear(open);
+            if (done) break;
         }
-        else
+
+        /* Count the lines */
+        line_num++;
+
+        if (!buf[0]) continue;
+        if (buf[0] == '#') continue;
+        if (buf[0] != 'N' || buf[1] != ':')
         {
-            /* Reached end of file */
-            my_fclose(fp);
-            return -1;
+            vec_add(file->lines, string_copy_s(buf));
+            continue;
         }
-    }
 
-    /* Get the random line */
-    for (counter = 0; ; counter++)
-    {
-        while (TRUE)
+        /* Only the first header for anything is ever used */
+        if (buf[2] == '*')
         {
-            test = my_fgets(fp, buf, sizeof(buf));
-
-            /* Count the lines */
-            /* line_num++; No more needed */
-
-            if (!test)
+            if (!file->any.line) section = &file->any;
+        }
+        else if (buf[2] == 'M')
+        {
+            if (!file->male.line) section = &file->male;
+        }
+        else if (buf[2] == 'F')
+        {
+            if (!file->female.line) section = &file->female;
+        }
+        else if (sscanf(&(buf[2]), "%d", &test) != EOF)
+        {
+            if (!int_map_contains(file->entries, test))
             {
-                /* Ignore lines starting with 'N:' */
-                if ((buf[0] == 'N') && (buf[1] == ':')) continue;
-
-                if (buf[0] != '#') break;
+                section = malloc(sizeof(_rnd_section_t));
+                int_map_add(file->entries, test, section);
             }
-            else break;
+        }
+        else if (!file->error)
+        {
+            file->error = line_num;
         }
 
-        /* Abort */
-        if (!buf[0]) break;
-
-        /* Copy the line */
-        if (one_in_(counter + 1))
-            strcpy(output, buf);
+        if (section)
+        {
+            section->line = line_num;
+            section->first = vec_length(file->lines);
+            section->count = 0;
+            vec_add(open, section);
+        }
     }
+    vec_free(open);
 
     /* Close the file */
     my_fclose(fp);
 
+    str_map_add(_rnd_files, file_name, file);
+    return file;
+}
+
+static _rnd_section_ptr _rnd_earlier(_rnd_section_ptr best, _rnd_section_ptr section)
+{
+    if (!section || !section->line) return best;
+    if (best && best->line < section->line) return best;
+    return section;
+}
+
+/*
+ * Get a random line from a file
+ * Based on the monster speech patch by Matt Graham,
+ */
+errr get_rnd_line(cptr file_name, int entry, char *output)
+{
+    _rnd_file_ptr    file = _rnd_file(file_name);
+    _rnd_section_ptr best = NULL;
+
+    /* Failed */
+    if (!file) return -1;
+
+    /* Find the entry of the monster */
+    best = _rnd_earlier(best, int_map_find(file->entries, entry));
+    best = _rnd_earlier(best, &file->any);
+    if (file->male.line && (r_info[entry].flags1 & RF1_MALE))
+        best = _rnd_earlier(best, &file->male);
+    if (file->female.line && (r_info[entry].flags1 & RF1_FEMALE))
+        best = _rnd_earlier(best, &file->female);
+
+    if (file->error && (!best || file->error < best->line))
+    {
+        /* Error while converting the number */
+        msg_format("Error in line %d of %s!", file->error, file_name);
+        return -1;
+    }
+
+    /* Not found, or nothing to say */
+    if (!best || !best->count) return -1;
+
+    /* Get the random line */
+    strcpy(output, string_buffer(vec_get(file->lines, best->first + randint0(best->count))));
+
     /* Success */
-    return counter ? 0 : -1;
+    return 0;
 }
 
 
@@ -72,6 +72,9 @@ void init_saved_floors(bool force)
             (void)fd_close(fd);
         }
 
+        /* Let a write of it in progress land first */
+        savefile_wait(floor_savefile);
+
         /* Grab permissions */
         safe_setuid_grab();
 
@@ -135,6 +138,9 @@ void clear_saved_floor_files(void)
         /* File name */
         sprintf(floor_savefile, "%s.F%02d", savefile, i);
 
+        /* Let a write of it in progress land first */
+        savefile_wait(floor_savefile);
+
         /* Grab permissions */
         safe_setuid_grab();
 
@@ -201,6 +207,9 @@ static void kill_saved_floor(saved_floor_type *sf_ptr)
         /* File name */
         sprintf(floor_savefile, "%s.F%02d", savefile, (int)sf_ptr->savefile_id);
 
+        /* Let a write of it in progress land first */
+        savefile_wait(floor_savefile);
+
         /* Grab permissions */
         safe_setuid_grab();
 
@@ -331,6 +340,38 @@ static void build_dead_end(void)
 }
 
 
+/*
+ * The level context new floors are built in (see generate_cave()). After
+ * the swap it holds the floor just left, until the next floor is built
+ * over it.
+ */
+static gen_ctx_type *_floor_ctx = NULL;
+
+/*
+ * Build a new floor for dungeon_type and dun_level and make it current
+ */
+static void generate_floor(void)
+{
+    if (!_floor_ctx) _floor_ctx = gen_ctx_alloc();
+
+    /* Let go of the monsters and objects of the floor we are leaving,
+       so its uniques may turn up on the new one */
+    clear_cave_lists();
+
+    /* Build it for where the player is going, drawing on the game's
+       level generation stream */
+    _floor_ctx->dungeon_type = dungeon_type;
+    _floor_ctx->dun_level = dun_level;
+    _floor_ctx->rand = Rand_state[RAND_STREAM_GEN];
+
+    hack_mind = FALSE;
+    generate_cave(_floor_ctx);
+    hack_mind = TRUE;
+
+    gen_ctx_swap(_floor_ctx);
+}
+
+
 /* Maximum number of preservable pets */
 #define MAX_PARTY_MON 21
 
@@ -559,7 +600,7 @@ static void place_pet(void)
             monster_type *m_ptr = &m_list[m_idx];
             monster_race *r_ptr;
 
-            cave[cy][cx].m_idx = m_idx;
+            cave_set_m_idx(cy, cx, m_idx);
 
             m_ptr->r_idx = party_mon[i].r_idx;
 
@@ -643,7 +684,7 @@ static void update_unique_artifact(s16b cur_floor_id)
     int i;
 
     /* Maintain unique monsters */
-    for (i = 1; i < m_max; i++)
+    for_each_live_mon(i)
     {
         monster_race *r_ptr;
         monster_type *m_ptr = &m_list[i];
@@ -736,10 +777,10 @@ static void get_out_monster(void)
         m_ptr = &m_list[m_idx];
 
         /* Update the old location */
-        cave[oy][ox].m_idx = 0;
+        cave_set_m_idx(oy, ox, 0);
 
         /* Update the new location */
-        cave[ny][nx].m_idx = m_idx;
+        cave_set_m_idx(ny, nx, m_idx);
 
         /* Move the monster */
         m_ptr->fy = ny;
@@ -1086,9 +1127,7 @@ void change_floor(void)
         !(change_floor_mode & CFM_FIRST_FLOOR))
     {
         /* Create cave */
-        hack_mind = FALSE;
-        generate_cave();
-        hack_mind = TRUE;
+        generate_floor();
 
         /* Paranoia -- No new saved floor */
         new_floor_id = 0;
@@ -1181,7 +1220,7 @@ void change_floor(void)
             absence_ticks = (game_turn - tmp_last_visit) / TURNS_PER_TICK;
 
             /* Maintain monsters */
-            for (i = 1; i < m_max; i++)
+            for_each_live_mon(i)
             {
                 monster_race *r_ptr;
                 monster_type *m_ptr = &m_list[i];
@@ -1288,9 +1327,7 @@ void change_floor(void)
             else
             {
                 /* Newly create cave */
-                hack_mind = FALSE;
-                generate_cave();
-                hack_mind = TRUE;
+                generate_floor();
             }
 
             /* Record last visit turn */
@@ -1383,6 +1420,9 @@ void change_floor(void)
 
     /* Clear all flags */
     change_floor_mode = 0L;
+
+    /* Free the inscriptions and names left behind */
+    quark_collect();
 }
 
 
@@ -260,8 +260,8 @@ static void _shock_power_spell(int cmd, variant *res)
                 {
                     msg_format("You blow %s away!", m_name);
 
-                    cave[oy][ox].m_idx = 0;
-                    cave[ty][tx].m_idx = m_idx;
+                    cave_set_m_idx(oy, ox, 0);
+                    cave_set_m_idx(ty, tx, m_idx);
                     m_ptr->fy = ty;
                     m_ptr->fx = tx;
 
@@ -1300,7 +1300,7 @@ static void battle_gen(void)
                   (PM_NO_KAGE | PM_NO_PET));
         set_friendly(&m_list[cave[py+8+(i/2)*4][px-2+(i%2)*4].m_idx]);
     }
-    for(i = 1; i < m_max; i++)
+    for_each_live_mon(i)
     {
         monster_type *m_ptr = &m_list[i];
 
@@ -1403,16 +1403,15 @@ void wipe_generate_cave_flags(void)
 
 
 /*
- *  Clear and empty the cave
+ *  Empty the monster and object lists of the cave
  */
-void clear_cave(void)
+void clear_cave_lists(void)
 {
-    int x, y;
-
     /* Very simplified version of wipe_o_list() */
     C_WIPE(o_list, o_max, object_type);
     o_max = 1;
     o_cnt = 0;
+    o_free_list = 0;
     unique_count = 0;
 
     /* Note, when I replaced the above with wipe_o_list(), artifacts started spawning
@@ -1420,6 +1419,16 @@ void clear_cave(void)
       wipe_o_list();*/
 
     wipe_m_list();
+}
+
+/*
+ *  Clear and empty the cave
+ */
+void clear_cave(void)
+{
+    int x, y;
+
+    clear_cave_lists();
 
     /* Pre-calc cur_num of pets in party_mon[] */
     precalc_cur_num_of_pet();
@@ -1455,6 +1464,11 @@ void clear_cave(void)
             c_ptr->when = 0;
         }
     }
+    C_WIPE(spatial_mon, SPATIAL_HGT * SPATIAL_WID, byte);
+    C_WIPE(spatial_obj, SPATIAL_HGT * SPATIAL_WID, byte);
+
+    flow_cache_wipe();
+    view_los_wipe();
 
     /* Mega-Hack -- no player yet */
     px = py = 0;
@@ -1475,7 +1489,7 @@ void clear_cave(void)
  *
  * Hack -- regenerate any "overflow" levels
  */
-void generate_cave(void)
+static void generate_cave_aux(void)
 {
     int num;
 
@@ -1552,8 +1566,28 @@ void generate_cave(void)
         wipe_m_list();
     }
     glow_deep_lava_and_bldg();
-    p_ptr->enter_dungeon = FALSE;
     wipe_generate_cave_flags();
+}
+
+/*
+ * Build a level for ctx->dungeon_type and ctx->dun_level into the context,
+ * drawing on its random stream. The current level is left alone: swap the
+ * context in with gen_ctx_swap() to use the new one. Whatever else level
+ * generation touches (the monster and artifact counts, the object
+ * statistics, the quests and so on) is shared with the game as before.
+ */
+void generate_cave(gen_ctx_type *ctx)
+{
+    int stream;
+
+    gen_ctx_swap(ctx);
+    stream = Rand_stream_set(RAND_STREAM_GEN);
+
+    generate_cave_aux();
+
+    Rand_stream_set(stream);
+    gen_ctx_swap(ctx);
+    p_ptr->enter_dungeon = FALSE;
 
 #if 0
     wiz_lite(FALSE);
@@ -1611,3 +1645,84 @@ void generate_cave(void)
     }
 #endif
 }
+
+
+/*
+ * Level generation contexts
+ */
+gen_ctx_type *gen_ctx_alloc(void)
+{
+    gen_ctx_type *ctx;
+    int i;
+
+    MAKE(ctx, gen_ctx_type);
+
+    for (i = 0; i < MAX_HGT; i++) C_MAKE(ctx->cave[i], MAX_WID, cave_type);
+    C_MAKE(ctx->spatial_mon, SPATIAL_HGT * SPATIAL_WID, byte);
+    C_MAKE(ctx->spatial_obj, SPATIAL_HGT * SPATIAL_WID, byte);
+
+    C_MAKE(ctx->m_list, max_m_idx, monster_type);
+    for (i = 0; i < MAX_MTIMED; i++) C_MAKE(ctx->mproc_list[i], max_m_idx, s16b);
+    C_MAKE(ctx->m_idle, (max_m_idx + 31) / 32, u32b);
+    C_MAKE(ctx->m_live, (max_m_idx + 31) / 32, u32b);
+    C_MAKE(ctx->pack_info_list, max_pack_info_idx, pack_info_t);
+    C_MAKE(ctx->o_list, max_o_idx, object_type);
+
+    ctx->m_max = 1;
+    ctx->o_max = 1;
+    ctx->pack_info_free_list = 1;
+    for (i = 1; i < max_pack_info_idx - 1; i++)
+        ctx->pack_info_list[i].next_idx = i + 1;
+
+    return ctx;
+}
+
+#define GEN_CTX_SWAP(T, A, B) { T _tmp = (A); (A) = (B); (B) = _tmp; }
+
+/*
+ * Exchange the level in the context with the current one. Only pointers
+ * and counters move, so this is cheap. The cached view, projection and
+ * flow information belong to the old level, so they are dropped.
+ */
+void gen_ctx_swap(gen_ctx_type *ctx)
+{
+    int i;
+
+    for (i = 0; i < MAX_HGT; i++) GEN_CTX_SWAP(cave_type *, cave[i], ctx->cave[i]);
+    GEN_CTX_SWAP(s16b, cur_hgt, ctx->cur_hgt);
+    GEN_CTX_SWAP(s16b, cur_wid, ctx->cur_wid);
+    GEN_CTX_SWAP(s16b, py, ctx->py);
+    GEN_CTX_SWAP(s16b, px, ctx->px);
+    GEN_CTX_SWAP(byte *, spatial_mon, ctx->spatial_mon);
+    GEN_CTX_SWAP(byte *, spatial_obj, ctx->spatial_obj);
+
+    GEN_CTX_SWAP(monster_type *, m_list, ctx->m_list);
+    GEN_CTX_SWAP(s16b, m_max, ctx->m_max);
+    GEN_CTX_SWAP(s16b, m_cnt, ctx->m_cnt);
+    GEN_CTX_SWAP(s16b, m_free_list, ctx->m_free_list);
+    for (i = 0; i < MAX_MTIMED; i++)
+    {
+        GEN_CTX_SWAP(s16b *, mproc_list[i], ctx->mproc_list[i]);
+        GEN_CTX_SWAP(s16b, mproc_max[i], ctx->mproc_max[i]);
+    }
+    GEN_CTX_SWAP(u32b *, m_idle, ctx->m_idle);
+    GEN_CTX_SWAP(u32b *, m_live, ctx->m_live);
+    GEN_CTX_SWAP(s16b, num_repro, ctx->num_repro);
+    GEN_CTX_SWAP(s16b, num_repro_kill, ctx->num_repro_kill);
+    GEN_CTX_SWAP(s16b, unique_count, ctx->unique_count);
+    GEN_CTX_SWAP(pack_info_t *, pack_info_list, ctx->pack_info_list);
+    GEN_CTX_SWAP(s16b, pack_info_free_list, ctx->pack_info_free_list);
+    GEN_CTX_SWAP(s16b, pack_info_count, ctx->pack_info_count);
+
+    GEN_CTX_SWAP(object_type *, o_list, ctx->o_list);
+    GEN_CTX_SWAP(s16b, o_max, ctx->o_max);
+    GEN_CTX_SWAP(s16b, o_cnt, ctx->o_cnt);
+    GEN_CTX_SWAP(s16b, o_free_list, ctx->o_free_list);
+
+    GEN_CTX_SWAP(byte, dungeon_type, ctx->dungeon_type);
+    GEN_CTX_SWAP(s16b, dun_level, ctx->dun_level);
+    GEN_CTX_SWAP(rand_stream_t, Rand_state[RAND_STREAM_GEN], ctx->rand);
+
+    flow_cache_wipe();
+    view_los_wipe();
+}
@@ -2156,7 +2156,11 @@ static errr parse_v_info(char *buf, int options)
 
 errr init_v_info(int options)
 {
-    if (room_info) vec_free(room_info); /* double initialization?? */
+    if (room_info) /* double initialization?? */
+    {
+        vec_free(room_info);
+        parse_edit_file_flush();
+    }
     room_info = vec_alloc((vec_free_f)room_free);
     return parse_edit_file("v_info.txt", parse_v_info, options);
 }
@@ -4514,7 +4518,7 @@ void drop_here(object_type *j_ptr, int y, int x)
     o_ptr->next_o_idx = c_ptr->o_idx;
 
     /* Place the object */
-    c_ptr->o_idx = o_idx;
+    cave_set_o_idx(y, x, o_idx);
 
     p_ptr->window |= PW_OBJECT_LIST;
 }
@@ -4690,11 +4694,150 @@ static char tmp[255];
 static cptr variant_name = "POSCHENGBAND";
 
 /*
- * Helper function for "process_dungeon_file()"
+ * Compiled "?:<expr>" conditionals.
+ *
+ * Edit files are read once (see _edit_file below) and each conditional is
+ * parsed into a small tree at that time. Evaluating the tree walks the
+ * arguments in the same order as the old string evaluator did, and the
+ * variables still share the static tmp[] buffer, so that expressions like
+ * [EQU $TOWN $LEVEL] behave exactly as before. Function names are resolved
+ * when compiled, so a variable in function position (e.g. [$RACE 1]) is
+ * treated as an unknown function.
  */
-static cptr process_dungeon_file_expr(char **sp, char *fp)
+enum {
+    _EXPR_CONST,
+    _EXPR_VAR,
+    _EXPR_OR,
+    _EXPR_AND,
+    _EXPR_NOT,
+    _EXPR_EQU,
+    _EXPR_MOD,
+    _EXPR_LEQ,
+    _EXPR_GEQ,
+    _EXPR_UNKNOWN,
+};
+
+enum {
+    _VAR_NONE,
+    _VAR_SYS,
+    _VAR_GRAF,
+    _VAR_MONOCHROME,
+    _VAR_RACE,
+    _VAR_SUBRACE,
+    _VAR_CLASS,
+    _VAR_SUBCLASS,
+    _VAR_REALM1,
+    _VAR_REALM2,
+    _VAR_PLAYER,
+    _VAR_TOWN,
+    _VAR_LEVEL,
+    _VAR_QUEST,
+    _VAR_RANDOM,
+    _VAR_VARIANT,
+    _VAR_WILDERNESS,
+    _VAR_SPECIALITY,
+};
+
+typedef struct _expr_s _expr_t, *_expr_ptr;
+struct _expr_s
 {
-    cptr v;
+    byte      op;
+    byte      var;   /* _EXPR_VAR */
+    int       arg;   /* $QUESTn and $RANDOMn */
+    cptr      text;  /* _EXPR_CONST */
+    _expr_ptr args;
+    _expr_ptr next;
+};
+
+static _expr_ptr _expr_alloc(byte op, cptr text)
+{
+    _expr_ptr e;
+
+    MAKE(e, _expr_t);
+    e->op = op;
+    e->text = text;
+    return e;
+}
+
+static void _expr_free(_expr_ptr e)
+{
+    while (e)
+    {
+        _expr_ptr next = e->next;
+        _expr_free(e->args);
+        if (e->op == _EXPR_CONST) z_string_free(e->text);
+        KILL(e, _expr_t);
+        e = next;
+    }
+}
+
+static byte _expr_func(cptr name)
+{
+    if (streq(name, "IOR") || streq(name, "OR")) return _EXPR_OR;
+    if (streq(name, "AND")) return _EXPR_AND;
+    if (streq(name, "NOT")) return _EXPR_NOT;
+    if (streq(name, "EQU")) return _EXPR_EQU;
+    if (streq(name, "MOD")) return _EXPR_MOD;
+    if (streq(name, "LEQ")) return _EXPR_LEQ;
+    if (streq(name, "GEQ")) return _EXPR_GEQ;
+    return _EXPR_UNKNOWN;
+}
+
+static _expr_ptr _expr_var(cptr name)
+{
+    _expr_ptr e = _expr_alloc(_EXPR_VAR, NULL);
+
+    if (streq(name, "SYS")) e->var = _VAR_SYS;
+    else if (streq(name, "GRAF")) e->var = _VAR_GRAF;
+    else if (streq(name, "MONOCHROME")) e->var = _VAR_MONOCHROME;
+    else if (streq(name, "RACE")) e->var = _VAR_RACE;
+    else if (streq(name, "SUBRACE")) e->var = _VAR_SUBRACE;
+    else if (streq(name, "CLASS")) e->var = _VAR_CLASS;
+    else if (streq(name, "SUBCLASS")) e->var = _VAR_SUBCLASS;
+    else if (streq(name, "REALM1")) e->var = _VAR_REALM1;
+    else if (streq(name, "REALM2")) e->var = _VAR_REALM2;
+    else if (streq(name, "PLAYER")) e->var = _VAR_PLAYER;
+    else if (streq(name, "TOWN")) e->var = _VAR_TOWN;
+    else if (streq(name, "LEVEL")) e->var = _VAR_LEVEL;
+    else if (prefix(name, "QUEST"))
+    {
+        e->var = _VAR_QUEST;
+        e->arg = atoi(name + 5);
+    }
+    /* Random
+       OLD: $RANDOM7 evaluated as seed_town % 7
+       NEW: [MOD $RANDOM37 7] where 37 refers to the seed
+       for quest 37. Every quest gets assigned a new seed
+       when it is accepted in bldg.c.
+    */
+    else if (prefix(name, "RANDOM"))
+    {
+        e->var = _VAR_RANDOM;
+        e->arg = atoi(name + 6);
+    }
+    else if (streq(name, "VARIANT")) e->var = _VAR_VARIANT;
+    else if (streq(name, "WILDERNESS")) e->var = _VAR_WILDERNESS;
+    else if (streq(name, "SPECIALITY")) e->var = _VAR_SPECIALITY;
+    else e->var = _VAR_NONE;
+
+    return e;
+}
+
+/* Append the next argument to a function node */
+static _expr_ptr *_expr_push(_expr_ptr *tail, _expr_ptr arg)
+{
+    *tail = arg;
+    return &arg->next;
+}
+
+/*
+ * Parse one term of a conditional, mirroring the old evaluator's
+ * scanning so that malformed expressions still yield the same
+ * "?o?o?" and "?x?x?" results.
+ */
+static _expr_ptr _expr_compile(char **sp, char *fp)
+{
+    _expr_ptr e;
 
     char *b;
     char *s;
@@ -4713,346 +4856,349 @@ static cptr process_dungeon_file_expr(char **sp, char *fp)
     /* Save start */
     b = s;
 
-    /* Default */
-    v = "?o?o?";
-
     /* Analyze */
     if (*s == b1)
     {
-        const char *p;
-        const char *t;
+        _expr_ptr  head;
+        _expr_ptr *tail;
 
         /* Skip b1 */
         s++;
 
         /* First */
-        t = process_dungeon_file_expr(&s, &f);
+        head = _expr_compile(&s, &f);
 
-        /* Oops */
-        if (!*t)
+        /* Oops: An empty function does not consume any arguments */
+        if (head->op == _EXPR_CONST && !*head->text)
+            e = _expr_alloc(_EXPR_CONST, z_string_make("?o?o?"));
+        else
         {
-            /* Nothing */
-        }
+            e = _expr_alloc(head->op == _EXPR_CONST ? _expr_func(head->text) : _EXPR_UNKNOWN, NULL);
+            tail = &e->args;
 
-        /* Function: IOR */
-        else if (streq(t, "IOR") || streq(t, "OR"))
-        {
-            v = "0";
-            while (*s && (f != b2))
+            switch (e->op)
             {
-                t = process_dungeon_file_expr(&s, &f);
-                if (*t && !streq(t, "0")) v = "1";
+            case _EXPR_MOD:
+                if (*s && (f != b2))
+                    tail = _expr_push(tail, _expr_compile(&s, &f));
+                if (*s && (f != b2))
+                    tail = _expr_push(tail, _expr_compile(&s, &f));
+                break;
+            default:
+                while (*s && (f != b2))
+                    tail = _expr_push(tail, _expr_compile(&s, &f));
             }
         }
+        _expr_free(head);
 
-        /* Function: AND */
-        else if (streq(t, "AND"))
+        /* Verify ending */
+        if (f != b2)
         {
-            v = "1";
-            while (*s && (f != b2))
-            {
-                t = process_dungeon_file_expr(&s, &f);
-                if (*t && streq(t, "0")) v = "0";
-            }
+            _expr_free(e);
+            e = _expr_alloc(_EXPR_CONST, z_string_make("?x?x?"));
         }
 
-        /* Function: NOT */
-        else if (streq(t, "NOT"))
+        /* Extract final and Terminate */
+        if ((f = *s) != '\0') *s++ = '\0';
+    }
+
+    /* Other */
+    else
+    {
+        /* Accept all printables except spaces and brackets */
+        while (isprint(*s) && !my_strchr(" []", *s)) ++s;
+
+        /* Extract final and Terminate */
+        if ((f = *s) != '\0') *s++ = '\0';
+
+        /* Variable */
+        if (*b == '$')
+            e = _expr_var(b + 1);
+
+        /* Constant */
+        else
+            e = _expr_alloc(_EXPR_CONST, z_string_make(b));
+    }
+
+    /* Save */
+    (*fp) = f;
+
+    /* Save */
+    (*sp) = s;
+
+    /* Result */
+    return (e);
+}
+
+static cptr _expr_eval_var(_expr_ptr e)
+{
+    switch (e->var)
+    {
+    case _VAR_SYS:
+        return ANGBAND_SYS;
+    case _VAR_GRAF:
+        return ANGBAND_GRAF;
+    case _VAR_MONOCHROME:
+        return arg_monochrome ? "ON" : "OFF";
+    case _VAR_RACE:
+        return get_true_race()->name;
+    case _VAR_SUBRACE:
+        return get_true_race()->subname;
+    case _VAR_CLASS:
+        return get_class()->name;
+    case _VAR_SUBCLASS:
+        return get_class()->subname;
+    case _VAR_REALM1:
+        return realm_names[p_ptr->realm1];
+    case _VAR_REALM2:
+        return realm_names[p_ptr->realm2];
+    case _VAR_PLAYER:
+    {
+        static char tmp_player_name[32];
+        char *pn, *tpn;
+        for (pn = player_name, tpn = tmp_player_name; *pn; pn++, tpn++)
         {
-            v = "1";
-            while (*s && (f != b2))
-            {
-                t = process_dungeon_file_expr(&s, &f);
-                if (*t && streq(t, "1")) v = "0";
-            }
+            *tpn = my_strchr(" []", *pn) ? '_' : *pn;
         }
+        *tpn = '\0';
+        return tmp_player_name;
+    }
+    case _VAR_TOWN:
+        sprintf(tmp, "%d", p_ptr->town_num);
+        return tmp;
+    case _VAR_LEVEL:
+        sprintf(tmp, "%d", p_ptr->lev);
+        return tmp;
+    case _VAR_QUEST:
+    {
+        cptr _status[] = { "Untaken", "Taken", "InProgress", "Completed", "Finished", "Failed", "FailedDone" };
+        quest_ptr q = quests_get(e->arg);
+        if (q) sprintf(tmp, "%s", _status[q->status]);
+        else sprintf(tmp, "Unknown");
+        return tmp;
+    }
+    case _VAR_RANDOM:
+        /* "RANDOM" uses a special parameter to determine the number of the quest */
+        sprintf(tmp, "%d", quests_get(e->arg)->seed);
+        return tmp;
+    case _VAR_VARIANT:
+        return variant_name;
+    case _VAR_WILDERNESS:
+        if (no_wilderness)
+            sprintf(tmp, "NONE");
+        else
+            sprintf(tmp, "NORMAL");
+        return tmp;
+    case _VAR_SPECIALITY:
+        if (p_ptr->pclass == CLASS_WEAPONMASTER)
+            sprintf(tmp, "%s", weaponmaster_speciality_name(p_ptr->psubclass));
+        else if (p_ptr->pclass == CLASS_DEVICEMASTER)
+            sprintf(tmp, "%s", devicemaster_speciality_name(p_ptr->psubclass));
+        else
+            sprintf(tmp, "None");
+        return tmp;
+    }
+    return "?o?o?";
+}
 
-        /* Function: EQU */
-        else if (streq(t, "EQU"))
+static cptr _expr_eval(_expr_ptr e)
+{
+    _expr_ptr a;
+    cptr      v, t, p;
+
+    switch (e->op)
+    {
+    case _EXPR_CONST:
+        return e->text;
+
+    case _EXPR_VAR:
+        return _expr_eval_var(e);
+
+    case _EXPR_OR:
+        v = "0";
+        for (a = e->args; a; a = a->next)
         {
-            v = "0";
-            if (*s && (f != b2))
-            {
-                t = process_dungeon_file_expr(&s, &f);
-            }
-            while (*s && (f != b2))
-            {
-                p = process_dungeon_file_expr(&s, &f);
-                if (streq(t, p)) v = "1";
-            }
+            t = _expr_eval(a);
+            if (*t && !streq(t, "0")) v = "1";
         }
-        /* Function: MOD */
-        else if (streq(t, "MOD"))
+        return v;
+
+    case _EXPR_AND:
+        v = "1";
+        for (a = e->args; a; a = a->next)
         {
-            int x = 0;
-            int y = 0;
-            v = "0";
-            if (*s && (f != b2))
-            {
-                x = atoi(process_dungeon_file_expr(&s, &f));
-            }
-            if(*s && (f != b2))
-            {
-                y = atoi(process_dungeon_file_expr(&s, &f));
-                sprintf(tmp, "%d", x%y);
-                v = tmp;
-            }
+            t = _expr_eval(a);
+            if (*t && streq(t, "0")) v = "0";
         }
+        return v;
 
-        /* Function: LEQ */
-        else if (streq(t, "LEQ"))
+    case _EXPR_NOT:
+        v = "1";
+        for (a = e->args; a; a = a->next)
         {
-            v = "1";
-            if (*s && (f != b2))
-            {
-                t = process_dungeon_file_expr(&s, &f);
-            }
-            while (*s && (f != b2))
-            {
-                p = t;
-                t = process_dungeon_file_expr(&s, &f);
-                if (*t && atoi(p) > atoi(t)) v = "0";
-            }
+            t = _expr_eval(a);
+            if (*t && streq(t, "1")) v = "0";
         }
+        return v;
 
-        /* Function: GEQ */
-        else if (streq(t, "GEQ"))
+    case _EXPR_EQU:
+        v = "0";
+        if (!e->args) return v;
+        t = _expr_eval(e->args);
+        for (a = e->args->next; a; a = a->next)
         {
-            v = "1";
-            if (*s && (f != b2))
-            {
-                t = process_dungeon_file_expr(&s, &f);
-            }
-            while (*s && (f != b2))
-            {
-                p = t;
-                t = process_dungeon_file_expr(&s, &f);
-
-                /* Compare two numbers instead of string */
-                if (*t && atoi(p) < atoi(t)) v = "0";
-            }
+            p = _expr_eval(a);
+            if (streq(t, p)) v = "1";
         }
+        return v;
 
-        /* Oops */
-        else
+    case _EXPR_MOD:
+    {
+        int x = 0, y;
+        if (!e->args) return "0";
+        x = atoi(_expr_eval(e->args));
+        if (!e->args->next) return "0";
+        y = atoi(_expr_eval(e->args->next));
+        sprintf(tmp, "%d", x%y);
+        return tmp;
+    }
+
+    case _EXPR_LEQ:
+    case _EXPR_GEQ:
+        v = "1";
+        if (!e->args) return v;
+        t = _expr_eval(e->args);
+        for (a = e->args->next; a; a = a->next)
         {
-            while (*s && (f != b2))
-            {
-                t = process_dungeon_file_expr(&s, &f);
-            }
-        }
+            p = t;
+            t = _expr_eval(a);
 
-        /* Verify ending */
-        if (f != b2) v = "?x?x?";
+            /* Compare two numbers instead of string */
+            if (e->op == _EXPR_LEQ && *t && atoi(p) > atoi(t)) v = "0";
+            if (e->op == _EXPR_GEQ && *t && atoi(p) < atoi(t)) v = "0";
+        }
+        return v;
 
-        /* Extract final and Terminate */
-        if ((f = *s) != '\0') *s++ = '\0';
+    default:
+        for (a = e->args; a; a = a->next)
+            _expr_eval(a);
+        return "?o?o?";
     }
+}
 
-    /* Other */
-    else
-    {
-        /* Accept all printables except spaces and brackets */
-        while (isprint(*s) && !my_strchr(" []", *s)) ++s;
+/*
+ * Edit files read by parse_edit_file and process_dungeon_file are loaded
+ * once and kept in memory: quest files are consulted for descriptions,
+ * rewards and maps over and over, w_info.txt on every wilderness scroll,
+ * and t_info.txt on every town visit. Comments and blank lines are dropped
+ * when loading, and conditionals are compiled (above). Each remaining line
+ * is copied into a scratch buffer before parsing, since the parsers
+ * tokenize in place.
+ */
+typedef struct {
+    int       num;   /* Line number, for error messages */
+    cptr      text;  /* NULL for a conditional */
+    _expr_ptr expr;
+} _edit_line_t, *_edit_line_ptr;
 
-        /* Extract final and Terminate */
-        if ((f = *s) != '\0') *s++ = '\0';
+static str_map_ptr _edit_files = NULL;
 
-        /* Variable */
-        if (*b == '$')
-        {
-            /* System */
-            if (streq(b+1, "SYS"))
-            {
-                v = ANGBAND_SYS;
-            }
+static void _edit_line_free(_edit_line_ptr line)
+{
+    if (line->text) z_string_free(line->text);
+    _expr_free(line->expr);
+    KILL(line, _edit_line_t);
+}
 
-            /* Graphics */
-            else if (streq(b+1, "GRAF"))
-            {
-                v = ANGBAND_GRAF;
-            }
-            else if (streq(b+1, "MONOCHROME"))
-            {
-                if (arg_monochrome)
-                    v = "ON";
-                else
-                    v = "OFF";
-            }
-            /* Race */
-            else if (streq(b+1, "RACE"))
-            {
-                v = get_true_race()->name;
-            }
-            else if (streq(b+1, "SUBRACE"))
-            {
-                v = get_true_race()->subname;
-            }
-            /* Class */
-            else if (streq(b+1, "CLASS"))
-            {
-                v = get_class()->name;
-            }
-            else if (streq(b+1, "SUBCLASS"))
-            {
-                v = get_class()->subname;
-            }
-            /* Realms */
-            else if (streq(b+1, "REALM1"))
-            {
-                v = realm_names[p_ptr->realm1];
-            }
-            else if (streq(b+1, "REALM2"))
-            {
-                v = realm_names[p_ptr->realm2];
-            }
-            /* Player name */
-            else if (streq(b+1, "PLAYER"))
-            {
-                static char tmp_player_name[32];
-                char *pn, *tpn;
-                for (pn = player_name, tpn = tmp_player_name; *pn; pn++, tpn++)
-                {
-                    *tpn = my_strchr(" []", *pn) ? '_' : *pn;
-                }
-                *tpn = '\0';
-                v = tmp_player_name;
-            }
+/*
+ * Forget every loaded edit file, so that the next use reads it afresh
+ * (for a new character, or after the files were edited)
+ */
+void parse_edit_file_flush(void)
+{
+    if (!_edit_files) return;
+    str_map_free(_edit_files);
+    _edit_files = NULL;
+}
 
-            /* Town */
-            else if (streq(b+1, "TOWN"))
-            {
-                sprintf(tmp, "%d", p_ptr->town_num);
-                v = tmp;
-            }
+static vec_ptr _edit_file(cptr name)
+{
+    vec_ptr lines;
+    FILE   *fp;
+    char    buf[1024];
+    int     num = 0;
 
-            /* Level */
-            else if (streq(b+1, "LEVEL"))
-            {
-                sprintf(tmp, "%d", p_ptr->lev);
-                v = tmp;
-            }
+    if (!_edit_files) _edit_files = str_map_alloc((str_map_free_f)vec_free);
 
-            /* Quest status */
-            else if (prefix(b+1, "QUEST"))
-            {
-                cptr _status[] = { "Untaken", "Taken", "InProgress", "Completed", "Finished", "Failed", "FailedDone" };
-                int  which = atoi(b+6);
-                quest_ptr q = quests_get(which);
-                if (q) sprintf(tmp, "%s", _status[q->status]);
-                else sprintf(tmp, "Unknown");
-                v = tmp;
-            }
+    lines = str_map_find(_edit_files, name);
+    if (lines) return lines;
 
-            /* Random
-               OLD: $RANDOM7 evaluated as seed_town % 7
-               NEW: [MOD $RANDOM37 7] where 37 refers to the seed
-               for quest 37. Every quest gets assigned a new seed
-               when it is accepted in bldg.c.
-            */
-            else if (prefix(b+1, "RANDOM"))
-            {
-                int q_idx = atoi(b+7);
-                /* "RANDOM" uses a special parameter to determine the number of the quest */
-                sprintf(tmp, "%d", quests_get(q_idx)->seed);
-                v = tmp;
-            }
+    path_build(buf, sizeof(buf), ANGBAND_DIR_EDIT, name);
+    fp = my_fopen(buf, "r");
+    if (!fp) return NULL;
 
-            /* Variant name */
-            else if (streq(b+1, "VARIANT"))
-            {
-                v = variant_name;
-            }
+    lines = vec_alloc((vec_free_f)_edit_line_free);
+    while (0 == my_fgets(fp, buf, sizeof(buf)))
+    {
+        _edit_line_ptr line;
 
-            /* Wilderness */
-            else if (streq(b+1, "WILDERNESS"))
-            {
-                if (no_wilderness)
-                    sprintf(tmp, "NONE");
-                else
-                    sprintf(tmp, "NORMAL");
-                v = tmp;
-            }
+        num++;
 
-            else if (streq(b+1, "SPECIALITY"))
-            {
-                if (p_ptr->pclass == CLASS_WEAPONMASTER)
-                    sprintf(tmp, "%s", weaponmaster_speciality_name(p_ptr->psubclass));
-                else if (p_ptr->pclass == CLASS_DEVICEMASTER)
-                    sprintf(tmp, "%s", devicemaster_speciality_name(p_ptr->psubclass));
-                else
-                    sprintf(tmp, "None");
-                v = tmp;
-            }
-        }
+        if (!buf[0]) continue; /* empty line */
+        if (isspace(buf[0])) continue; /* blank line */
+        if (buf[0] == '#') continue; /* comment */
 
-        /* Constant */
+        MAKE(line, _edit_line_t);
+        line->num = num;
+        if (buf[0] == '?' && buf[1] == ':') /* ?:<exp> conditional controls subsequent parsing */
+        {
+            char  f;
+            char *s = buf + 2;
+
+            line->text = NULL;
+            line->expr = _expr_compile(&s, &f);
+        }
         else
         {
-            v = b;
+            line->text = z_string_make(buf);
+            line->expr = NULL;
         }
+        vec_add(lines, line);
     }
+    my_fclose(fp);
 
-    /* Save */
-    (*fp) = f;
-
-    /* Save */
-    (*sp) = s;
-
-    /* Result */
-    return (v);
+    str_map_add(_edit_files, name, lines);
+    return lines;
 }
 
 /* XXX Replace with parse_edit_file ... */
 errr process_dungeon_file(cptr name, int options)
 {
-    FILE      *fp;
+    vec_ptr    lines;
     char       buf[1024];
-    int        num = 0;
+    int        i, num = 0;
     errr       err = 0;
     bool       bypass = FALSE;
 
-    /* Build the filename */
-    path_build(buf, sizeof(buf), ANGBAND_DIR_EDIT, name);
-
-    /* Open the file */
-    fp = my_fopen(buf, "r");
+    /* Load the file */
+    lines = _edit_file(name);
 
     /* No such file */
-    if (!fp) return (-1);
+    if (!lines) return (-1);
 
     /* Process the file */
-    while (0 == my_fgets(fp, buf, sizeof(buf)))
+    for (i = 0; i < vec_length(lines); i++)
     {
-        /* Count lines */
-        num++;
-
-
-        /* Skip "empty" lines */
-        if (!buf[0]) continue;
-
-        /* Skip "blank" lines */
-        if (isspace(buf[0])) continue;
-
-        /* Skip comments */
-        if (buf[0] == '#') continue;
+        _edit_line_ptr line = vec_get(lines, i);
 
+        /* Count lines */
+        num = line->num;
 
         /* Process "?:<expr>" */
-        if ((buf[0] == '?') && (buf[1] == ':'))
+        if (line->expr)
         {
-            char f;
-            cptr v;
-            char *s;
-
-            /* Start */
-            s = buf + 2;
-
-            /* Parse the expr */
-            v = process_dungeon_file_expr(&s, &f);
-
             /* Set flag */
-            bypass = (streq(v, "0") ? TRUE : FALSE);
+            bypass = (streq(_expr_eval(line->expr), "0") ? TRUE : FALSE);
 
             /* Continue */
             continue;
@@ -5061,6 +5207,7 @@ errr process_dungeon_file(cptr name, int options)
         /* Apply conditionals ... INIT_DEBUG is for testing purposes */
         if (!(options & INIT_DEBUG) && bypass) continue;
 
+        strcpy(buf, line->text);
         err = process_dungeon_file_aux(buf, options);
 
         /* Oops */
@@ -5083,47 +5230,35 @@ errr process_dungeon_file(cptr name, int options)
         msg_print(NULL);
     }
 
-    /* Close the file */
-    my_fclose(fp);
-
     /* Result */
     return (err);
 }
 
 errr parse_edit_file(cptr name, parser_f parser, int options)
 {
-    FILE *fp;
-    char  buf[1024];
-    int   line_num = 0;
-    errr  err = 0;
-    bool  bypass = FALSE;
+    vec_ptr lines;
+    char    buf[1024];
+    int     i;
+    errr    err = 0;
+    bool    bypass = FALSE;
 
     assert(parser);
 
-    path_build(buf, sizeof(buf), ANGBAND_DIR_EDIT, name);
-    fp = my_fopen(buf, "r");
-    if (!fp) return (-1);
+    lines = _edit_file(name);
+    if (!lines) return (-1);
 
-    while (!err && 0 == my_fgets(fp, buf, sizeof(buf)))
+    for (i = 0; !err && i < vec_length(lines); i++)
     {
-        line_num++;
+        _edit_line_ptr line = vec_get(lines, i);
 
-        if (!buf[0]) continue; /* empty line */
-        if (isspace(buf[0])) continue; /* blank line */
-        if (buf[0] == '#') continue; /* comment */
-        if (buf[0] == '?' && buf[1] == ':') /* ?:<exp> conditional controls subsequent parsing */
+        if (line->expr) /* ?:<exp> conditional controls subsequent parsing */
         {
-            char f;
-            cptr v;
-            char *s;
-
-            s = buf + 2;
-            v = process_dungeon_file_expr(&s, &f);
-            bypass = streq(v, "0"); /* skip until subsequent ?: returns true */
+            bypass = streq(_expr_eval(line->expr), "0"); /* skip until subsequent ?: returns true */
             continue;
         }
         if (!(options & INIT_DEBUG) && bypass) continue; /* apply skip unless debugging */
 
+        strcpy(buf, line->text);
         if (buf[0] == '%' && buf[1] == ':') /* %:file.txt */
             err = parse_edit_file(buf + 2, parser, options);
         else
@@ -5131,7 +5266,7 @@ errr parse_edit_file(cptr name, parser_f parser, int options)
             if (trace_doc && (buf[0] == 'L' || buf[0] == 'R'))
             {
                 doc_printf(trace_doc, "<color:R>%s:%d</color> <indent>%s</indent>\n",
-                    name, line_num, buf);
+                    name, line->num, buf);
             }
             err = parser(buf, options);
             if (err) /* report now for recursion */
@@ -5139,14 +5274,13 @@ errr parse_edit_file(cptr name, parser_f parser, int options)
                 cptr oops = (err > 0 && err < PARSE_ERROR_MAX) ? err_str[err] : "unknown";
 
                 msg_boundary();
-                msg_format("<color:v>Error</color> %d (%s) at line %d of '%s'.", err, oops, line_num, name);
+                msg_format("<color:v>Error</color> %d (%s) at line %d of '%s'.", err, oops, line->num, name);
                 msg_format("Parsing '%s'.", buf);
                 msg_print(NULL); /* quit() during initialization ... */
             }
         }
     }
 
-    my_fclose(fp);
     return err;
 }
 
@@ -398,6 +398,201 @@ static void init_header(header *head, int num, int len)
 }
 
 
+/*
+ * Binary snapshots of the parsed "*_info" arrays.
+ *
+ * After a template is parsed (and retouched) its info, name, text and tag
+ * arrays are written to "<name>.raw" in the user directory, and later
+ * startups read them back in one go instead of parsing. A snapshot is only
+ * trusted if its key matches: the key hashes the version, the snapshot
+ * format (INFO_RAW_VERSION), the sizes of the basic types and records and
+ * the full contents of the template. Keys are chained
+ * from one template to the next, since later parsers look things up in
+ * earlier arrays (d_info resolves f_info tags and k_info kinds), so any
+ * edit retires every snapshot after it. A checksum over the payload
+ * catches truncated or damaged files. Failing to write is harmless.
+ */
+#define INFO_RAW_MAGIC 0x57415249  /* "IRAW" */
+
+/* Bump this whenever a parser changes what it stores in a record without
+ * changing the size of the record */
+#define INFO_RAW_VERSION 1
+
+typedef struct {
+    u32b magic;
+    u32b key;
+    u32b info_num;
+    u32b info_len;
+    u32b info_size;
+    u32b name_size;
+    u32b text_size;
+    u32b tag_size;
+    u32b sum;
+} info_raw_head;
+
+/* Key of the previous template, chained into the next (see above) */
+static u32b _info_key = 0;
+
+/* FNV-1a */
+static u32b _info_hash(u32b h, const byte *p, u32b n)
+{
+    u32b i;
+    for (i = 0; i < n; i++)
+    {
+        h ^= p[i];
+        h *= 16777619UL;
+    }
+    return h;
+}
+
+static u32b _info_raw_key(cptr filename, header *head)
+{
+    char  buf[1024];
+    byte  chunk[4096];
+    u32b  h = _info_key;
+    FILE *fp;
+    size_t n;
+
+    if (!h)
+    {
+        u32b layout[8];
+
+        layout[0] = INFO_RAW_VERSION;
+        layout[1] = 0x01020304;  /* Byte order */
+        layout[2] = sizeof(header);
+        layout[3] = sizeof(int);
+        layout[4] = sizeof(long);
+        layout[5] = sizeof(void *);
+        layout[6] = sizeof(s16b);
+        layout[7] = sizeof(s32b);
+
+        h = 2166136261UL;
+        h = _info_hash(h, (const byte *)layout, sizeof(layout));
+        h = _info_hash(h, &head->v_major, 3);
+    }
+    h = _info_hash(h, (const byte *)filename, strlen(filename));
+    h = _info_hash(h, (const byte *)&head->info_num, sizeof(head->info_num));
+    h = _info_hash(h, (const byte *)&head->info_len, sizeof(head->info_len));
+
+    path_build(buf, sizeof(buf), ANGBAND_DIR_EDIT, format("%s.txt", filename));
+    fp = my_fopen(buf, "rb");
+    if (!fp) return 0;
+    while ((n = fread(chunk, 1, sizeof(chunk), fp)) > 0)
+        h = _info_hash(h, chunk, n);
+    my_fclose(fp);
+
+    return h;
+}
+
+static bool _info_raw_load(cptr filename, header *head, u32b key,
+              void **info, char **name, char **text, char **tag)
+{
+    char buf[1024];
+    info_raw_head rh;
+    char *data, *end;
+    u32b size;
+    int fd;
+
+    path_build(buf, sizeof(buf), ANGBAND_DIR_USER, format("%s.raw", filename));
+    fd = fd_open(buf, O_RDONLY);
+    if (fd < 0) return FALSE;
+
+    if ( fd_read(fd, (char *)&rh, sizeof(rh))
+      || rh.magic != INFO_RAW_MAGIC
+      || rh.key != key
+      || rh.info_num != head->info_num
+      || rh.info_len != head->info_len
+      || rh.info_size != head->info_size
+      || (!name && rh.name_size)
+      || (!text && rh.text_size)
+      || (!tag && rh.tag_size) )
+    {
+        (void)fd_close(fd);
+        return FALSE;
+    }
+
+    /* One block for all four arrays, plus a '\0' for the empty ones.
+     * Like the parsed arrays, these are never freed. */
+    size = rh.info_size + rh.name_size + rh.text_size + rh.tag_size;
+    C_MAKE(data, size + 1, char);
+    if (fd_read(fd, data, size) || _info_hash(2166136261UL, (byte *)data, size) != rh.sum)
+    {
+        (void)fd_close(fd);
+        C_KILL(data, size + 1, char);
+        return FALSE;
+    }
+    (void)fd_close(fd);
+
+    head->name_size = rh.name_size;
+    head->text_size = rh.text_size;
+    head->tag_size = rh.tag_size;
+
+    end = data + size;
+    head->info_ptr = data;
+    data += rh.info_size;
+    head->name_ptr = rh.name_size ? data : end;
+    data += rh.name_size;
+    head->text_ptr = rh.text_size ? data : end;
+    data += rh.text_size;
+    head->tag_ptr = rh.tag_size ? data : end;
+
+    if (info) (*info) = head->info_ptr;
+    if (name) (*name) = head->name_ptr;
+    if (text) (*text) = head->text_ptr;
+    if (tag)  (*tag)  = head->tag_ptr;
+
+    return TRUE;
+}
+
+static void _info_raw_save(cptr filename, header *head, u32b key)
+{
+    char buf[1024];
+    char tmp[1024];
+    info_raw_head rh;
+    int fd;
+    bool ok;
+
+    rh.magic = INFO_RAW_MAGIC;
+    rh.key = key;
+    rh.info_num = head->info_num;
+    rh.info_len = head->info_len;
+    rh.info_size = head->info_size;
+    rh.name_size = head->name_size;
+    rh.text_size = head->text_size;
+    rh.tag_size = head->tag_size;
+
+    rh.sum = 2166136261UL;
+    rh.sum = _info_hash(rh.sum, head->info_ptr, rh.info_size);
+    if (rh.name_size) rh.sum = _info_hash(rh.sum, (byte *)head->name_ptr, rh.name_size);
+    if (rh.text_size) rh.sum = _info_hash(rh.sum, (byte *)head->text_ptr, rh.text_size);
+    if (rh.tag_size) rh.sum = _info_hash(rh.sum, (byte *)head->tag_ptr, rh.tag_size);
+
+    /* Write beside the real file and rename, so that several copies
+     * starting at once never see a partial snapshot. */
+    path_build(buf, sizeof(buf), ANGBAND_DIR_USER, format("%s.raw", filename));
+#ifdef SET_UID
+    strnfmt(tmp, sizeof(tmp), "%s.%d", buf, (int)getpid());
+#else
+    strnfmt(tmp, sizeof(tmp), "%s.new", buf);
+#endif
+
+    (void)fd_kill(tmp);
+    FILE_TYPE(FILE_TYPE_DATA);
+    fd = fd_make(tmp, 0644);
+    if (fd < 0) return;
+
+    ok = !fd_write(fd, (cptr)&rh, sizeof(rh))
+      && !fd_write(fd, head->info_ptr, rh.info_size)
+      && (!rh.name_size || !fd_write(fd, head->name_ptr, rh.name_size))
+      && (!rh.text_size || !fd_write(fd, head->text_ptr, rh.text_size))
+      && (!rh.tag_size || !fd_write(fd, head->tag_ptr, rh.tag_size));
+    (void)fd_close(fd);
+
+    if (ok) (void)fd_move(tmp, buf);
+    else (void)fd_kill(tmp);
+}
+
+
 /*
  * Initialize the "*_info" array
  *
@@ -408,10 +603,9 @@ static void init_header(header *head, int num, int len)
  * would parse txt template files to recreate the raw files, throw
  * everything away, and re-read the raw files. Alas, the code was not
  * good at knowing when to recreate (it used timestamps) and often
- * resulted in corruption. Now, while I can certainly figure this out
- * and manually delete my *.raw files, I'd rather not have player's games
- * crash when they upgrade to a new version. Parsing templates takes 150ms
- * on my ancient machine, so why bother?
+ * resulted in corruption. The snapshots are back (see _info_raw_load
+ * above), but they are keyed on the template contents rather than
+ * timestamps, and a snapshot that does not match is simply reparsed.
  *
  * TODO: Refactor Initialization code. No need for headers, etc.
  * Tags, Text and Name should just be malloc'd strings. Room templates
@@ -422,11 +616,19 @@ static errr init_info(cptr filename, header *head,
 {
     errr err = 1;
     FILE *fp;
+    u32b key;
 
     /* General buffer */
     char buf[1024];
 
 
+    /*** Load the binary snapshot, if it is current ***/
+
+    key = _info_raw_key(filename, head);
+    _info_key = key;
+    if (key && _info_raw_load(filename, head, key, info, name, text, tag))
+        return (0);
+
     /* Allocate the "*_info" array */
     C_MAKE(head->info_ptr, head->info_size, char);
 
@@ -486,6 +688,10 @@ static errr init_info(cptr filename, header *head,
         (*head->retouch)(head);
     }
 
+    /*** Save the binary snapshot for next time ***/
+
+    if (key) _info_raw_save(filename, head, key);
+
     /* Success */
     return (0);
 }
@@ -953,6 +1159,12 @@ static errr init_other(void)
         C_MAKE(mproc_list[i], max_m_idx, s16b);
     }
 
+    /* Allocate and Wipe the idle monster bitmap */
+    C_MAKE(m_idle, (max_m_idx + 31) / 32, u32b);
+
+    /* Allocate and Wipe the live monster bitmap */
+    C_MAKE(m_live, (max_m_idx + 31) / 32, u32b);
+
     /* Allocate and Wipe the max dungeon level */
     C_MAKE(max_dlv, max_d_idx, s16b);
     C_MAKE(dungeon_flags, max_d_idx, u32b);
@@ -964,6 +1176,10 @@ static errr init_other(void)
         C_MAKE(cave[i], MAX_WID, cave_type);
     }
 
+    /* Allocate and Wipe the spatial index of the cave */
+    C_MAKE(spatial_mon, SPATIAL_HGT * SPATIAL_WID, byte);
+    C_MAKE(spatial_obj, SPATIAL_HGT * SPATIAL_WID, byte);
+
 
     /*** Prepare the various "bizarre" arrays ***/
 
@@ -979,6 +1195,9 @@ static errr init_other(void)
     /* Quark variables */
     quark_init();
 
+    /* Terrain passability */
+    mon_move_init();
+
     /*** Prepare the options ***/
 
     /* Scan the options */
@@ -10,8 +10,28 @@ struct inv_s
     int     max;
     int     flags;
     vec_ptr objects; /* sparse ... grows as needed (up to max+1 if max is set) */
+    inv_ptr next;    /* every inventory which owns its objects (see inv_all_for_each) */
+    inv_ptr prev;
 };
 
+static inv_ptr _all = NULL;
+
+static void _link(inv_ptr inv)
+{
+    inv->prev = NULL;
+    inv->next = _all;
+    if (_all) _all->prev = inv;
+    _all = inv;
+}
+
+static void _unlink(inv_ptr inv)
+{
+    if (inv != _all && !inv->prev) return; /* filters are never linked */
+    if (inv->prev) inv->prev->next = inv->next;
+    else _all = inv->next;
+    if (inv->next) inv->next->prev = inv->prev;
+}
+
 /* Slots: We are assuming slot <= 26 */
 char slot_label(slot_t slot)
 {
@@ -49,6 +69,7 @@ inv_ptr inv_alloc(cptr name, int type, int max)
     result->max = max;
     result->flags = 0;
     result->objects = vec_alloc((vec_free_f)obj_free);
+    _link(result);
     return result;
 }
 
@@ -71,6 +92,7 @@ inv_ptr inv_copy(inv_ptr src)
         else
             vec_add(result->objects, NULL);
     }
+    _link(result);
     return result;
 }
 
@@ -98,6 +120,7 @@ inv_ptr inv_filter(inv_ptr src, obj_p p)
     result->max = src->max;
     result->flags = src->flags | _FILTER;
     result->objects = vec_alloc(NULL); /* src owns the objects! */
+    result->next = result->prev = NULL;
 
     for (i = 0; i < vec_length(src->objects); i++)
     {
@@ -124,6 +147,7 @@ inv_ptr inv_filter_floor(point_t loc, obj_p p)
     result->max = 0;
     result->flags = _FILTER;
     result->objects = vec_alloc(NULL); /* o_list owns the objects! */
+    result->next = result->prev = NULL;
 
     vec_add(result->objects, NULL); /* slot 0 is invalid */
 
@@ -159,6 +183,7 @@ void inv_free(inv_ptr inv)
 {
     if (inv)
     {
+        _unlink(inv);
         vec_free(inv->objects);
         inv->objects = NULL;
         inv->name = NULL;
@@ -497,6 +522,15 @@ void inv_for_each_that(inv_ptr inv, obj_f f, obj_p p)
     }
 }
 
+/* Every object of every inventory (shops, the home and museum, the pack
+ * and so on), but not of filters, whose objects belong to another */
+void inv_all_for_each(obj_f f)
+{
+    inv_ptr inv;
+    for (inv = _all; inv; inv = inv->next)
+        inv_for_each(inv, f);
+}
+
 void inv_for_each_slot(inv_ptr inv, slot_f f)
 {
     int slot;
@@ -69,6 +69,7 @@ extern slot_t  inv_find_obj(inv_ptr inv, int tval, int sval);
 extern void    inv_for_each(inv_ptr inv, obj_f f); /* apply f to each non-null object */
 extern void    inv_for_each_that(inv_ptr inv, obj_f f, obj_p p); /* apply f to each object that p accepts */
 extern void    inv_for_each_slot(inv_ptr inv, slot_f f); /* apply f to all slots, empty or not */
+extern void    inv_all_for_each(obj_f f); /* apply f to each object of every inventory */
 extern slot_t  inv_random_slot(inv_ptr inv, obj_p p); /* used for disenchantment, cursing, rusting, inventory damage, etc */
 
 /* Properties of the Entire Inventory */
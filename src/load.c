@@ -195,11 +195,40 @@ static void rd_lore(savefile_ptr file, int r_idx)
 static void rd_randomizer(savefile_ptr file)
 {
     int i;
-    Rand_place = savefile_read_u16b(file);
 
-    for (i = 0; i < RAND_DEG; i++)
-        Rand_state[i] = savefile_read_u32b(file);
+    /* The old degree 63 RNG: seed the new one from it */
+    if (savefile_is_older_than(file, 6, 0, 5, 1))
+    {
+        u32b table[RAND_DEG];
+        u16b place = savefile_read_u16b(file);
+
+        for (i = 0; i < RAND_DEG; i++)
+            table[i] = savefile_read_u32b(file);
+
+        Rand_state_init_old(place, table);
+    }
+    else
+    {
+        int n = savefile_read_byte(file);
+
+        for (i = 0; i < n; i++)
+        {
+            rand_stream_t tmp;
+
+            tmp.state = savefile_read_u32b(file);
+            tmp.state = (tmp.state << 32) | savefile_read_u32b(file);
+            tmp.inc = savefile_read_u32b(file);
+            tmp.inc = (tmp.inc << 32) | savefile_read_u32b(file);
+
+            if (i < RAND_STREAMS) Rand_state[i] = tmp;
+        }
 
+        /* Streams added since are seeded from the game stream */
+        if (n < RAND_STREAMS)
+            Rand_state_init_from(n, (u32b)Rand_state[RAND_STREAM_GAME].state);
+    }
+
+    Rand_stream_set(RAND_STREAM_GAME);
     Rand_quick = FALSE;
 }
 
@@ -532,6 +561,7 @@ static void rd_extra(savefile_ptr file)
             r_ptr->flagsr = savefile_read_u32b(file);
             r_ptr->flags2 = savefile_read_u32b(file);
             r_ptr->flags7 = savefile_read_u32b(file);
+            mon_move_update(r_ptr);
         }
     }
 
@@ -720,43 +750,104 @@ static errr rd_saved_floor(savefile_ptr file, saved_floor_type *sf_ptr)
 
 
     /*** Run length decoding ***/
-    /* Load the dungeon data */
-    for (x = y = 0; y < ymax; )
+    if (savefile_is_older_than(file, 6, 0, 5, 2))
     {
-        u16b id;
+        /* Load the dungeon data */
+        for (x = y = 0; y < ymax; )
+        {
+            u16b id;
+
+            /* Grab RLE info */
+            count = savefile_read_byte(file);
+
+            id = 0;
+            do
+            {
+                tmp8u = savefile_read_byte(file);
+                id += tmp8u;
+            } while (tmp8u == MAX_UCHAR);
 
-        /* Grab RLE info */
-        count = savefile_read_byte(file);
+            /* Apply the RLE info */
+            for (i = count; i > 0; i--)
+            {
+                /* Access the cave */
+                cave_type *c_ptr = &cave[y][x];
+
+                /* Extract cave data */
+                c_ptr->info = template[id].info;
+                c_ptr->feat = template[id].feat;
+                c_ptr->mimic = template[id].mimic;
+                c_ptr->special = template[id].special;
+
+                /* Advance/Wrap */
+                if (++x >= xmax)
+                {
+                    /* Wrap */
+                    x = 0;
 
-        id = 0;
-        do
+                    /* Advance/Wrap */
+                    if (++y >= ymax) break;
+                }
+            }
+        }
+    }
+
+    /*** Delta decoding (see wr_saved_floor) ***/
+    else
+    {
+        for (i = 0; i < ymax * xmax; )
         {
+            u16b id;
+            bool above;
+
+            /* Grab the run */
             tmp8u = savefile_read_byte(file);
-            id += tmp8u;
-        } while (tmp8u == MAX_UCHAR);
+            above = (tmp8u & 0x80) ? TRUE : FALSE;
+            count = (above ? (tmp8u & 0x7F) : tmp8u) + 1;
 
-        /* Apply the RLE info */
-        for (i = count; i > 0; i--)
-        {
-            /* Access the cave */
-            cave_type *c_ptr = &cave[y][x];
+            id = 0;
+            if (!above)
+            {
+                do
+                {
+                    tmp8u = savefile_read_byte(file);
+                    id += tmp8u;
+                } while (tmp8u == MAX_UCHAR);
+            }
 
-            /* Extract cave data */
-            c_ptr->info = template[id].info;
-            c_ptr->feat = template[id].feat;
-            c_ptr->mimic = template[id].mimic;
-            c_ptr->special = template[id].special;
+            /* Reject broken runs */
+            if (i + count > ymax * xmax) break;
+            if (above ? (i < xmax) : (id >= limit)) break;
 
-            /* Advance/Wrap */
-            if (++x >= xmax)
+            /* Apply the run */
+            for (; count > 0; count--, i++)
             {
-                /* Wrap */
-                x = 0;
+                cave_type *c_ptr = &cave[i / xmax][i % xmax];
 
-                /* Advance/Wrap */
-                if (++y >= ymax) break;
+                if (above)
+                {
+                    cave_type *a_ptr = &cave[i / xmax - 1][i % xmax];
+
+                    c_ptr->info = a_ptr->info;
+                    c_ptr->feat = a_ptr->feat;
+                    c_ptr->mimic = a_ptr->mimic;
+                    c_ptr->special = a_ptr->special;
+                }
+                else
+                {
+                    c_ptr->info = template[id].info;
+                    c_ptr->feat = template[id].feat;
+                    c_ptr->mimic = template[id].mimic;
+                    c_ptr->special = template[id].special;
+                }
             }
         }
+
+        if (i < ymax * xmax)
+        {
+            C_FREE(template, limit, cave_template_type);
+            return 171;
+        }
     }
 
     /* Free the "template" array */
@@ -784,9 +875,8 @@ static errr rd_saved_floor(savefile_ptr file, saved_floor_type *sf_ptr)
         }
         else
         {
-            cave_type *c_ptr = &cave[o_ptr->loc.y][o_ptr->loc.x];
-            o_ptr->next_o_idx = c_ptr->o_idx;
-            c_ptr->o_idx = o_idx;
+            o_ptr->next_o_idx = cave[o_ptr->loc.y][o_ptr->loc.x].o_idx;
+            cave_set_o_idx(o_ptr->loc.y, o_ptr->loc.x, o_idx);
         }
     }
 
@@ -796,7 +886,6 @@ static errr rd_saved_floor(savefile_ptr file, saved_floor_type *sf_ptr)
     if (limit > max_m_idx) return 161;
     for (i = 1; i < limit; i++)
     {
-        cave_type *c_ptr;
         int m_idx;
         monster_type *m_ptr;
 
@@ -804,8 +893,7 @@ static errr rd_saved_floor(savefile_ptr file, saved_floor_type *sf_ptr)
         if (i != m_idx) return 162;
         m_ptr = &m_list[m_idx];
         rd_monster(file, m_ptr);
-        c_ptr = &cave[m_ptr->fy][m_ptr->fx];
-        c_ptr->m_idx = m_idx;
+        cave_set_m_idx(m_ptr->fy, m_ptr->fx, m_idx);
         real_r_ptr(m_ptr)->cur_num++;
     }
 
@@ -1288,7 +1376,7 @@ errr rd_savefile_new(void)
     if (!file) return -1;
 
     err = rd_savefile_new_aux(file);
-    if (ferror(file->file)) err = -1;
+    if (savefile_error(file)) err = -1;
 
     savefile_close(file);
     return err;
@@ -1342,12 +1430,13 @@ bool load_floor(saved_floor_type *sf_ptr, u32b mode)
     if (!file) return FALSE;
 
     ok = load_floor_aux(file, sf_ptr);
-    if (ferror(file->file)) ok = FALSE;
+    if (savefile_error(file)) ok = FALSE;
 
     savefile_close(file);
 
     if (!(mode & SLF_NO_KILL))
     {
+        savefile_wait(floor_savefile);
         safe_setuid_grab();
         fd_kill(floor_savefile);
         safe_setuid_drop();
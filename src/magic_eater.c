@@ -9,6 +9,17 @@ static object_type _wands[_MAX_SLOTS];
 static object_type _staves[_MAX_SLOTS];
 static object_type _rods[_MAX_SLOTS];
 
+void magic_eater_for_each_obj(obj_f f)
+{
+    int i;
+    for (i = 0; i < _MAX_SLOTS; i++)
+    {
+        if (_wands[i].k_idx) f(&_wands[i]);
+        if (_staves[i].k_idx) f(&_staves[i]);
+        if (_rods[i].k_idx) f(&_rods[i]);
+    }
+}
+
 static void _birth(void)
 {
     int i;
@@ -0,0 +1,616 @@
+/* File: main-test.c */
+
+/*
+ * Copyright (c) 1997 Ben Harrison, and others
+ *
+ * This software may be copied and distributed for educational, research,
+ * and not for profit purposes provided that this copyright and statement
+ * are included in all such copies.
+ */
+
+/* Purpose: Headless front end for benchmarking whole game turns */
+
+/*
+ * This "display module" never draws anything. It plays a savefile (or a
+ * new character made with a fixed seed) by feeding the game keystrokes
+ * from a script, one key each time the game waits for input, replaying
+ * the script from the top whenever it runs out. After the requested
+ * number of game turns it prints the turn rate, the cpu time spent in
+ * process_player(), process_monsters() and process_world(), how many
+ * terrain checks the passability table answered, how many map grids were
+ * redrawn, and a checksum of the final game state, then quits without
+ * saving.
+ *
+ * Since the savefile carries the state of the RNG, two runs of the same
+ * binary on the same savefile and script must print the same checksum,
+ * which makes this a cheap way to check that an optimisation changed
+ * nothing but the speed: run once with "-r", which makes the engine take
+ * the reference routines its caches stand in for, and once without, and
+ * compare. "-v" goes further and checks each cache against the plain
+ * routine every time the game waits for a key, which must not change the
+ * checksum either. (tests/run.sh does all three.)
+ *
+ * The script may use the debug commands (a test run is never scored).
+ *
+ * Sub options (after "--"):
+ *   -k<file>  Read the keystroke script from <file>
+ *   -n<num>   Advance <num> game turns (default 10000)
+ *   -s<num>   Seed the RNG of a new character (with -n)
+ *   -d        Dump the screen when done
+ *   -r        Take the reference routines instead of the optimised ones
+ *   -v        Verify the engine's caches as the game goes, and print the
+ *             number of errors each check found
+ *   -b<name>[,<reps>]
+ *             Instead of playing, run the benchmark <name> (or "all" of
+ *             them) on the first level, and print the times
+ *             (see wiz_bench() in wizard2.c)
+ *   -g<min>,<max>,<reps>[,<workers>[,<dungeon>]]
+ *             Instead of playing, generate <reps> levels at each depth from
+ *             <min> to <max> of the Angband dungeon (or of d_info entry
+ *             <dungeon>, within its depths) on every cpu (or in <workers>
+ *             processes, 0 for every cpu), and print statistics as CSV
+ *             (see wiz_batch_stats() in wizard2.c)
+ *
+ * The script is read a line at a time, and each line is decoded like the
+ * action of a keymap (so "\e" is escape, "\r" is return and "^X" is a
+ * control key). Blank lines and lines starting with '#' are ignored.
+ * If there is a line "%loop", the keys before it (say, to roll up a new
+ * character) are only played once, and replays start from that line.
+ * For example, this rolls up the default character and then rests:
+ *
+ *   # dismiss "Savefile does not exist", pick a normal game
+ *   \s
+ *   n
+ *   # accept every birth screen (eight of them)
+ *   \r\r\r\r\r\r\r\r
+ *   %loop
+ *   \s\e\e\eR9999\r
+ *
+ * Starting each command with "\s\e" dismisses any stray "-more-" prompt
+ * (some, like the low hitpoint warning, only take a space).
+ * The default script just rests. Autosaves are turned off, and the run
+ * stops early if the character dies (before it can be saved) or the
+ * game stops asking for keys without time passing.
+ */
+
+#include "angband.h"
+
+#ifdef USE_TEST
+
+/* Keys fed without a game turn passing before we give up */
+#define TEST_STALL 100000
+
+
+/*
+ * The only term
+ */
+static term test_term;
+
+/*
+ * The keystroke script
+ */
+static char *test_keys = NULL;
+static int test_keys_n = 0;
+static int test_keys_pos = 0;
+static int test_keys_loop = 0;
+
+/*
+ * The run
+ */
+static s32b test_turns = 10000;
+static bool test_dump = FALSE;
+static bool test_started = FALSE;
+static s32b test_start_turn;
+static clock_t test_start_clock;
+static s32b test_last_turn;
+static int test_stall;
+static int test_batch[5];
+static char test_bench[32];
+static int test_bench_reps;
+static bool test_verifying = FALSE;
+static int test_verify_count;
+
+
+/*
+ * Checksum the parts of the game state that play touches
+ */
+static u32b test_checksum_aux(u32b h, const void *p, int n)
+{
+    const byte *b = (const byte *)p;
+    int i;
+
+    /* FNV-1a */
+    for (i = 0; i < n; i++)
+    {
+        h ^= b[i];
+        h *= 16777619UL;
+    }
+    return h;
+}
+
+#define test_checksum_val(H,V) ((H) = test_checksum_aux((H), &(V), sizeof(V)))
+
+static u32b test_checksum(void)
+{
+    u32b h = 2166136261UL;
+    int i, y, x;
+
+    test_checksum_val(h, game_turn);
+    test_checksum_val(h, dun_level);
+    test_checksum_val(h, py);
+    test_checksum_val(h, px);
+    test_checksum_val(h, p_ptr->chp);
+    test_checksum_val(h, p_ptr->csp);
+    test_checksum_val(h, p_ptr->exp);
+    test_checksum_val(h, p_ptr->au);
+    test_checksum_val(h, p_ptr->energy_need);
+    h = test_checksum_aux(h, Rand_state, sizeof(Rand_state));
+
+    for (y = 0; y < cur_hgt; y++)
+    {
+        for (x = 0; x < cur_wid; x++)
+        {
+            cave_type *c_ptr = &cave[y][x];
+            u32b       info = c_ptr->info & (CAVE_MARK | CAVE_LITE | CAVE_VIEW);
+
+            test_checksum_val(h, c_ptr->feat);
+            test_checksum_val(h, info);
+            test_checksum_val(h, c_ptr->m_idx);
+            test_checksum_val(h, c_ptr->o_idx);
+        }
+    }
+
+    for (i = 1; i < m_max; i++)
+    {
+        monster_type *m_ptr = &m_list[i];
+
+        if (!m_ptr->r_idx) continue;
+        test_checksum_val(h, m_ptr->r_idx);
+        test_checksum_val(h, m_ptr->fy);
+        test_checksum_val(h, m_ptr->fx);
+        test_checksum_val(h, m_ptr->hp);
+        test_checksum_val(h, m_ptr->energy_need);
+    }
+
+    for (i = 1; i < o_max; i++)
+    {
+        object_type *o_ptr = &o_list[i];
+
+        if (!o_ptr->k_idx) continue;
+        test_checksum_val(h, o_ptr->k_idx);
+        test_checksum_val(h, o_ptr->loc.y);
+        test_checksum_val(h, o_ptr->loc.x);
+        test_checksum_val(h, o_ptr->number);
+    }
+
+    return h;
+}
+
+
+/*
+ * Feed every macro trigger, and every trigger cut short, through the
+ * macro trie and the plain scan of the macros, and compare the answers
+ */
+static int test_verify_macros(void)
+{
+    char keys[4096];
+    int  i, n = 0;
+
+    for (i = 0; i < macro__num; i++)
+    {
+        int len = strlen(macro__pat[i]);
+
+        if (n + 2 * len + 1 >= (int)sizeof(keys)) break;
+        memcpy(keys + n, macro__pat[i], len);
+        n += len;
+        memcpy(keys + n, macro__pat[i], len - 1);
+        n += len - 1;
+        keys[n++] = 'a';
+    }
+    keys[n] = '\0';
+
+    return macro_replay(keys, FALSE) != macro_replay(keys, TRUE);
+}
+
+/*
+ * The checks (see "-v"), each returning the number of errors it found.
+ * The slow ones only run every so many turns.
+ */
+static struct
+{
+    cptr name;
+    int (*fn)(void);
+    int every;
+    int runs;
+    int errors;
+} test_verify[] =
+{
+    { "view", view_verify, 1 },
+    { "los", los_memo_verify, 10 },
+    { "spatial", spatial_verify, 1 },
+    { "flow", flow_verify, 10 },
+    { "fields", flow_cache_verify, 10 },
+    { "idle", mon_sched_verify, 1 },
+    { "live", mon_live_verify, 1 },
+    { "races", mon_alloc_verify, 1 },
+    { "kinds", obj_alloc_verify, 1 },
+    { "autopick", autopick_verify, 1 },
+    { "quarks", quark_verify, 1 },
+    { "save", savefile_verify, 100 },
+    { "bonuses", equip_verify_bonuses, 1 },
+    { "macros", test_verify_macros, 100 },
+    { "moves", mon_move_verify, 100 },
+    { NULL }
+};
+
+static void test_verify_all(void)
+{
+    int i;
+
+    for (i = 0; test_verify[i].name; i++)
+    {
+        if (test_verify_count % test_verify[i].every) continue;
+        test_verify[i].errors += test_verify[i].fn();
+        test_verify[i].runs++;
+    }
+    test_verify_count++;
+}
+
+
+/*
+ * Print the screen
+ */
+static void test_dump_screen(void)
+{
+    int y, x;
+    byte a;
+    char c;
+
+    for (y = 0; y < Term->hgt; y++)
+    {
+        for (x = 0; x < Term->wid; x++)
+        {
+            (void)Term_what(x, y, &a, &c);
+            putchar(c ? c : ' ');
+        }
+        putchar('\n');
+    }
+}
+
+
+/*
+ * Print the results and leave
+ */
+static void test_finish(cptr why)
+{
+    s32b turns = game_turn - test_start_turn;
+    long ms = (long)((clock() - test_start_clock) * 1000 / CLOCKS_PER_SEC);
+
+    if (test_dump) test_dump_screen();
+
+    printf("%s\n", why);
+    printf("turns: %ld in %ld ms (%ld turns/sec)\n", (long)turns, ms,
+        ms ? (long)turns * 1000L / ms : 0L);
+    printf("player: %ld ms, monsters: %ld ms, world: %ld ms\n",
+        (long)(sim_clock[0] * 1000 / CLOCKS_PER_SEC),
+        (long)(sim_clock[1] * 1000 / CLOCKS_PER_SEC),
+        (long)(sim_clock[2] * 1000 / CLOCKS_PER_SEC));
+    printf("terrain checks: %lu from the table, %lu worked out (%ld per turn saved)\n",
+        (unsigned long)mon_move_hits, (unsigned long)mon_move_misses,
+        turns ? (long)(mon_move_hits / turns) : 0L);
+    printf("map redraws: %lu grids in %lu frames (%ld per frame), %lu full redraws, %lu repeats merged\n",
+        (unsigned long)map_redraw_grids, (unsigned long)map_redraw_frames,
+        map_redraw_frames ? (long)(map_redraw_grids / map_redraw_frames) : 0L,
+        (unsigned long)map_redraw_full, (unsigned long)map_redraw_merged);
+    if (test_verifying)
+    {
+        int i;
+
+        for (i = 0; test_verify[i].name; i++)
+        {
+            printf("verify %s: %d errors in %d checks\n", test_verify[i].name,
+                test_verify[i].errors, test_verify[i].runs);
+        }
+    }
+    printf("checksum: %08lx\n", (unsigned long)test_checksum());
+    fflush(stdout);
+
+    quit(NULL);
+}
+
+
+/*
+ * Check how far along we are
+ */
+static void test_check(void)
+{
+    /* Wait for the game proper to begin */
+    if (!character_generated || !character_dungeon) return;
+
+    if (!test_started)
+    {
+        /* Never touch the savefile */
+        autosave_l = FALSE;
+        autosave_t = FALSE;
+
+        /* Let the script use the debug commands without asking */
+        p_ptr->noscore |= 0x0008;
+
+        /* Benchmark instead of play */
+        if (test_bench[0])
+        {
+            if (!wiz_bench(stdout, test_bench, test_bench_reps))
+                plog_fmt("No benchmark '%s'.", test_bench);
+            fflush(stdout);
+            quit(NULL);
+        }
+
+        /* Batch statistics instead of play */
+        if (test_batch[2])
+        {
+            int which = test_batch[4] ? test_batch[4] : DUNGEON_ANGBAND;
+            int lost;
+
+            if (which < 1 || which >= max_d_idx || !d_info[which].maxdepth)
+                quit_fmt("No dungeon %d.", which);
+
+            lost = wiz_batch_stats(stdout, which, test_batch[0], test_batch[1], test_batch[2], test_batch[3]);
+
+            if (lost) plog_fmt("Lost the results of %d levels.", lost);
+            fflush(stdout);
+            quit(NULL);
+        }
+
+        test_started = TRUE;
+        test_start_turn = test_last_turn = game_turn;
+        C_WIPE(sim_clock, 3, clock_t);
+        mon_move_hits = mon_move_misses = 0;
+        map_redraw_grids = map_redraw_frames = map_redraw_full = map_redraw_merged = 0;
+        test_start_clock = clock();
+    }
+
+    if (p_ptr->is_dead) test_finish("died");
+    if (game_turn - test_start_turn >= test_turns) test_finish("done");
+}
+
+
+/*
+ * Feed the next scripted key
+ */
+static void test_feed(void)
+{
+    if (game_turn != test_last_turn)
+    {
+        test_last_turn = game_turn;
+        test_stall = 0;
+        if (test_verifying) test_verify_all();
+    }
+    else if (++test_stall > TEST_STALL)
+    {
+        test_finish("stalled");
+    }
+
+    if (test_keys_pos >= test_keys_n) test_keys_pos = test_keys_loop;
+    Term_keypress((byte)test_keys[test_keys_pos++]);
+}
+
+
+/*
+ * Handle a "special request"
+ */
+static errr Term_xtra_test(int n, int v)
+{
+    switch (n)
+    {
+        /* Process events */
+        case TERM_XTRA_EVENT:
+        test_check();
+
+        /* Only hand out keys when the game will wait for them */
+        if (v) test_feed();
+        return (0);
+
+        /* Flush events */
+        case TERM_XTRA_FLUSH:
+        return (0);
+
+        /* Clear screen, flush output, delay */
+        case TERM_XTRA_CLEAR:
+        case TERM_XTRA_FRESH:
+        case TERM_XTRA_DELAY:
+        return (0);
+    }
+
+    /* Unknown */
+    return (1);
+}
+
+
+/*
+ * Output hooks -- there is nowhere to draw
+ */
+static errr Term_curs_test(int x, int y)
+{
+    (void)x;
+    (void)y;
+    return (0);
+}
+
+static errr Term_wipe_test(int x, int y, int n)
+{
+    (void)x;
+    (void)y;
+    (void)n;
+    return (0);
+}
+
+static errr Term_text_test(int x, int y, int n, byte a, cptr s)
+{
+    (void)x;
+    (void)y;
+    (void)n;
+    (void)a;
+    (void)s;
+    return (0);
+}
+
+
+/*
+ * Read the keystroke script
+ */
+static errr test_load_keys(cptr name)
+{
+    FILE *fff;
+    char line[1024];
+    char keys[1024];
+    int size = 1024;
+
+    fff = my_fopen(name, "r");
+    if (!fff) return (-1);
+
+    C_MAKE(test_keys, size, char);
+    while (0 == my_fgets(fff, line, sizeof(line)))
+    {
+        int len;
+
+        if (!line[0] || (line[0] == '#')) continue;
+
+        /* Replay from here on */
+        if (streq(line, "%loop"))
+        {
+            test_keys_loop = test_keys_n;
+            continue;
+        }
+
+        text_to_ascii(keys, line);
+        len = strlen(keys);
+
+        /* Grow as needed */
+        if (test_keys_n + len > size)
+        {
+            char *old = test_keys;
+
+            C_MAKE(test_keys, size * 2 + len, char);
+            C_COPY(test_keys, old, test_keys_n, char);
+            C_KILL(old, size, char);
+            size = size * 2 + len;
+        }
+
+        C_COPY(test_keys + test_keys_n, keys, len, char);
+        test_keys_n += len;
+    }
+    my_fclose(fff);
+
+    return (test_keys_n ? 0 : -1);
+}
+
+
+errr init_test(int argc, char *argv[])
+{
+    term *t = &test_term;
+    int i;
+
+    /* Parse args */
+    for (i = 1; i < argc; i++)
+    {
+        if (prefix(argv[i], "-k"))
+        {
+            if (test_load_keys(&argv[i][2]))
+                quit_fmt("Unable to read keys from '%s'", &argv[i][2]);
+            continue;
+        }
+
+        if (prefix(argv[i], "-n"))
+        {
+            test_turns = atol(&argv[i][2]);
+            continue;
+        }
+
+        if (prefix(argv[i], "-s"))
+        {
+            arg_seed = (u32b)strtoul(&argv[i][2], NULL, 0);
+            continue;
+        }
+
+        if (prefix(argv[i], "-g"))
+        {
+            if (sscanf(&argv[i][2], "%d,%d,%d,%d,%d", &test_batch[0], &test_batch[1], &test_batch[2], &test_batch[3], &test_batch[4]) < 3)
+                quit_fmt("Bad batch: '%s'", &argv[i][2]);
+            continue;
+        }
+
+        if (prefix(argv[i], "-b"))
+        {
+            char *reps;
+
+            my_strcpy(test_bench, &argv[i][2], sizeof(test_bench));
+            reps = strchr(test_bench, ',');
+            if (reps)
+            {
+                test_bench_reps = atoi(reps + 1);
+                *reps = '\0';
+            }
+            continue;
+        }
+
+        if (prefix(argv[i], "-r"))
+        {
+            arg_reference = TRUE;
+            continue;
+        }
+
+        if (prefix(argv[i], "-v"))
+        {
+            test_verifying = TRUE;
+            continue;
+        }
+
+        if (prefix(argv[i], "-d"))
+        {
+            test_dump = TRUE;
+            continue;
+        }
+
+        plog_fmt("Ignoring option: %s", argv[i]);
+    }
+
+    /* Default script: rest */
+    if (!test_keys_n)
+    {
+        char keys[80];
+
+        text_to_ascii(keys, "\\s\\e\\e\\eR9999\\r");
+        test_keys_n = strlen(keys);
+        C_MAKE(test_keys, test_keys_n, char);
+        C_COPY(test_keys, keys, test_keys_n, char);
+    }
+
+    /* Initialize the term */
+    term_init(t, 80, 27, 256);
+
+    /* Nothing to wait for */
+    t->never_bored = TRUE;
+    t->never_frosh = TRUE;
+
+    /* Erase with "white space" */
+    t->attr_blank = TERM_WHITE;
+    t->char_blank = ' ';
+
+    /* Set some hooks */
+    t->text_hook = Term_text_test;
+    t->wipe_hook = Term_wipe_test;
+    t->curs_hook = Term_curs_test;
+    t->xtra_hook = Term_xtra_test;
+
+    /* Activate it */
+    Term_activate(t);
+
+    /* Store */
+    angband_term[0] = t;
+    term_screen = t;
+
+    /* Success */
+    return (0);
+}
+
+#endif /* USE_TEST */
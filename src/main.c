@@ -588,6 +588,16 @@ int main(int argc, char *argv[])
 				puts("  -mvme    To use VME (VAX/ESA)");
 #endif /* USE_VME */
 
+#ifdef USE_TEST
+				puts("  -mtest   To use the headless benchmark driver");
+				puts("  --       Sub options");
+				puts("  -- -k<file> Replay keystrokes from <file>");
+				puts("  -- -n<num>  Stop after <num> game turns");
+				puts("  -- -s<num>  Seed the RNG of a new character");
+				puts("  -- -d       Dump the screen when done");
+				puts("  -- -g<min>,<max>,<reps>[,<workers>] Print level statistics as CSV");
+#endif /* USE_TEST */
+
 				/* Actually abort the process */
 				quit(NULL);
 			}
@@ -613,6 +623,19 @@ int main(int argc, char *argv[])
 
 
 
+#ifdef USE_TEST
+	/* Use the headless "main-test.c" support only when asked to */
+	if (!done && mstr && streq(mstr, "test"))
+	{
+		extern errr init_test(int, char**);
+		if (0 == init_test(argc, argv))
+		{
+			ANGBAND_SYS = "test";
+			done = TRUE;
+		}
+	}
+#endif
+
 #ifdef USE_XAW
 	/* Attempt to use the "main-xaw.c" support */
 	if (!done && (!mstr || (streq(mstr, "xaw"))))
@@ -148,7 +148,7 @@ static int _aura_dam_p(void)
 /*
  * Attack the player via physical attacks.
  */
-bool make_attack_normal(int m_idx)
+static bool _make_attack_normal(int m_idx)
 {
     monster_type *m_ptr = &m_list[m_idx];
 
@@ -2041,3 +2041,12 @@ bool make_attack_normal(int m_idx)
     /* Assume we attacked */
     return (TRUE);
 }
+
+bool make_attack_normal(int m_idx)
+{
+    int  stream = Rand_stream_set(RAND_STREAM_COMBAT);
+    bool result = _make_attack_normal(m_idx);
+
+    Rand_stream_set(stream);
+    return result;
+}
@@ -21,6 +21,84 @@
 #define GRINDNOISE 20
 #define CYBERNOISE 20
 
+/*
+ * Replace a distant goal with the first step of a path to it, so that
+ * monsters walk around walls rather than into them. The target need not
+ * be in view, so we use a shared flow field for the goal (see cave.c).
+ */
+static void _flow_towards(int m_idx, int *yp, int *xp)
+{
+    monster_type *m_ptr = &m_list[m_idx];
+    monster_race *r_ptr = &r_info[m_ptr->r_idx];
+    int           y, x;
+
+    /* Monster can go through rocks */
+    if ((r_ptr->flags2 & RF2_PASS_WALL) && ((m_idx != p_ptr->riding) || p_ptr->pass_wall)) return;
+    if ((r_ptr->flags2 & RF2_KILL_WALL) && (m_idx != p_ptr->riding)) return;
+
+    /* Adjacent goals are reached directly */
+    if (distance(m_ptr->fy, m_ptr->fx, *yp, *xp) <= 1) return;
+
+    if (flow_step(*yp, *xp, m_ptr->fy, m_ptr->fx, &y, &x))
+    {
+        (*yp) = y;
+        (*xp) = x;
+    }
+}
+
+/*
+ * Can the monster "m_idx" go after the monster "t_idx"?
+ */
+static bool _enemy_okay(int m_idx, int t_idx)
+{
+    monster_type *m_ptr = &m_list[m_idx];
+    monster_race *r_ptr = &r_info[m_ptr->r_idx];
+    monster_type *t_ptr = &m_list[t_idx];
+
+    /* The monster itself isn't a target */
+    if (t_ptr == m_ptr) return FALSE;
+
+    /* Paranoia -- Skip dead monsters */
+    if (!t_ptr->r_idx) return FALSE;
+
+    if (is_pet(m_ptr))
+    {
+        /* Hack -- only fight away from player */
+        if (p_ptr->pet_follow_distance < 0)
+        {
+            /* No fighting near player */
+            if (t_ptr->cdis <= (0 - p_ptr->pet_follow_distance))
+            {
+                return FALSE;
+            }
+        }
+        /* Hack -- no fighting away from player */
+        else if ((m_ptr->cdis < t_ptr->cdis) &&
+                    (t_ptr->cdis > p_ptr->pet_follow_distance))
+        {
+            return FALSE;
+        }
+
+        if (r_ptr->aaf < t_ptr->cdis) return FALSE;
+    }
+
+    /* Monster must be 'an enemy' */
+    if (!are_enemies(m_ptr, t_ptr)) return FALSE;
+
+    /* Monster must be projectable if we can't pass through walls */
+    if (((r_ptr->flags2 & RF2_PASS_WALL) && ((m_idx != p_ptr->riding) || p_ptr->pass_wall)) ||
+        ((r_ptr->flags2 & RF2_KILL_WALL) && (m_idx != p_ptr->riding)))
+    {
+        if (!in_disintegration_range(m_ptr->fy, m_ptr->fx, t_ptr->fy, t_ptr->fx)) return FALSE;
+    }
+    else
+    {
+        if (!projectable(m_ptr->fy, m_ptr->fx, t_ptr->fy, t_ptr->fx)) return FALSE;
+    }
+
+    return TRUE;
+}
+
 /*
  * Calculate the direction to the next enemy
  */
@@ -28,90 +106,73 @@ static bool get_enemy_dir(int m_idx, int *mm)
 {
     int i;
     int x = 0, y = 0;
-    int t_idx;
     int start;
     int plus = 1;
 
     monster_type *m_ptr = &m_list[m_idx];
     monster_race *r_ptr = &r_info[m_ptr->r_idx];
 
-    monster_type *t_ptr;
-
     if (riding_t_m_idx && player_bold(m_ptr->fy, m_ptr->fx))
     {
         y = m_list[riding_t_m_idx].fy;
         x = m_list[riding_t_m_idx].fx;
+        _flow_towards(m_idx, &y, &x);
     }
     else if (is_pet(m_ptr) && pet_t_m_idx)
     {
         y = m_list[pet_t_m_idx].fy;
         x = m_list[pet_t_m_idx].fx;
+        _flow_towards(m_idx, &y, &x);
     }
     else
     {
-        if (p_ptr->inside_battle)
-        {
-            start = randint1(m_max-1)+m_max;
-            if(randint0(2)) plus = -1;
-        }
-        else start = m_max + 1;
+        bool tunnel = ((r_ptr->flags2 & RF2_PASS_WALL) && ((m_idx != p_ptr->riding) || p_ptr->pass_wall)) ||
+                      ((r_ptr->flags2 & RF2_KILL_WALL) && (m_idx != p_ptr->riding));
 
-        /* Scan thru all monsters */
-        for (i = start; ((i < start + m_max) && (i > start - m_max)); i+=plus)
+        /* Targets we need a bolt to reach are nearby, so look only there */
+        if (!p_ptr->inside_battle && !tunnel && !project_length)
         {
-            int dummy = (i % m_max);
-
-            if (!dummy) continue;
-
-            t_idx = dummy;
-            t_ptr = &m_list[t_idx];
-
-            /* The monster itself isn't a target */
-            if (t_ptr == m_ptr) continue;
+            static s16b *who = NULL;
+            int          n;
 
-            /* Paranoia -- Skip dead monsters */
-            if (!t_ptr->r_idx) continue;
-
-            if (is_pet(m_ptr))
+            /* Scratch list, made once and kept (this is called a lot) */
+            if (!who) C_MAKE(who, max_m_idx, s16b);
+            n = mon_in_rect(m_ptr->fy - MAX_RANGE, m_ptr->fx - MAX_RANGE,
+                            m_ptr->fy + MAX_RANGE, m_ptr->fx + MAX_RANGE, who);
+            for (i = 0; i < n; i++)
             {
-                /* Hack -- only fight away from player */
-                if (p_ptr->pet_follow_distance < 0)
-                {
-                    /* No fighting near player */
-                    if (t_ptr->cdis <= (0 - p_ptr->pet_follow_distance))
-                    {
-                        continue;
-                    }
-                }
-                /* Hack -- no fighting away from player */
-                else if ((m_ptr->cdis < t_ptr->cdis) &&
-                            (t_ptr->cdis > p_ptr->pet_follow_distance))
-                {
-                    continue;
-                }
-
-                if (r_ptr->aaf < t_ptr->cdis) continue;
-            }
+                if (!_enemy_okay(m_idx, who[i])) continue;
 
-            /* Monster must be 'an enemy' */
-            if (!are_enemies(m_ptr, t_ptr)) continue;
+                /* OK -- we've got a target */
+                y = m_list[who[i]].fy;
+                x = m_list[who[i]].fx;
 
-            /* Monster must be projectable if we can't pass through walls */
-            if (((r_ptr->flags2 & RF2_PASS_WALL) && ((m_idx != p_ptr->riding) || p_ptr->pass_wall)) ||
-                ((r_ptr->flags2 & RF2_KILL_WALL) && (m_idx != p_ptr->riding)))
-            {
-                if (!in_disintegration_range(m_ptr->fy, m_ptr->fx, t_ptr->fy, t_ptr->fx)) continue;
+                break;
             }
-            else
+        }
+        else
+        {
+            if (p_ptr->inside_battle)
             {
-                if (!projectable(m_ptr->fy, m_ptr->fx, t_ptr->fy, t_ptr->fx)) continue;
+                start = randint1(m_max-1)+m_max;
+                if(randint0(2)) plus = -1;
             }
+            else start = m_max + 1;
 
-            /* OK -- we've got a target */
-            y = t_ptr->fy;
-            x = t_ptr->fx;
+            /* Scan thru all monsters */
+            for (i = start; ((i < start + m_max) && (i > start - m_max)); i+=plus)
+            {
+                int dummy = (i % m_max);
 
-            break;
+                if (!dummy) continue;
+                if (!_enemy_okay(m_idx, dummy)) continue;
+
+                /* OK -- we've got a target */
+                y = m_list[dummy].fy;
+                x = m_list[dummy].fx;
+
+                break;
+            }
         }
         if (!x && !y) return FALSE;
     }
@@ -698,6 +759,12 @@ static bool get_fear_moves_aux(int m_idx, int *yp, int *xp)
     int i;
 
     monster_type *m_ptr = &m_list[m_idx];
+    monster_race *r_ptr = &r_info[m_ptr->r_idx];
+    bool          walk = TRUE;
+
+    /* Monster can go through rocks */
+    if ((r_ptr->flags2 & RF2_PASS_WALL) && ((m_idx != p_ptr->riding) || p_ptr->pass_wall)) walk = FALSE;
+    if ((r_ptr->flags2 & RF2_KILL_WALL) && (m_idx != p_ptr->riding)) walk = FALSE;
 
     /* Monster location */
     fy = m_ptr->fy;
@@ -722,8 +789,14 @@ static bool get_fear_moves_aux(int m_idx, int *yp, int *xp)
         /* Don't move toward player */
         /* if (cave[y][x].dist < 3) continue; */ /* Hmm.. Need it? */
 
-        /* Calculate distance of this grid from our destination */
-        dis = distance(y, x, y1, x1);
+        /* Calculate distance of this grid from our destination, walking
+           around walls (the field is shared with everyone fleeing there) */
+        if (walk)
+        {
+            dis = flow_distance(y1, x1, y, x);
+            if (dis < 0) continue;
+        }
+        else dis = distance(y, x, y1, x1);
 
         /* Score this grid */
         s = 5000 / (dis + 3) - 500 / (cave[y][x].dist + 1);
@@ -1043,6 +1116,9 @@ static bool find_hiding(int m_idx, int *yp, int *xp)
         /* Check for success */
         if (gdis < 999)
         {
+            /* Walk around walls on the way */
+            _flow_towards(m_idx, &gy, &gx);
+
             /* Good location */
             (*yp) = fy - gy;
             (*xp) = fx - gx;
@@ -1180,8 +1256,11 @@ static bool get_moves(int m_idx, int *mm)
           && m_ptr->cdis > 3    /* abandon guarding if the player gets close ... */
           && !m_ptr->anger_ct ) /* ... or if we get ticked off. */
         {
-            x = m_ptr->fx - pack_ptr->guard_x;
-            y = m_ptr->fy - pack_ptr->guard_y;
+            y2 = pack_ptr->guard_y;
+            x2 = pack_ptr->guard_x;
+            _flow_towards(m_idx, &y2, &x2);
+            x = m_ptr->fx - x2;
+            y = m_ptr->fy - y2;
             done = TRUE;
         }
 
@@ -1193,8 +1272,11 @@ static bool get_moves(int m_idx, int *mm)
             else if ( m_idx != pack_ptr->guard_idx
                    && m_ptr->cdis > 3 )
             {
-                x = m_ptr->fx - m_ptr2->fx;
-                y = m_ptr->fy - m_ptr2->fy;
+                y2 = m_ptr2->fy;
+                x2 = m_ptr2->fx;
+                _flow_towards(m_idx, &y2, &x2);
+                x = m_ptr->fx - x2;
+                y = m_ptr->fy - y2;
                 done = TRUE;
             }
         }
@@ -3390,7 +3472,7 @@ static void process_monster(int m_idx)
             if (!is_riding_mon)
             {
                 /* Hack -- Update the old location */
-                cave[oy][ox].m_idx = c_ptr->m_idx;
+                cave_set_m_idx(oy, ox, c_ptr->m_idx);
 
                 /* Mega-Hack -- move the old monster, if any */
                 if (c_ptr->m_idx)
@@ -3404,7 +3486,7 @@ static void process_monster(int m_idx)
                 }
 
                 /* Hack -- Update the new location */
-                c_ptr->m_idx = m_idx;
+                cave_set_m_idx(ny, nx, m_idx);
 
                 /* Move the monster */
                 m_ptr->fy = ny;
@@ -3689,6 +3771,81 @@ static void process_monster(int m_idx)
     }
 }
 
+/*
+ * Monster scheduling.
+ *
+ * A monster only gains energy on game turns when it can sense the player
+ * (see below), and on a large level most monsters spend almost every game
+ * turn out of range. Rather than re-testing every slot each game turn, we
+ * mark such monsters "idle" in the "m_idle" bitmap and skip them (a whole
+ * word at a time) until something they depend on changes.
+ *
+ * A monster is only marked idle when "process_monsters()" could not do
+ * anything to it until it or the player moves: it is not fresh, is already
+ * aware, is not giving up on flow, has no counter attack target, and is
+ * beyond both MAX_SIGHT and its largest possible sensing radius (so line
+ * of sight and aggravation don't matter). Such a monster gains no energy,
+ * so skipping it leaves turn order exactly as it was.
+ *
+ * "update_mon()" wakes an idle monster once its distance comes in range,
+ * and anything else that changes the above (targets, new races, reused or
+ * moved slots) must call "mon_sched_wake()".
+ *
+ * With "arg_reference" (see main-test.c), nothing is ever idle, so every
+ * monster is tested every game turn as it used to be.
+ */
+#define _IDLE_BIT(I) (1UL << ((I) & 31))
+
+static bool _mon_can_idle(monster_type *m_ptr, bool surface)
+{
+    int radius = r_info[m_ptr->r_idx].aaf;
+
+    /* Largest sensing radius process_monsters() might use for an aware monster */
+    if (surface) radius *= 3;
+
+    if (arg_reference) return FALSE;
+    if (m_ptr->mflag & MFLAG_BORN) return FALSE;
+    if (!is_aware(m_ptr)) return FALSE;
+    if (m_ptr->mflag2 & MFLAG2_NOFLOW) return FALSE;
+    if (m_ptr->target_y) return FALSE;
+    if (m_ptr->cdis <= MAX_SIGHT || m_ptr->cdis <= radius) return FALSE;
+    return TRUE;
+}
+
+void mon_sched_wake(int m_idx)
+{
+    m_idle[m_idx >> 5] &= ~_IDLE_BIT(m_idx);
+}
+
+void mon_sched_update(int m_idx)
+{
+    if (!(m_idle[m_idx >> 5] & _IDLE_BIT(m_idx))) return;
+    if (!_mon_can_idle(&m_list[m_idx], py_on_surface()))
+        mon_sched_wake(m_idx);
+}
+
+void mon_sched_wipe(void)
+{
+    C_WIPE(m_idle, (max_m_idx + 31) / 32, u32b);
+}
+
+/*
+ * Count the idle monsters that process_monsters() should no longer skip
+ * (for debugging)
+ */
+int mon_sched_verify(void)
+{
+    bool surface = py_on_surface();
+    int  i, bad = 0;
+
+    for (i = 1; i < max_m_idx; i++)
+    {
+        if (!(m_idle[i >> 5] & _IDLE_BIT(i)) || !m_list[i].r_idx) continue;
+        if (!_mon_can_idle(&m_list[i], surface)) bad++;
+    }
+    return bad;
+}
+
 /*
  * Process all the "live" monsters, once per game turn.
  *
@@ -3733,13 +3890,24 @@ void process_monsters(void)
 
     int speed;
 
+    bool            surface = py_on_surface();
+    int             stream = Rand_stream_set(RAND_STREAM_AI);
+
     /* Clear monster fighting indicator */
     mon_fight = FALSE;
 
     /* Process the monsters (backwards) */
-    for (i = m_max - 1; i >= 1; i--)
+    for_each_live_mon_back(i)
     {
         int radius = 0;
+        u32b idle = m_idle[i >> 5];
+
+        /* Skip idle monsters (a whole word at once, if possible) */
+        if (idle & _IDLE_BIT(i))
+        {
+            if (idle == 0xFFFFFFFFUL) i &= ~31;
+            continue;
+        }
 
         /* Access the monster */
         m_ptr = &m_list[i];
@@ -3768,9 +3936,10 @@ void process_monsters(void)
         {
             if (m_ptr->cdis >= AAF_LIMIT_RING) continue;
         }
-        else
+        else if (m_ptr->cdis >= AAF_LIMIT)
         {
-            if (m_ptr->cdis >= AAF_LIMIT) continue;
+            if (_mon_can_idle(m_ptr, surface)) m_idle[i >> 5] |= _IDLE_BIT(i);
+            continue;
         }
 
         /* Access the location */
@@ -3810,7 +3979,7 @@ void process_monsters(void)
             /* Lure a potential ring bearer, no matter how distant */
             radius = AAF_LIMIT_RING;
         }
-        else if (py_on_surface())
+        else if (surface)
             radius *= 3;
 
         if (m_ptr->cdis <= radius)
@@ -3831,7 +4000,10 @@ void process_monsters(void)
 
         /* Do nothing */
         if (!test)
+        {
+            if (_mon_can_idle(m_ptr, surface)) m_idle[i >> 5] |= _IDLE_BIT(i);
             continue;
+        }
 
 
         if (p_ptr->riding == i)
@@ -3907,6 +4079,8 @@ void process_monsters(void)
     /* Reset global index */
     hack_m_idx = 0;
     hack_m_spell = 0;
+
+    Rand_stream_set(stream);
 }
 
 
@@ -3949,7 +4123,7 @@ void mproc_init(void)
     for (cmi = 0; cmi < MAX_MTIMED; cmi++) mproc_max[cmi] = 0;
 
     /* Process the monsters (backwards) */
-    for (i = m_max - 1; i >= 1; i--)
+    for_each_live_mon_back(i)
     {
         /* Access the monster */
         m_ptr = &m_list[i];
@@ -4673,6 +4847,7 @@ void monster_gain_exp(int m_idx, int s_idx)
 
         monster_desc(m_name, m_ptr, 0);
         m_ptr->r_idx = r_ptr->next_r_idx;
+        mon_sched_wake(m_idx);
 
         /* Count the monsters on the level */
         real_r_ptr(m_ptr)->cur_num++;
@@ -294,6 +294,7 @@ static void msg_line_flush(void)
     {
         doc_insert_text(_msg_line_doc, TERM_L_BLUE, "-more-");
         msg_line_sync();
+        lite_spot_flush();
 
         for(;;)
         {
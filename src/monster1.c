@@ -603,10 +603,117 @@ void anger_monster(monster_type *m_ptr)
 }
 
 
+/*
+ * Terrain passability by movement class. The class of a race is the few
+ * flags that decide where it may go (see _move_class()); the table has a
+ * bit for each class and feature, giving the answer for a plain monster
+ * (not ridden, not the player's mimicry), so most checks are one lookup.
+ * Code that changes those flags of a race during play must call
+ * mon_move_update() on it.
+ */
+#define _MOVE_CLASSES 256
+
+static u32b *_move_table = NULL;
+static int   _move_words = 0;
+
+static int _move_class(monster_race *r_ptr)
+{
+    return ((r_ptr->flags7 & RF7_CAN_FLY) ? 0x01 : 0) |
+           ((r_ptr->flags7 & RF7_CAN_CLIMB) ? 0x02 : 0) |
+           ((r_ptr->flags7 & RF7_CAN_SWIM) ? 0x04 : 0) |
+           ((r_ptr->flags7 & RF7_AQUATIC) ? 0x08 : 0) |
+           ((r_ptr->flags2 & RF2_PASS_WALL) ? 0x10 : 0) |
+           ((r_ptr->flags2 & RF2_AURA_FIRE) ? 0x20 : 0) |
+           ((r_ptr->flags8 & RF8_WILD_MOUNTAIN) ? 0x40 : 0) |
+           ((r_ptr->flagsr & RFR_EFF_IM_FIRE_MASK) ? 0x80 : 0);
+}
+
+static bool _monster_can_cross_terrain_aux(s16b feat, monster_race *r_ptr, u16b mode);
+
+void mon_move_update(monster_race *r_ptr)
+{
+    r_ptr->move_class = _move_class(r_ptr);
+}
+
+/*
+ * Fill in the table, asking _monster_can_cross_terrain_aux() about a
+ * race with just the flags of each class (after f_info is loaded)
+ */
+void mon_move_init(void)
+{
+    monster_race race;
+    int          c, feat;
+
+    if (_move_table) C_KILL(_move_table, _MOVE_CLASSES * _move_words, u32b);
+    _move_words = (max_f_idx + 31) / 32;
+    C_MAKE(_move_table, _MOVE_CLASSES * _move_words, u32b);
+
+    for (c = 0; c < _MOVE_CLASSES; c++)
+    {
+        u32b *bits = &_move_table[c * _move_words];
+
+        WIPE(&race, monster_race);
+        if (c & 0x01) race.flags7 |= RF7_CAN_FLY;
+        if (c & 0x02) race.flags7 |= RF7_CAN_CLIMB;
+        if (c & 0x04) race.flags7 |= RF7_CAN_SWIM;
+        if (c & 0x08) race.flags7 |= RF7_AQUATIC;
+        if (c & 0x10) race.flags2 |= RF2_PASS_WALL;
+        if (c & 0x20) race.flags2 |= RF2_AURA_FIRE;
+        if (c & 0x40) race.flags8 |= RF8_WILD_MOUNTAIN;
+        if (c & 0x80) race.flagsr |= RFR_IM_FIRE;
+
+        for (feat = 0; feat < max_f_idx; feat++)
+        {
+            if (_monster_can_cross_terrain_aux(feat, &race, 0))
+                bits[feat >> 5] |= 1UL << (feat & 31);
+        }
+    }
+
+    for (c = 1; c < max_r_idx; c++) mon_move_update(&r_info[c]);
+}
+
+/*
+ * Count the races and features where the table is wrong, and the races
+ * whose class is out of date (for debugging)
+ */
+int mon_move_verify(void)
+{
+    int r_idx, feat, bad = 0;
+
+    for (r_idx = 1; r_idx < max_r_idx; r_idx++)
+    {
+        monster_race *r_ptr = &r_info[r_idx];
+        int           c = r_ptr->move_class;
+
+        if (!r_ptr->name) continue;
+        if (c != _move_class(r_ptr)) bad++;
+
+        for (feat = 0; feat < max_f_idx; feat++)
+        {
+            bool table = (_move_table[c * _move_words + (feat >> 5)] >> (feat & 31)) & 1;
+
+            if (table != _monster_can_cross_terrain_aux(feat, r_ptr, 0)) bad++;
+        }
+    }
+    return bad;
+}
+
 /*
  * Check if monster can cross terrain
  */
 bool monster_can_cross_terrain(s16b feat, monster_race *r_ptr, u16b mode)
+{
+    if (!mode && _move_table)
+    {
+        mon_move_hits++;
+        return (_move_table[r_ptr->move_class * _move_words + (feat >> 5)] >> (feat & 31)) & 1;
+    }
+
+    mon_move_misses++;
+    return _monster_can_cross_terrain_aux(feat, r_ptr, mode);
+}
+
+static bool _monster_can_cross_terrain_aux(s16b feat, monster_race *r_ptr, u16b mode)
 {
     feature_type *f_ptr = &f_info[feat];
     bool          lev = FALSE;
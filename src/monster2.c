@@ -18,6 +18,9 @@
 #define HORDE_NOGOOD 0x01
 #define HORDE_NOEVIL 0x02
 
+/* The bit of a monster in "m_live" */
+#define _LIVE_BIT(I) (1UL << ((I) & 31))
+
 cptr horror_desc[MAX_SAN_HORROR] =
 {
     "abominable",
@@ -123,6 +126,7 @@ void set_target(monster_type *m_ptr, int y, int x)
 {
     m_ptr->target_y = y;
     m_ptr->target_x = x;
+    mon_sched_wake(m_ptr - m_list);
 }
 
 
@@ -222,7 +226,7 @@ void delete_monster_idx(int i)
     if (p_ptr->riding == i) p_ptr->riding = 0;
 
     /* Monster is gone */
-    cave[y][x].m_idx = 0;
+    cave_set_m_idx(y, x, 0);
 
 
     /* Delete objects */
@@ -252,6 +256,11 @@ void delete_monster_idx(int i)
     /* Wipe the Monster */
     (void)WIPE(m_ptr, monster_type);
 
+    /* Recycle the slot */
+    m_ptr->next_m_idx = m_free_list;
+    m_free_list = i;
+    m_live[i >> 5] &= ~_LIVE_BIT(i);
+
     /* Count monsters */
     m_cnt--;
 
@@ -381,9 +390,12 @@ static void compact_monsters_aux(int i1, int i2)
 
     /* Structure copy */
     COPY(&m_list[i2], &m_list[i1], monster_type);
+    mon_sched_wake(i2);
+    m_live[i2 >> 5] |= _LIVE_BIT(i2);
 
     /* Wipe the hole */
     (void)WIPE(&m_list[i1], monster_type);
+    m_live[i1 >> 5] &= ~_LIVE_BIT(i1);
 
     for (i = 0; i < MAX_MTIMED; i++)
     {
@@ -424,7 +436,7 @@ void compact_monsters(int size)
         cur_dis = 5 * (20 - cnt);
 
         /* Check all the monsters */
-        for (i = 1; i < m_max; i++)
+        for_each_live_mon(i)
         {
             monster_type *m_ptr = &m_list[i];
 
@@ -477,6 +489,9 @@ void compact_monsters(int size)
         /* Compress "m_max" */
         m_max--;
     }
+
+    /* There are no holes left */
+    m_free_list = 0;
 }
 
 
@@ -529,7 +544,7 @@ void wipe_m_list(void)
         if (!m_ptr->r_idx) continue;
 
         /* Monster is gone */
-        cave[m_ptr->fy][m_ptr->fx].m_idx = 0;
+        cave_set_m_idx(m_ptr->fy, m_ptr->fx, 0);
 
         /* Wipe the Monster */
         (void)WIPE(m_ptr, monster_type);
@@ -550,10 +565,14 @@ void wipe_m_list(void)
 
     /* Reset "m_cnt" */
     m_cnt = 0;
+    m_free_list = 0;
 
     /* Reset "mproc_max[]" */
     for (i = 0; i < MAX_MTIMED; i++) mproc_max[i] = 0;
 
+    mon_sched_wipe();
+    C_WIPE(m_live, (max_m_idx + 31) / 32, u32b);
+
     /* Hack -- reset "reproducer" count */
     num_repro = 0;
     num_repro_kill = 0;
@@ -811,12 +830,36 @@ pack_info_t *pack_info_ptr(int m_idx)
 /*
  * Acquires and returns the index of a "free" monster.
  *
+ * Dead monsters below "m_max" are chained through "next_m_idx", starting
+ * at "m_free_list" (delete_monster_idx() pushes, we pop), so holes are
+ * reused at once rather than found by a scan when the list is full.
+ * Anything that moves monsters around or kills them wholesale just
+ * empties the list.
+ *
  * This routine should almost never fail, but it *can* happen.
  */
 s16b m_pop(void)
 {
     int i;
 
+    /* Recycle a dead monster */
+    if (m_free_list)
+    {
+        i = m_free_list;
+
+        /* Paranoia -- forget a list that has gone stale */
+        if (i >= m_max || m_list[i].r_idx)
+            m_free_list = 0;
+        else
+        {
+            m_free_list = m_list[i].next_m_idx;
+            m_cnt++;
+            WIPE(&m_list[i], monster_type);
+            mon_sched_wake(i);
+            m_live[i >> 5] |= _LIVE_BIT(i);
+            return (i);
+        }
+    }
 
     /* Normal allocation */
     if (m_max < max_m_idx)
@@ -825,9 +868,11 @@ s16b m_pop(void)
         m_max++;
         m_cnt++;
         WIPE(&m_list[i], monster_type);
+        mon_sched_wake(i);
+        m_live[i >> 5] |= _LIVE_BIT(i);
         return (i);
     }
-    /* Recycle dead monsters */
+    /* Recycle dead monsters the list lost track of */
     for (i = 1; i < m_max; i++)
     {
         monster_type *m_ptr;
@@ -835,6 +880,8 @@ s16b m_pop(void)
         if (m_ptr->r_idx) continue;
         m_cnt++;
         WIPE(m_ptr, monster_type);
+        mon_sched_wake(i);
+        m_live[i >> 5] |= _LIVE_BIT(i);
         return (i);
     }
 
@@ -850,6 +897,112 @@ s16b m_pop(void)
 
 
 
+/*
+ * Find the next live monster after "m_idx" (or 0 if there are no more),
+ * passing over a whole word of "m_live" at a time where it is empty.
+ * See for_each_live_mon(). With "arg_reference", step through m_list
+ * instead, as the sweeps used to.
+ */
+int mon_live_next(int m_idx)
+{
+    int  i = m_idx + 1;
+    u32b bits;
+
+    if (arg_reference)
+    {
+        for (; i < m_max; i++)
+            if (m_list[i].r_idx) return i;
+        return 0;
+    }
+
+    if (i >= m_max) return 0;
+
+    bits = m_live[i >> 5] & ~(_LIVE_BIT(i) - 1);
+    while (!bits)
+    {
+        i = (i | 31) + 1;
+        if (i >= m_max) return 0;
+        bits = m_live[i >> 5];
+    }
+
+    i &= ~31;
+    while (!(bits & 1))
+    {
+        bits >>= 1;
+        i++;
+    }
+    return (i < m_max) ? i : 0;
+}
+
+/*
+ * Find the last live monster before "m_idx" (or 0 if there are none)
+ */
+int mon_live_prev(int m_idx)
+{
+    int  i = MIN(m_idx, m_max) - 1;
+    u32b bits;
+
+    if (arg_reference)
+    {
+        for (; i >= 1; i--)
+            if (m_list[i].r_idx) return i;
+        return 0;
+    }
+
+    if (i < 1) return 0;
+
+    bits = m_live[i >> 5] & (_LIVE_BIT(i) | (_LIVE_BIT(i) - 1));
+    while (!bits)
+    {
+        i = (i & ~31) - 1;
+        if (i < 1) return 0;
+        bits = m_live[i >> 5];
+    }
+
+    i |= 31;
+    while (!(bits & 0x80000000UL))
+    {
+        bits <<= 1;
+        i--;
+    }
+    return i;
+}
+
+/*
+ * Debug -- check "m_live" against m_list, and both sweeps against a plain
+ * scan. Returns the number of disagreements (which should always be zero).
+ */
+int mon_live_verify(void)
+{
+    int i, j, bad = 0;
+
+    for (i = 1; i < max_m_idx; i++)
+    {
+        bool live = (m_live[i >> 5] & _LIVE_BIT(i)) != 0;
+
+        if (live != (i < m_max && m_list[i].r_idx != 0)) bad++;
+    }
+
+    for (i = 0, j = 0; ; i = j)
+    {
+        j = mon_live_next(i);
+        for (i++; i < m_max && !m_list[i].r_idx; i++) /* nothing */;
+        if (j != (i < m_max ? i : 0)) bad++;
+        if (!j) break;
+    }
+
+    for (i = m_max, j = 0; ; i = j)
+    {
+        j = mon_live_prev(i);
+        for (i--; i >= 1 && !m_list[i].r_idx; i--) /* nothing */;
+        if (j != (i >= 1 ? i : 0)) bad++;
+        if (!j) break;
+    }
+
+    return bad;
+}
+
+
 /*
  * Hack -- the "type" of the current "summon specific"
  */
@@ -1399,15 +1552,68 @@ static bool restrict_monster_to_dungeon(int r_idx)
     return TRUE;
 }
 
+/*
+ * Set prob2 for one entry of the "monster allocation table"
+ */
+static void _mon_num_prep_aux(alloc_entry *entry)
+{
+    monster_race *r_ptr = &r_info[entry->index];
+
+    entry->prob2 = 0;
+
+    /* Skip monsters which don't pass the restriction */
+    if ((get_mon_num_hook && !((*get_mon_num_hook)(entry->index))) ||
+        (get_mon_num2_hook && !((*get_mon_num2_hook)(entry->index))))
+        return;
+
+    if (!p_ptr->inside_battle && !chameleon_change_m_idx &&
+        summon_specific_type != SUMMON_GUARDIAN)
+    {
+        /* Hack -- don't create (unique) questors or suppressed uniques */
+        if (r_ptr->flagsx & (RFX_QUESTOR | RFX_SUPPRESS))
+            return;
+
+        if ((r_ptr->flags7 & RF7_GUARDIAN) && !no_wilderness)
+            return;
+
+        /* Depth Monsters never appear out of depth */
+        if ((r_ptr->flags1 & (RF1_FORCE_DEPTH)) &&
+            (r_ptr->level > dun_level))
+            return;
+    }
+
+    /* Some builds can't even equip a poison needle, so this is unfair! */
+    if (entry->index == MON_THE_METAL_BABBLE) return;
+
+    /* Accept this monster */
+    entry->prob2 = entry->prob1;
+
+    if (py_in_dungeon() && !restrict_monster_to_dungeon(entry->index))
+    {
+        int hoge = entry->prob2 * d_info[dungeon_type].special_div;
+        entry->prob2 = hoge / 64;
+        if (randint0(64) < (hoge & 0x3f)) entry->prob2++;
+    }
+}
+
+/*
+ * Set when the last prep rounded some weights at random (see above), so
+ * that the table is unlikely ever to come up again
+ */
+static bool _mon_num_prep_rolled = FALSE;
+
 /*
  * Apply a "monster restriction function" to the "monster allocation table"
+ *
+ * The result is hashed into alloc_race_stamp, so that get_mon_num() can
+ * quickly tell a table it has not seen before (see _mon_alloc_cache()).
  */
 errr get_mon_num_prep(monster_hook_type monster_hook,
                       monster_hook_type monster_hook2)
 {
     int i;
-
-    /* Todo: Check the hooks for non-changes */
+    u32b stamp = 2166136261UL;
+    bool rolled = py_in_dungeon() && (d_info[dungeon_type].special_div & 0x3f);
 
     /* Set the new hooks */
     get_mon_num_hook = monster_hook;
@@ -1416,48 +1622,15 @@ errr get_mon_num_prep(monster_hook_type monster_hook,
     /* Scan the allocation table */
     for (i = 0; i < alloc_race_size; i++)
     {
-        monster_race    *r_ptr;
-
-        /* Get the entry */
         alloc_entry *entry = &alloc_race_table[i];
 
-        entry->prob2 = 0;
-        r_ptr = &r_info[entry->index];
-
-        /* Skip monsters which don't pass the restriction */
-        if ((get_mon_num_hook && !((*get_mon_num_hook)(entry->index))) ||
-            (get_mon_num2_hook && !((*get_mon_num2_hook)(entry->index))))
-            continue;
-
-        if (!p_ptr->inside_battle && !chameleon_change_m_idx &&
-            summon_specific_type != SUMMON_GUARDIAN)
-        {
-            /* Hack -- don't create (unique) questors or suppressed uniques */
-            if (r_ptr->flagsx & (RFX_QUESTOR | RFX_SUPPRESS))
-                continue;
-
-            if ((r_ptr->flags7 & RF7_GUARDIAN) && !no_wilderness)
-                continue;
-
-            /* Depth Monsters never appear out of depth */
-            if ((r_ptr->flags1 & (RF1_FORCE_DEPTH)) &&
-                (r_ptr->level > dun_level))
-                continue;
-        }
-
-        /* Some builds can't even equip a poison needle, so this is unfair! */
-        if (entry->index == MON_THE_METAL_BABBLE) continue;
-
-        /* Accept this monster */
-        entry->prob2 = entry->prob1;
+        _mon_num_prep_aux(entry);
 
-        if (py_in_dungeon() && !restrict_monster_to_dungeon(entry->index))
-        {
-            int hoge = entry->prob2 * d_info[dungeon_type].special_div;
-            entry->prob2 = hoge / 64;
-            if (randint0(64) < (hoge & 0x3f)) entry->prob2++;
-        }
+        /* FNV-1a */
+        stamp = (stamp ^ (u32b)entry->prob2) * 16777619UL;
     }
+    alloc_race_stamp = stamp;
+    _mon_num_prep_rolled = rolled;
 
     /* Success */
     return (0);
@@ -1501,13 +1674,276 @@ static int mysqrt(int n)
     return kaeriti;
 }
 
+static bool _ignore_depth_hack = FALSE;
+
+/*
+ * Running totals of the "monster allocation table" for get_mon_num().
+ *
+ * Most of what decides whether a race may be picked only changes when the
+ * table is prepped or the player changes levels, so get_mon_num() keeps
+ * the running sum of those weights for the last few levels asked for and
+ * picks from it with a binary search. The rest (uniques that are already
+ * alive and so on) depends on the monsters on the level, and is checked
+ * only for the race that was picked, drawing again if it fails. This picks
+ * each allowed race with the same odds as summing the allowed weights
+ * afresh on every call.
+ *
+ * A slot is only reused if its copy of the prepped weights still matches
+ * the table (the stamp just saves comparing them most of the time). A
+ * table with randomly rounded weights (special_div dungeons) goes into a
+ * slot of its own, so as not to push the others out.
+ */
+#define _MON_ALLOC_SLOTS 8
+#define _MON_ALLOC_TRIES 64
+
+typedef struct {
+    u32b  stamp;
+    int   level;
+    int   min_level;
+    int   dungeon;
+    byte  flags;
+    int   n;
+    s32b *total;
+    byte *prob2;
+} _mon_alloc_t, *_mon_alloc_ptr;
+
+#define _MON_ALLOC_IGNORE_DEPTH 0x01
+#define _MON_ALLOC_QUEST        0x02
+#define _MON_ALLOC_NO_WILD      0x04
+
+static _mon_alloc_t _mon_alloc[_MON_ALLOC_SLOTS + 1];
+static int _mon_alloc_next = 0;
+
+static bool _mon_alloc_match(_mon_alloc_ptr cache)
+{
+    int i;
+
+    if (cache->stamp != alloc_race_stamp) return FALSE;
+    for (i = 0; i < cache->n; i++)
+    {
+        if (cache->prob2[i] != alloc_race_table[i].prob2) return FALSE;
+    }
+    return TRUE;
+}
+
+/* The part of the weight that only depends on the cache key */
+static int _mon_alloc_prob(alloc_entry *entry, _mon_alloc_ptr cache)
+{
+    monster_race *r_ptr = &r_info[entry->index];
+    int           prob = entry->prob2;
+
+    if (!prob) return 0;
+    if (!(cache->flags & _MON_ALLOC_IGNORE_DEPTH) && entry->max_level < cache->level) return 0;
+    if (entry->level < cache->min_level) return 0;
+
+    /* Hack: Camelot monsters only appear in Camelot. Olympians in Mt Olympus. Southerings in the Stronghold */
+    if (!(cache->flags & _MON_ALLOC_NO_WILD))
+    {
+        if ((r_ptr->flags2 & RF2_CAMELOT) && cache->dungeon != DUNGEON_CAMELOT) return 0;
+        if ((r_ptr->flags2 & RF2_SOUTHERING) && cache->dungeon != DUNGEON_STRONGHOLD) return 0;
+        if ((r_ptr->flags3 & RF3_OLYMPIAN) && cache->dungeon != DUNGEON_OLYMPUS) return 0;
+    }
+    /* Hack: Some monsters are restricted from quests (e.g. Zeus in no_wilderness mode) */
+    if ((cache->flags & _MON_ALLOC_QUEST) && (r_ptr->flags1 & RF1_NO_QUEST)) return 0;
+
+    /* Hack: Undersized monsters become more rare ... but only for max_depth restricted monsters.
+       The goal is that these monsters gradually become less and less common, rather than suddenly
+       disappearing. About 50% of monsters currently have depth restrictions. */
+    if ( r_ptr->max_level != 999 /* <=== Remove this, and the end game becomes too difficult */
+      && cache->level > r_ptr->level + 9
+      && !(r_ptr->flags1 & RF1_UNIQUE) ) /* Redundant. Uniques never have depth restrictions. */
+    {
+        int delta = cache->level - r_ptr->level;
+        prob = prob >> (delta/10);
+        if (!prob)
+            prob = 1;
+    }
+    return prob;
+}
+
+/* The part that depends on the monsters currently alive */
+static bool _mon_alloc_okay(int r_idx, bool allow_unique)
+{
+    monster_race *r_ptr = &r_info[r_idx];
+
+    if (p_ptr->inside_battle || chameleon_change_m_idx) return TRUE;
+
+    /* Hack -- "unique" monsters must be "unique" */
+    if ( ((r_ptr->flags1 & RF1_UNIQUE) || (r_ptr->flags7 & RF7_NAZGUL) || (r_idx == MON_CAMELOT_KNIGHT))
+      && r_ptr->cur_num >= r_ptr->max_num)
+    {
+        /* Serpent can "resurrect" uniques, but not weak ones! */
+        if (!summon_cloned_okay || r_ptr->level < 70) return FALSE;
+    }
+
+    if ((r_ptr->flags1 & RF1_UNIQUE) && !allow_unique)
+        return FALSE;
+
+    if ((r_ptr->flags7 & (RF7_UNIQUE2)) &&
+        (r_ptr->cur_num >= 1))
+    {
+        return FALSE;
+    }
+
+    if (r_idx == MON_BANORLUPART)
+    {
+        if (r_info[MON_BANOR].cur_num > 0) return FALSE;
+        if (r_info[MON_LUPART].cur_num > 0) return FALSE;
+    }
+    return TRUE;
+}
+
+static _mon_alloc_ptr _mon_alloc_cache(int level)
+{
+    _mon_alloc_ptr cache;
+    int            min_level = 0;
+    byte           flags = 0;
+    int            i;
+    s32b           total;
+
+    if (!summon_specific_who && dungeon_type == DUNGEON_ARENA)
+        min_level = MIN(50, dun_level-5);
+
+    /* Hack: Sparing early unique monsters is no longer a viable end game strategy */
+    if (summon_specific_who && summon_specific_type == SUMMON_UNIQUE)
+    {
+        monster_type *who_ptr = &m_list[summon_specific_who];
+        int           who_lvl = r_info[who_ptr->r_idx].level;
+
+        if (who_lvl >= 50)
+            min_level = MAX(min_level, who_lvl - 40);
+    }
+
+    if (_ignore_depth_hack) flags |= _MON_ALLOC_IGNORE_DEPTH;
+    if (quests_get_current()) flags |= _MON_ALLOC_QUEST;
+    if (no_wilderness) flags |= _MON_ALLOC_NO_WILD;
+
+    for (i = 0; i <= _MON_ALLOC_SLOTS; i++)
+    {
+        cache = &_mon_alloc[i];
+        if ( cache->total
+          && cache->level == level
+          && cache->min_level == min_level
+          && cache->dungeon == dungeon_type
+          && cache->flags == flags
+          && _mon_alloc_match(cache) )
+        {
+            return cache;
+        }
+    }
+
+    /* Replace the oldest (or the spare slot for a one-off table) */
+    if (_mon_num_prep_rolled)
+        cache = &_mon_alloc[_MON_ALLOC_SLOTS];
+    else
+    {
+        cache = &_mon_alloc[_mon_alloc_next];
+        _mon_alloc_next = (_mon_alloc_next + 1) % _MON_ALLOC_SLOTS;
+    }
+
+    if (!cache->total)
+    {
+        C_MAKE(cache->total, alloc_race_size, s32b);
+        C_MAKE(cache->prob2, alloc_race_size, byte);
+    }
+    cache->stamp = alloc_race_stamp;
+    cache->level = level;
+    cache->min_level = min_level;
+    cache->dungeon = dungeon_type;
+    cache->flags = flags;
+
+    total = 0;
+    for (i = 0; i < alloc_race_size; i++)
+    {
+        if (alloc_race_table[i].level > level) break; /* Monsters are sorted by depth */
+        total += _mon_alloc_prob(&alloc_race_table[i], cache);
+        cache->total[i] = total;
+        cache->prob2[i] = alloc_race_table[i].prob2;
+    }
+    cache->n = i;
+    return cache;
+}
+
+/*
+ * Debug -- sum the weights afresh for every slot that would be reused for
+ * the table as it stands, and compare. Returns the number of slots whose
+ * totals are wrong (which should always be zero).
+ */
+int mon_alloc_verify(void)
+{
+    int i, j, bad = 0;
+
+    for (i = 0; i <= _MON_ALLOC_SLOTS; i++)
+    {
+        _mon_alloc_ptr cache = &_mon_alloc[i];
+        s32b           total = 0;
+        bool           ok = TRUE;
+
+        if (!cache->total || !_mon_alloc_match(cache)) continue;
+
+        for (j = 0; j < alloc_race_size && alloc_race_table[j].level <= cache->level; j++)
+        {
+            total += _mon_alloc_prob(&alloc_race_table[j], cache);
+            if (j < cache->n && cache->total[j] != total) ok = FALSE;
+        }
+        if (j != cache->n) ok = FALSE;
+        if (!ok) bad++;
+    }
+
+    return bad;
+}
+
+/* Pick an index into alloc_race_table, or -1 if nothing is allowed */
+static int _mon_alloc_pick(_mon_alloc_ptr cache, bool allow_unique)
+{
+    int  tries, i;
+    s32b value, total;
+
+    if (!cache->n || !cache->total[cache->n - 1]) return -1;
+
+    for (tries = 0; tries < _MON_ALLOC_TRIES; tries++)
+    {
+        int lo = 0, hi = cache->n - 1;
+
+        value = randint0(cache->total[cache->n - 1]);
+        while (lo < hi)
+        {
+            int mid = (lo + hi) / 2;
+            if (cache->total[mid] > value) hi = mid;
+            else lo = mid + 1;
+        }
+        if (_mon_alloc_okay(alloc_race_table[lo].index, allow_unique))
+            return lo;
+    }
+
+    /* Most of the weight is disallowed right now, so sum up what is left */
+    total = 0;
+    for (i = 0; i < cache->n; i++)
+    {
+        s32b prob = cache->total[i] - (i ? cache->total[i - 1] : 0);
+        if (prob && _mon_alloc_okay(alloc_race_table[i].index, allow_unique))
+            total += prob;
+    }
+    if (!total) return -1;
+
+    value = randint0(total);
+    for (i = 0; i < cache->n; i++)
+    {
+        s32b prob = cache->total[i] - (i ? cache->total[i - 1] : 0);
+        if (!prob || !_mon_alloc_okay(alloc_race_table[i].index, allow_unique)) continue;
+        if (value < prob) return i;
+        value -= prob;
+    }
+    return -1;
+}
+
 /*
  * Choose a monster race that seems "appropriate" to the given level
  *
  * This function uses the "prob2" field of the "monster allocation table",
- * and various local information, to calculate the "prob3" field of the
- * same table, which is then used to choose an "appropriate" monster, in
- * a relatively efficient manner.
+ * and various local information, to build running totals for the given
+ * level (see _mon_alloc_cache() above), which are then used to choose an
+ * "appropriate" monster, in a relatively efficient manner.
  *
  * Note that "town" monsters will *only* be created in the town, and
  * "normal" monsters will *never* be created in the town, unless the
@@ -1523,20 +1959,13 @@ static int mysqrt(int n)
  * Note that if no monsters are "appropriate", then this function will
  * fail, and return zero, but this should *almost* never happen.
  */
-static bool _ignore_depth_hack = FALSE;
-
 s16b get_mon_num(int level)
 {
     int            i, j, p;
 
-    int            r_idx;
-
-    long        value, total;
-
-    monster_race    *r_ptr;
-
     alloc_entry        *table = alloc_race_table;
     bool         allow_unique = TRUE;
+    _mon_alloc_ptr cache;
 
     int pls_kakuritu, pls_level;
     int hoge=mysqrt(level*10000L);
@@ -1604,102 +2033,12 @@ s16b get_mon_num(int level)
     }
 
 
-    /* Reset total */
-    total = 0L;
-
-    /* Process probabilities */
-    for (i = 0; i < alloc_race_size; i++)
-    {
-        if (table[i].level > level) break; /* Monsters are sorted by depth */
-        table[i].prob3 = 0;
-
-        if (!_ignore_depth_hack && table[i].max_level < level) continue;
-        if (!summon_specific_who && dungeon_type == DUNGEON_ARENA && table[i].level < MIN(50, dun_level-5)) continue;
-
-        /* Hack: Sparing early unique monsters is no longer a viable end game strategy */
-        if (summon_specific_who && summon_specific_type == SUMMON_UNIQUE)
-        {
-            monster_type *who_ptr = &m_list[summon_specific_who];
-            int           who_lvl = r_info[who_ptr->r_idx].level;
-
-            if (who_lvl >= 50)
-            {
-                if (table[i].level < who_lvl - 40) continue;
-            }
-        }
-
-        r_idx = table[i].index;
-        r_ptr = &r_info[r_idx];
-
-        /* Hack: Camelot monsters only appear in Camelot. Olympians in Mt Olympus. Southerings in the Stronghold */
-        if (!no_wilderness)
-        {
-            if ((r_ptr->flags2 & RF2_CAMELOT) && dungeon_type != DUNGEON_CAMELOT) continue;
-            if ((r_ptr->flags2 & RF2_SOUTHERING) && dungeon_type != DUNGEON_STRONGHOLD) continue;
-            if ((r_ptr->flags3 & RF3_OLYMPIAN) && dungeon_type != DUNGEON_OLYMPUS) continue;
-        }
-        /* Hack: Some monsters are restricted from quests (e.g. Zeus in no_wilderness mode) */
-        if (quests_get_current() && (r_ptr->flags1 & RF1_NO_QUEST)) continue;
-
-        if (!p_ptr->inside_battle && !chameleon_change_m_idx)
-        {
-            /* Hack -- "unique" monsters must be "unique" */
-            if ( ((r_ptr->flags1 & RF1_UNIQUE) || (r_ptr->flags7 & RF7_NAZGUL) || (r_idx == MON_CAMELOT_KNIGHT))
-              && r_ptr->cur_num >= r_ptr->max_num)
-            {
-                /* Serpent can "resurrect" uniques, but not weak ones! */
-                if (!summon_cloned_okay || r_ptr->level < 70) continue;
-            }
-
-            if ((r_ptr->flags1 & RF1_UNIQUE) && !allow_unique)
-                continue;
-
-            if ((r_ptr->flags7 & (RF7_UNIQUE2)) &&
-                (r_ptr->cur_num >= 1))
-            {
-                continue;
-            }
-
-            if (r_idx == MON_BANORLUPART)
-            {
-                if (r_info[MON_BANOR].cur_num > 0) continue;
-                if (r_info[MON_LUPART].cur_num > 0) continue;
-            }
-        }
-
-        table[i].prob3 = table[i].prob2;
-
-        /* Hack: Undersized monsters become more rare ... but only for max_depth restricted monsters.
-           The goal is that these monsters gradually become less and less common, rather than suddenly
-           disappearing. About 50% of monsters currently have depth restrictions. */
-        if ( table[i].prob3
-          && r_ptr->max_level != 999 /* <=== Remove this, and the end game becomes too difficult */
-          && level > r_ptr->level + 9
-          && !(r_ptr->flags1 & RF1_UNIQUE) ) /* Redundant. Uniques never have depth restrictions. */
-        {
-            int delta = level - r_ptr->level;
-            table[i].prob3 = table[i].prob3 >> (delta/10);
-            if (!table[i].prob3)
-                table[i].prob3 = 1;
-        }
-
-        total += table[i].prob3;
-    }
+    /* Find (or build) the running totals for this level */
+    cache = _mon_alloc_cache(level);
 
     /* No legal monsters */
-    if (total <= 0) return (0);
-
-
-    /* Pick a monster */
-    value = randint0(total);
-
-    /* Find the monster */
-    for (i = 0; i < alloc_race_size; i++)
-    {
-        if (value < table[i].prob3) break;
-        value = value - table[i].prob3;
-    }
-
+    i = _mon_alloc_pick(cache, allow_unique);
+    if (i < 0) return (0);
 
     /* Power boost */
     p = randint0(100);
@@ -1711,17 +2050,10 @@ s16b get_mon_num(int level)
         j = i;
 
         /* Pick a monster */
-        value = randint0(total);
-
-        /* Find the monster */
-        for (i = 0; i < alloc_race_size; i++)
-        {
-            if (value < table[i].prob3) break;
-            value = value - table[i].prob3;
-        }
+        i = _mon_alloc_pick(cache, allow_unique);
 
         /* Keep the "best" one */
-        if (table[i].level < table[j].level) i = j;
+        if (i < 0 || table[i].level < table[j].level) i = j;
     }
 
     /* Try for a "harder" monster twice (10%) */
@@ -1731,17 +2063,10 @@ s16b get_mon_num(int level)
         j = i;
 
         /* Pick a monster */
-        value = randint0(total);
-
-        /* Find the monster */
-        for (i = 0; i < alloc_race_size; i++)
-        {
-            if (value < table[i].prob3) break;
-            value = value - table[i].prob3;
-        }
+        i = _mon_alloc_pick(cache, allow_unique);
 
         /* Keep the "best" one */
-        if (table[i].level < table[j].level) i = j;
+        if (i < 0 || table[i].level < table[j].level) i = j;
     }
 
     if (r_info[table[i].index].flags1 & RF1_UNIQUE)
@@ -2570,6 +2895,7 @@ void update_mon(int m_idx, bool full)
 
         /* Save the distance */
         m_ptr->cdis = d;
+        mon_sched_update(m_idx);
 
         if (m_ptr->cdis <= 2 && projectable(py, px, fy, fx))
             do_disturb = TRUE;
@@ -2946,7 +3272,7 @@ void update_monsters(bool full)
     int i;
 
     /* Update each (live) monster */
-    for (i = 1; i < m_max; i++)
+    for_each_live_mon(i)
     {
         monster_type *m_ptr = &m_list[i];
 
@@ -3074,6 +3400,7 @@ void choose_new_monster(int m_idx, bool born, int r_idx)
 
     m_ptr->r_idx = r_idx;
     m_ptr->ap_r_idx = r_idx;
+    mon_sched_wake(m_idx);
     update_mon(m_idx, FALSE);
     lite_spot(m_ptr->fy, m_ptr->fx);
 
@@ -3344,7 +3671,7 @@ int place_monster_one(int who, int y, int x, int r_idx, int pack_idx, u32b mode)
     if ((r_ptr->flags1 & RF1_UNIQUE) || (r_ptr->flags7 & RF7_NAZGUL) || (r_ptr->level < 10)) mode &= ~PM_KAGE;
 
     /* Make a new monster */
-    c_ptr->m_idx = m_pop();
+    cave_set_m_idx(y, x, m_pop());
     hack_m_idx_ii = c_ptr->m_idx;
 
     /* Mega-Hack -- catch "failure" */
@@ -4344,9 +4671,9 @@ bool summon_specific(int who, int y1, int x1, int lev, int type, u32b mode)
 
             oy = m_ptr->fy;
             ox = m_ptr->fx;
-            cave[oy][ox].m_idx = 0;
+            cave_set_m_idx(oy, ox, 0);
 
-            cave[y][x].m_idx = i;
+            cave_set_m_idx(y, x, i);
             m_ptr->fy = y;
             m_ptr->fx = x;
 
@@ -4482,9 +4809,9 @@ bool summon_named_creature (int who, int oy, int ox, int r_idx, u32b mode)
 
             oy = m_ptr->fy;
             ox = m_ptr->fx;
-            cave[oy][ox].m_idx = 0;
+            cave_set_m_idx(oy, ox, 0);
 
-            cave[y][x].m_idx = i;
+            cave_set_m_idx(y, x, i);
             m_ptr->fy = y;
             m_ptr->fx = x;
 
@@ -3049,7 +3049,7 @@ bool make_attack_spell(int m_idx, bool ticked_off)
                     int dummy_x = m_ptr->fx;
 
                     if (!r_info[MON_BANOR].cur_num || !r_info[MON_LUPART].cur_num) return (FALSE);
-                    for (k = 1; k < m_max; k++)
+                    for_each_live_mon(k)
                     {
                         if (m_list[k].r_idx == MON_BANOR || m_list[k].r_idx == MON_LUPART)
                         {
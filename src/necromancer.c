@@ -326,8 +326,8 @@ cptr do_necromancy_spell(int spell, int mode)
                 if ((ty != oy) || (tx != ox))
                 {
                     msg_format("A foul wind blows %s away!", m_name);
-                    cave[oy][ox].m_idx = 0;
-                    cave[ty][tx].m_idx = m_idx;
+                    cave_set_m_idx(oy, ox, 0);
+                    cave_set_m_idx(ty, tx, m_idx);
                     m_ptr->fy = ty;
                     m_ptr->fx = tx;
     
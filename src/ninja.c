@@ -119,8 +119,8 @@ static void _chain_hook_spell(int cmd, variant *res)
                 tx = nx;
             }
         }
-        cave[target_row][target_col].m_idx = 0;
-        cave[ty][tx].m_idx = m_idx;
+        cave_set_m_idx(target_row, target_col, 0);
+        cave_set_m_idx(ty, tx, m_idx);
         m_ptr->fy = ty;
         m_ptr->fx = tx;
         (void)set_monster_csleep(m_idx, 0);
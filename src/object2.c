@@ -113,7 +113,7 @@ void excise_object_idx(int o_idx)
                 if (prev_o_idx == 0)
                 {
                     /* Remove from list */
-                    c_ptr->o_idx = next_o_idx;
+                    cave_set_o_idx(y, x, next_o_idx);
                 }
 
                 /* Real previous */
@@ -174,6 +174,10 @@ void delete_object_idx(int o_idx)
     /* Wipe the object */
     object_wipe(j_ptr);
 
+    /* Recycle the slot */
+    j_ptr->next_o_idx = o_free_list;
+    o_free_list = o_idx;
+
     /* Count objects */
     o_cnt--;
 
@@ -217,7 +221,7 @@ void delete_object(int y, int x)
     }
 
     /* Objects are gone */
-    c_ptr->o_idx = 0;
+    cave_set_o_idx(y, x, 0);
 
     /* Visual update */
     lite_spot(y, x);
@@ -423,6 +427,9 @@ void compact_objects(int size)
         /* Compress "o_max" */
         o_max--;
     }
+
+    /* There are no holes left */
+    o_free_list = 0;
 }
 
 
@@ -480,17 +487,12 @@ void wipe_o_list(void)
         /* Dungeon */
         else
         {
-            cave_type *c_ptr;
-
             /* Access location */
             int y = o_ptr->loc.y;
             int x = o_ptr->loc.x;
 
-            /* Access grid */
-            c_ptr = &cave[y][x];
-
             /* Hack -- see above */
-            c_ptr->o_idx = 0;
+            cave_set_o_idx(y, x, 0);
         }
 
         /* Wipe the object */
@@ -502,6 +504,7 @@ void wipe_o_list(void)
 
     /* Reset "o_cnt" */
     o_cnt = 0;
+    o_free_list = 0;
 }
 
 
@@ -515,6 +518,23 @@ s16b o_pop(void)
 {
     int i;
 
+    /* Recycle a dead object (dead objects are chained through
+       "next_o_idx", see m_pop()) */
+    if (o_free_list)
+    {
+        i = o_free_list;
+
+        /* Paranoia -- forget a list that has gone stale */
+        if (i >= o_max || o_list[i].k_idx)
+            o_free_list = 0;
+        else
+        {
+            o_free_list = o_list[i].next_o_idx;
+            o_list[i].next_o_idx = 0;
+            o_cnt++;
+            return (i);
+        }
+    }
 
     /* Initial allocation */
     if (o_max < max_o_idx)
@@ -533,7 +553,7 @@ s16b o_pop(void)
     }
 
 
-    /* Recycle dead objects */
+    /* Recycle dead objects the list lost track of */
     for (i = 1; i < o_max; i++)
     {
         object_type *o_ptr;
@@ -563,10 +583,13 @@ s16b o_pop(void)
 
 /*
  * Apply a "object restriction function" to the "object allocation table"
+ *
+ * The result is hashed into alloc_kind_stamp (see get_mon_num_prep()).
  */
 errr get_obj_num_prep(void)
 {
     int i;
+    u32b stamp = 2166136261UL;
 
     /* Get the entry */
     alloc_entry *table = alloc_kind_table;
@@ -587,7 +610,11 @@ errr get_obj_num_prep(void)
             /* Decline this object */
             table[i].prob2 = 0;
         }
+
+        /* FNV-1a */
+        stamp = (stamp ^ (u32b)table[i].prob2) * 16777619UL;
     }
+    alloc_kind_stamp = stamp;
 
     /* Success */
     return (0);
@@ -624,24 +651,173 @@ static bool _is_stat_potion(int tval, int sval)
     return FALSE;
 }
 
+/*
+ * Running totals of the "object allocation table" for get_obj_num().
+ *
+ * As with get_mon_num(), the weights that only change when the table is
+ * prepped are summed once per level, and the rest (the spellbook limits,
+ * chests inside chests and so on) are applied to the kind that was
+ * picked, drawing again if it is refused. A slot is only reused if its
+ * copy of the prepped weights still matches the table.
+ */
+#define _OBJ_ALLOC_SLOTS 8
+#define _OBJ_ALLOC_TRIES 64
+
+typedef struct {
+    u32b  stamp;
+    int   level;
+    bool  quick;
+    int   n;
+    s32b *total;
+    byte *prob2;
+} _obj_alloc_t, *_obj_alloc_ptr;
+
+static _obj_alloc_t _obj_alloc[_OBJ_ALLOC_SLOTS];
+static int _obj_alloc_next = 0;
+
+static bool _obj_alloc_match(_obj_alloc_ptr cache)
+{
+    int i;
+
+    if (cache->stamp != alloc_kind_stamp) return FALSE;
+    for (i = 0; i < cache->n; i++)
+    {
+        if (cache->prob2[i] != alloc_kind_table[i].prob2) return FALSE;
+    }
+    return TRUE;
+}
+
+/* The part of the weight that only depends on the level */
+static int _obj_alloc_weight(alloc_entry *entry, int level)
+{
+    object_kind *k_ptr = &k_info[entry->index];
+    int          p = entry->prob2;
+
+    if (entry->max_level && entry->max_level < level) p = 0;
+
+    /* Probably the slowest thing in "slowband" is stat gain ... sigh */
+    if (quickband && _is_stat_potion(k_ptr->tval, k_ptr->sval))
+        p *= 2;
+
+    return p;
+}
+
+static _obj_alloc_ptr _obj_alloc_cache(int level)
+{
+    _obj_alloc_ptr cache;
+    int            i;
+    s32b           total;
+
+    for (i = 0; i < _OBJ_ALLOC_SLOTS; i++)
+    {
+        cache = &_obj_alloc[i];
+        if ( cache->total
+          && cache->level == level
+          && cache->quick == quickband
+          && _obj_alloc_match(cache) )
+        {
+            return cache;
+        }
+    }
+
+    /* Replace the oldest */
+    cache = &_obj_alloc[_obj_alloc_next];
+    _obj_alloc_next = (_obj_alloc_next + 1) % _OBJ_ALLOC_SLOTS;
+
+    if (!cache->total)
+    {
+        C_MAKE(cache->total, alloc_kind_size, s32b);
+        C_MAKE(cache->prob2, alloc_kind_size, byte);
+    }
+    cache->stamp = alloc_kind_stamp;
+    cache->level = level;
+    cache->quick = quickband;
+
+    total = 0;
+    for (i = 0; i < alloc_kind_size; i++)
+    {
+        alloc_entry *entry = &alloc_kind_table[i];
+
+        /* Objects are sorted by depth */
+        if (entry->level > level) break;
+
+        total += _obj_alloc_weight(entry, level);
+        cache->total[i] = total;
+        cache->prob2[i] = entry->prob2;
+    }    cache->n = i;
+    return cache;
+}
+
+/*
+ * Debug -- sum the weights afresh for every slot that would be reused for
+ * the table as it stands, and compare. Returns the number of slots whose
+ * totals are wrong (which should always be zero).
+ */
+int obj_alloc_verify(void)
+{
+    int i, j, bad = 0;
+
+    for (i = 0; i < _OBJ_ALLOC_SLOTS; i++)
+    {
+        _obj_alloc_ptr cache = &_obj_alloc[i];
+        s32b           total = 0;
+        bool           ok = TRUE;
+
+        if (!cache->total || cache->quick != quickband || !_obj_alloc_match(cache)) continue;
+
+        for (j = 0; j < alloc_kind_size && alloc_kind_table[j].level <= cache->level; j++)
+        {
+            total += _obj_alloc_weight(&alloc_kind_table[j], cache->level);
+            if (j < cache->n && cache->total[j] != total) ok = FALSE;
+        }
+        if (j != cache->n) ok = FALSE;
+        if (!ok) bad++;
+    }
+
+    return bad;
+}
+
+/* The weight of k_idx right now, given its weight p in the running totals */
+static int _obj_alloc_prob(int k_idx, int p)
+{
+    object_kind *k_ptr = &k_info[k_idx];
+    int          max = 0;
+
+    if (k_ptr->tval == TV_FOOD && k_ptr->sval == SV_FOOD_AMBROSIA && dungeon_type != DUNGEON_OLYMPUS) return 0;
+    if (easy_id && k_ptr->tval == TV_SCROLL && k_ptr->sval == SV_SCROLL_STAR_IDENTIFY) return 0;
+    /* Hack -- prevent embedded chests */
+    if (opening_chest && (k_ptr->tval == TV_CHEST)) return 0;
+
+    /* TODO: Add some sort of max_num field to limit certain objects (I'm looking at you, spellbooks!)
+       Note, this also ensures an even distribution of spellbook kinds for high level books! */
+    max = _spellbook_max(k_ptr->tval, k_ptr->sval);
+    if (max && p)
+    {
+        int ct = k_ptr->counts.found - max;
+        while (ct-- > 0)
+            p /= 2;
+        p = MAX(p, 1);
+    }
+    return p;
+}
+
 /*
  * Choose an object kind that seems "appropriate" to the given level
  *
  * This function uses the "prob2" field of the "object allocation table",
- * and various local information, to calculate the "prob3" field of the
- * same table, which is then used to choose an "appropriate" object, in
- * a relatively efficient manner.
+ * and various local information, to build running totals for the given
+ * level (see _obj_alloc_cache() above), which are then used to choose an
+ * "appropriate" object, in a relatively efficient manner.
  *
  * Note that if no objects are "appropriate", then this function will
  * fail, and return zero, but this should *almost* never happen.
  */
 s16b get_obj_num(int level)
 {
-    int             i;
-    int             k_idx;
+    int             i, tries;
     long            value, total;
-    object_kind     *k_ptr;
     alloc_entry     *table = alloc_kind_table;
+    _obj_alloc_ptr  cache;
 
     if (level > MAX_DEPTH - 1) level = MAX_DEPTH - 1;
 
@@ -663,63 +839,58 @@ s16b get_obj_num(int level)
         }
     }
 
-    /* Reset total */
-    total = 0L;
+    cache = _obj_alloc_cache(level);
 
-    /* Process probabilities */
-    for (i = 0; i < alloc_kind_size; i++)
+    /* No legal objects */
+    if (!cache->n || !cache->total[cache->n - 1])
+        return 0;
+
+    /* Pick an object, and keep it with odds of its current weight over its
+       weight in the totals */
+    for (tries = 0; tries < _OBJ_ALLOC_TRIES; tries++)
     {
-        int p = table[i].prob2;
-        int max = 0;
+        int lo = 0, hi = cache->n - 1, p, q;
 
-        /* Objects are sorted by depth */
-        if (table[i].level > level) break;
-        table[i].prob3 = 0;
-
-        if (table[i].max_level && table[i].max_level < level) continue;
-
-        k_idx = table[i].index;
-        k_ptr = &k_info[k_idx];
-        if (k_ptr->tval == TV_FOOD && k_ptr->sval == SV_FOOD_AMBROSIA && dungeon_type != DUNGEON_OLYMPUS) continue;
-        if (easy_id && k_ptr->tval == TV_SCROLL && k_ptr->sval == SV_SCROLL_STAR_IDENTIFY) continue;
-        /* Hack -- prevent embedded chests */
-        if (opening_chest && (k_ptr->tval == TV_CHEST)) continue;
-
-        /* Probably the slowest thing in "slowband" is stat gain ... sigh */
-        if (quickband && _is_stat_potion(k_ptr->tval, k_ptr->sval))
-            p *= 2;
-
-        /* TODO: Add some sort of max_num field to limit certain objects (I'm looking at you, spellbooks!)
-           Note, this also ensures an even distribution of spellbook kinds for high level books! */
-        max = _spellbook_max(k_ptr->tval, k_ptr->sval);
-        if (max && p)
+        value = randint0(cache->total[cache->n - 1]);
+        while (lo < hi)
         {
-            int ct = k_ptr->counts.found - max;
-            while (ct-- > 0)
-                p /= 2;
-            p = MAX(p, 1);
+            int mid = (lo + hi) / 2;
+            if (cache->total[mid] > value) hi = mid;
+            else lo = mid + 1;
         }
+        p = cache->total[lo] - (lo ? cache->total[lo - 1] : 0);
+        q = _obj_alloc_prob(table[lo].index, p);
+        if (q == p || (q && randint0(p) < q))
+            return (table[lo].index);
+    }
 
-        table[i].prob3 = p;
-        total += p;
+    /* Most of the weight is refused right now, so sum up what is left */
+    total = 0L;
+    for (i = 0; i < cache->n; i++)
+    {
+        int p = cache->total[i] - (i ? cache->total[i - 1] : 0);
+        if (p) total += _obj_alloc_prob(table[i].index, p);
     }
 
     /* No legal objects */
     if (total <= 0)
         return 0;
 
-
     /* Pick an object */
     value = randint0(total);
 
     /* Find the object */
-    for (i = 0; i < alloc_kind_size; i++)
+    for (i = 0; i < cache->n; i++)
     {
+        int p = cache->total[i] - (i ? cache->total[i - 1] : 0);
+
+        if (p) p = _obj_alloc_prob(table[i].index, p);
+
         /* Found the entry */
-        if (value < table[i].prob3) break;
+        if (value < p) break;
 
         /* Decrement */
-        value = value - table[i].prob3;
+        value = value - p;
     }
 
     /* Note: There used to be power boosting code here, but it gave very bad results in
@@ -3703,7 +3874,7 @@ void place_object(int y, int x, u32b mode)
         o_ptr->next_o_idx = c_ptr->o_idx;
 
         /* Place the object */
-        c_ptr->o_idx = o_idx;
+        cave_set_o_idx(y, x, o_idx);
 
         /* Notice */
         note_spot(y, x);
@@ -3832,7 +4003,7 @@ void place_gold(int y, int x)
         o_ptr->next_o_idx = c_ptr->o_idx;
 
         /* Place the object */
-        c_ptr->o_idx = o_idx;
+        cave_set_o_idx(y, x, o_idx);
 
         /* Notice */
         note_spot(y, x);
@@ -4179,7 +4350,7 @@ s16b drop_near(object_type *j_ptr, int chance, int y, int x)
         j_ptr->next_o_idx = c_ptr->o_idx;
 
         /* Place the object */
-        c_ptr->o_idx = o_idx;
+        cave_set_o_idx(by, bx, o_idx);
 
         /* Success */
         done = TRUE;
@@ -4358,6 +4529,7 @@ void place_trap(int y, int x)
     /* Place an invisible trap */
     c_ptr->mimic = c_ptr->feat;
     c_ptr->feat = choose_random_trap();
+    view_los_note(y, x);
 }
 
 
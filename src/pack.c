@@ -332,6 +332,14 @@ int pack_overflow_count(void)
     return vec_length(_overflow);
 }
 
+void pack_overflow_for_each(obj_f f)
+{
+    int i;
+    if (!_overflow) return;
+    for (i = 0; i < vec_length(_overflow); i++)
+        f(vec_get(_overflow, i));
+}
+
 bool pack_overflow(void)
 {
     bool result = FALSE;
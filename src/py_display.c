@@ -1223,7 +1223,7 @@ static void _build_pets(doc_ptr doc)
     bool pet_settings = FALSE;
     char pet_name[MAX_NLEN];
 
-    for (i = m_max - 1; i >= 1; i--)
+    for_each_live_mon_back(i)
     {
         monster_type *m_ptr = &m_list[i];
 
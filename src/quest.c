@@ -663,8 +663,9 @@ void quests_on_birth(void)
     vec_ptr v;
     int i;
 
-    /* stale data from the last character */
+    /* stale data from the last character (and edit files read for it) */
     quests_cleanup();
+    parse_edit_file_flush();
     quests_init();
 
     /* assign random quests */
@@ -872,7 +873,7 @@ static void _remove_questors(void)
     if (q->goal == QG_KILL_MON)
     {
         int i;
-        for (i = 1; i < m_max; i++)
+        for_each_live_mon(i)
         {
             monster_race *r_ptr;
             monster_type *m_ptr = &m_list[i];
@@ -1588,6 +1589,7 @@ static void _analyze_cmd(_ui_context_ptr context)
             memset(_temp_reward, 0, sizeof(room_grid_t));
             trace_doc = context->doc;
             doc_clear(context->doc);
+            parse_edit_file_flush(); /* show the file as it is now */
             parse_edit_file(quest->file, _parse_debug, INIT_DEBUG);
             room_free(_temp_room);
             free(_temp_reward);
@@ -861,7 +861,7 @@ static void _cyber_move_player(void)
         if (disturb_minor)
             disturb(0, 0);
 
-        for (i = 1; i < m_max; i++)
+        for_each_live_mon(i)
         {
             monster_type *m_ptr = &m_list[i];
 
@@ -1894,7 +1894,7 @@ static void _banish_summons_spell(int cmd, variant *res)
     {
         int i;
         msg_print("You shatter all oaths of allegiance!");
-        for (i = 1; i < m_max; i++)
+        for_each_live_mon(i)
         {
             monster_type *m_ptr = &m_list[i];
 
@@ -264,7 +264,7 @@ static void _monster_toss_imp(_monster_toss_info *info)
     monster_desc(m_name, m_ptr, 0);
     msg_format("You toss %s.", m_name);
 
-    cave[m_ptr->fy][m_ptr->fx].m_idx = 0;
+    cave_set_m_idx(m_ptr->fy, m_ptr->fx, 0);
     lite_spot(m_ptr->fy, m_ptr->fx);
 
     ct = project_path(path, info->tdis, py, px, info->ty, info->tx, PROJECT_PATH);
@@ -401,14 +401,14 @@ static void _monster_toss_imp(_monster_toss_info *info)
 
     if (cave_empty_bold(y, x))
     {
-        cave[y][x].m_idx = info->m_idx;
+        cave_set_m_idx(y, x, info->m_idx);
         m_ptr->fy = y;
         m_ptr->fx = x;
         lite_spot(y, x);
     }
     else /* oops ... put the monster back where it started! */
     {
-        cave[m_ptr->fy][m_ptr->fx].m_idx = info->m_idx;
+        cave_set_m_idx(m_ptr->fy, m_ptr->fx, info->m_idx);
         lite_spot(m_ptr->fy, m_ptr->fx);
     }
     if (dam)
@@ -561,7 +561,7 @@ static int _choose_mimic_form(void)
     }
 
     /* List Visible Forms */
-    for (i = 1; i < m_max; i++)
+    for_each_live_mon(i)
     {
         monster_type *m_ptr = &m_list[i];
 
@@ -750,7 +750,7 @@ static void _birth(void)
 static bool _is_visible(int r_idx)
 {
     int i;
-    for (i = 1; i < m_max; i++)
+    for_each_live_mon(i)
     {
         monster_type *m_ptr = &m_list[i];
 
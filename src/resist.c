@@ -81,17 +81,23 @@ static _res_info_t _resist_map[RES_MAX] = {
 };
 
 void res_calc_bonuses(u32b flgs[OF_ARRAY_SIZE])
+{
+    res_calc_amts(flgs, p_ptr->resist);
+}
+
+/* As res_calc_bonuses(), but counting into amts rather than the player */
+void res_calc_amts(u32b flgs[OF_ARRAY_SIZE], s16b amts[RES_MAX])
 {
     int i;
     for (i = RES_BEGIN; i < RES_END; i++)
     {
         _res_info_t m = _resist_map[i];
         if (m.flg != OF_INVALID && have_flag(flgs, m.flg))
-            res_add(i);
+            amts[i]++;
         if (m.vuln_flg != OF_INVALID && have_flag(flgs, m.vuln_flg))
-            res_add_vuln(i);
+            amts[i]--;
         if (m.im_flg != OF_INVALID && have_flag(flgs, m.im_flg))
-            res_add_immune(i);
+            amts[i] += 100;
     }
 }
 
@@ -32,6 +32,7 @@ extern void res_add_all(void);
 extern void res_add_immune(int which);
 extern void res_add_vuln(int which);
 extern void res_calc_bonuses(u32b flgs[OF_ARRAY_SIZE]);
+extern void res_calc_amts(u32b flgs[OF_ARRAY_SIZE], s16b amts[RES_MAX]);
 extern bool res_has_bonus(u32b flgs[OF_ARRAY_SIZE]);
 extern int  res_calc_dam(int which, int dam);
 extern bool res_can_ignore(int which);
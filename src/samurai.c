@@ -280,8 +280,8 @@ cptr do_hissatsu_spell(int spell, int mode)
                 if ((ty != oy) || (tx != ox))
                 {
                     msg_format("You blow %s away!", m_name);
-                    cave[oy][ox].m_idx = 0;
-                    cave[ty][tx].m_idx = m_idx;
+                    cave_set_m_idx(oy, ox, 0);
+                    cave_set_m_idx(ty, tx, m_idx);
                     m_ptr->fy = ty;
                     m_ptr->fx = tx;
     
@@ -632,8 +632,8 @@ cptr do_hissatsu_spell(int spell, int mode)
                     continue;
                 }
     
-                c_ptr->m_idx = 0;
-                cave[ny][nx].m_idx = m_idx;
+                cave_set_m_idx(y, x, 0);
+                cave_set_m_idx(ny, nx, m_idx);
                 m_ptr->fy = ny;
                 m_ptr->fx = nx;
     
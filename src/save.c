@@ -231,10 +231,15 @@ static void wr_randomizer(savefile_ptr file)
 {
     int i;
 
-    savefile_write_u16b(file, Rand_place);
+    savefile_write_byte(file, RAND_STREAMS);
 
-    for (i = 0; i < RAND_DEG; i++)
-        savefile_write_u32b(file, Rand_state[i]);
+    for (i = 0; i < RAND_STREAMS; i++)
+    {
+        savefile_write_u32b(file, (u32b)(Rand_state[i].state >> 32));
+        savefile_write_u32b(file, (u32b)Rand_state[i].state);
+        savefile_write_u32b(file, (u32b)(Rand_state[i].inc >> 32));
+        savefile_write_u32b(file, (u32b)Rand_state[i].inc);
+    }
 }
 
 static void wr_options(savefile_ptr file)
@@ -625,6 +630,44 @@ static void ang_sort_swap_cave_temp(vptr u, vptr v, int a, int b)
 }
 
 
+/*
+ * Templates are found through an open hash on the grid contents rather
+ * than by scanning the list for every grid. The table is more than
+ * twice the largest cave, so it never fills up.
+ */
+#define _TEMP_HASH_SIZE (1 << 15)
+
+/* Longest run of the floor grid encoding, and the flag for copy runs */
+#define _RUN_MAX   128
+#define _RUN_ABOVE 0x80
+
+static int _temp_find(cave_template_type *template, u16b *table, cave_type *c_ptr)
+{
+    u32b h = c_ptr->info;
+    int  slot;
+
+    h = h * 31 + (u16b)c_ptr->feat;
+    h = h * 31 + (u16b)c_ptr->mimic;
+    h = h * 31 + (u16b)c_ptr->special;
+    h ^= h >> 15;
+    h *= 0x2c1b3c6d;
+    h ^= h >> 12;
+
+    for (slot = h & (_TEMP_HASH_SIZE - 1); table[slot]; slot = (slot + 1) & (_TEMP_HASH_SIZE - 1))
+    {
+        cave_template_type *ct_ptr = &template[table[slot] - 1];
+
+        if (ct_ptr->info == c_ptr->info &&
+            ct_ptr->feat == c_ptr->feat &&
+            ct_ptr->mimic == c_ptr->mimic &&
+            ct_ptr->special == c_ptr->special)
+            break;
+    }
+
+    /* Either the template, or the empty slot it belongs in */
+    return slot;
+}
+
 /*
  * Actually write a saved floor data
  * using effectively compressed format.
@@ -640,8 +683,10 @@ static void wr_saved_floor(savefile_ptr file, saved_floor_type *sf_ptr)
 
     u16b tmp16u;
 
-    byte count;
-    u16b prev_u16b;
+    u16b *table;
+    u16b *ids;
+    u16b *remap;
+    cave_template_type *unsorted;
 
 
     if (!sf_ptr)
@@ -690,29 +735,26 @@ static void wr_saved_floor(savefile_ptr file, saved_floor_type *sf_ptr)
     /* Allocate the "template" array */
     C_MAKE(template, max_num_temp, cave_template_type);
 
+    /* Allocate the lookup table and the per grid template IDs */
+    C_MAKE(table, _TEMP_HASH_SIZE, u16b);
+    C_MAKE(ids, cur_hgt * cur_wid, u16b);
+
     /* Extract template array */
     for (y = 0; y < cur_hgt; y++)
     {
         for (x = 0; x < cur_wid; x++)
         {
             cave_type *c_ptr = &cave[y][x];
+            int slot = _temp_find(template, table, c_ptr);
 
-            for (i = 0; i < num_temp; i++)
+            /* Same terrain is exist */
+            if (table[slot])
             {
-                if (template[i].info == c_ptr->info &&
-                    template[i].feat == c_ptr->feat &&
-                    template[i].mimic == c_ptr->mimic &&
-                    template[i].special == c_ptr->special)
-                {
-                    /* Same terrain is exist */
-                    template[i].occurrence++;
-                    break;
-                }
+                ids[y * cur_wid + x] = table[slot] - 1;
+                template[table[slot] - 1].occurrence++;
+                continue;
             }
 
-            /* Are there same one? */
-            if (i < num_temp) continue;
-
             /* If the max_num_temp is too small, increase it. */
             if (num_temp >= max_num_temp)
             {
@@ -733,7 +775,9 @@ static void wr_saved_floor(savefile_ptr file, saved_floor_type *sf_ptr)
             template[num_temp].occurrence = 1;
 
             /* Increase number of template */
+            ids[y * cur_wid + x] = num_temp;
             num_temp++;
+            table[slot] = num_temp;
         }
     }
 
@@ -741,9 +785,28 @@ static void wr_saved_floor(savefile_ptr file, saved_floor_type *sf_ptr)
     ang_sort_comp = ang_sort_comp_cave_temp;
     ang_sort_swap = ang_sort_swap_cave_temp;
 
-    /* Sort by occurrence */
+    /* Sort by occurrence, keeping the order the table was built in */
+    C_MAKE(unsorted, num_temp, cave_template_type);
+    C_COPY(unsorted, template, num_temp, cave_template_type);
     ang_sort(template, &dummy_why, num_temp);
 
+    /* Map the IDs of the table onto the sorted templates */
+    C_MAKE(remap, num_temp, u16b);
+    for (i = 0; i < num_temp; i++)
+    {
+        cave_type tmp;
+
+        tmp.info = template[i].info;
+        tmp.feat = template[i].feat;
+        tmp.mimic = template[i].mimic;
+        tmp.special = template[i].special;
+        remap[table[_temp_find(unsorted, table, &tmp)] - 1] = i;
+    }
+    for (i = 0; i < cur_hgt * cur_wid; i++)
+        ids[i] = remap[ids[i]];
+    C_FREE(remap, num_temp, u16b);
+    C_FREE(unsorted, num_temp, cave_template_type);
+
 
     /*** Dump templates ***/
 
@@ -763,74 +826,59 @@ static void wr_saved_floor(savefile_ptr file, saved_floor_type *sf_ptr)
     }
 
 
+    /*** Delta encoding of cave ***/
 
-    /*** "Run-Length-Encoding" of cave ***/
-
-    /* Note that this will induce two wasted bytes */
-    count = 0;
-    prev_u16b = 0;
-
-    /* Dump the cave */
-    for (y = 0; y < cur_hgt; y++)
+    /*
+     * Each run starts with one byte. If its high bit is set, the next
+     * (n & 0x7F) + 1 grids are the same as the grids right above them.
+     * Otherwise the next n + 1 grids share one template, whose ID
+     * follows as above. Walls, rooms and corridors repeat from row to
+     * row at least as often as along a row, so this is a good deal
+     * smaller than plain run-length encoding.
+     */
+    for (i = 0; i < cur_hgt * cur_wid; )
     {
-        for (x = 0; x < cur_wid; x++)
-        {
-            cave_type *c_ptr = &cave[y][x];
-
-            for (i = 0; i < num_temp; i++)
-            {
-                if (template[i].info == c_ptr->info &&
-                    template[i].feat == c_ptr->feat &&
-                    template[i].mimic == c_ptr->mimic &&
-                    template[i].special == c_ptr->special)
-                    break;
-            }
+        int above = 0;
+        int same = 1;
 
-            /* Extract an ID */
-            tmp16u = i;
+        /* Measure both kinds of run here */
+        if (i >= cur_wid)
+        {
+            while (i + above < cur_hgt * cur_wid && above < _RUN_MAX &&
+                   ids[i + above] == ids[i + above - cur_wid])
+                above++;
+        }
+        while (i + same < cur_hgt * cur_wid && same < _RUN_MAX &&
+               ids[i + same] == ids[i])
+            same++;
 
-            /* If the run is broken, or too full, flush it */
-            if ((tmp16u != prev_u16b) || (count == MAX_UCHAR))
-            {
-                savefile_write_byte(file, (byte)count);
-
-                while (prev_u16b >= MAX_UCHAR)
-                {
-                    /* Mark as actual data is larger than 254 */
-                    savefile_write_byte(file, MAX_UCHAR);
-                    prev_u16b -= MAX_UCHAR;
-                }
-
-                savefile_write_byte(file, (byte)prev_u16b);
-                prev_u16b = tmp16u;
-                count = 1;
-            }
+        /* Copying the row above is cheaper at equal length */
+        if (above >= same)
+        {
+            savefile_write_byte(file, (byte)(_RUN_ABOVE | (above - 1)));
+            i += above;
+        }
+        else
+        {
+            tmp16u = ids[i];
+            savefile_write_byte(file, (byte)(same - 1));
 
-            /* Continue the run */
-            else
+            while (tmp16u >= MAX_UCHAR)
             {
-                count++;
+                /* Mark as actual data is larger than 254 */
+                savefile_write_byte(file, MAX_UCHAR);
+                tmp16u -= MAX_UCHAR;
             }
+            savefile_write_byte(file, (byte)tmp16u);
+            i += same;
         }
     }
 
-    /* Flush the data (if any) */
-    if (count)
-    {
-        savefile_write_byte(file, (byte)count);
-
-        while (prev_u16b >= MAX_UCHAR)
-        {
-            /* Mark as actual data is larger than 254 */
-            savefile_write_byte(file, MAX_UCHAR);
-            prev_u16b -= MAX_UCHAR;
-        }
-        savefile_write_byte(file, (byte)prev_u16b);
-    }
-
 
     /* Free the "template" array */
     C_FREE(template, max_num_temp, cave_template_type);
+    C_FREE(table, _TEMP_HASH_SIZE, u16b);
+    C_FREE(ids, cur_hgt * cur_wid, u16b);
 
 
     /*** Dump objects ***/
@@ -1067,15 +1115,28 @@ static bool wr_savefile_new(savefile_ptr file)
     savefile_write_u32b(file, file->v_check);
     savefile_write_u32b(file, file->x_check);
 
-    if (ferror(file->file) || (fflush(file->file) == EOF)) return FALSE;
+    if (savefile_error(file)) return FALSE;
     return TRUE;
 }
 
 
-static bool save_player_aux(char *name)
+/*
+ * An autosave counts once it is on disk. If the game has moved on since,
+ * the character is not "just saved" any more.
+ */
+static u32b _async_playtime;
+static s32b _async_turn;
+
+static void _async_done(void)
+{
+    counts_write(0, _async_playtime);
+    if (game_turn == _async_turn) character_saved = TRUE;
+}
+
+static bool save_player_aux(char *name, bool async)
 {
     bool ok = FALSE;
-    savefile_ptr file = savefile_open_write(name);
+    savefile_ptr file = async ? savefile_open_async(name) : savefile_open_write(name);
 
     if (file)
     {
@@ -1089,11 +1150,19 @@ static bool save_player_aux(char *name)
             p_ptr->redraw |= PR_STATUS;
         }
 
+        /* Don't write out half a savefile */
+        if (!ok) file->error = TRUE;
+        if (async)
+        {
+            _async_playtime = playtime;
+            _async_turn = game_turn;
+            file->done = _async_done;
+        }
         if (!savefile_close(file)) ok = FALSE;
     }
 
-    /* Remove "broken" files */
-    if (!ok)
+    /* Remove "broken" files (an async save never touched the old one) */
+    if (!ok && !async)
     {
         safe_setuid_grab();
         fd_kill(name);
@@ -1102,8 +1171,11 @@ static bool save_player_aux(char *name)
 
     if (!ok) return FALSE;
 
-    counts_write(0, playtime);
-    character_saved = TRUE;
+    if (!async)
+    {
+        counts_write(0, playtime);
+        character_saved = TRUE;
+    }
     return TRUE;
 }
 
@@ -1153,10 +1225,13 @@ bool save_player(void)
     update_playtime();
 
     /* Attempt to save the player */
-    if (save_player_aux(safe))
+    if (save_player_aux(safe, FALSE))
     {
         char temp[1024];
 
+        /* An autosave still being written must not land over this */
+        savefile_wait(savefile);
+
         /* Old savefile */
         strcpy(temp, savefile);
         strcat(temp, ".old");
@@ -1209,6 +1284,9 @@ bool save_player(void)
         result = TRUE;
     }
 
+    /* Wait for every background write, so quitting leaves none behind */
+    savefile_wait(NULL);
+
 
 #ifdef SET_UID
 
@@ -1227,6 +1305,41 @@ bool save_player(void)
 
 
 
+/*
+ * Save the player without waiting on the disk: the savefile is built in
+ * memory, and a background writer puts it in place of the old one (see
+ * savefile_open_async). The character counts as saved once that is done.
+ * Used for autosaves.
+ */
+bool save_player_async(void)
+{
+    bool result;
+
+#ifdef SET_UID
+# ifdef SECURE
+    /* Get "games" permissions */
+    beGames();
+# endif
+#endif
+
+    update_playtime();
+
+    result = save_player_aux(savefile, TRUE);
+
+    /* Hack -- Pretend the character was loaded */
+    if (result) character_loaded = TRUE;
+
+#ifdef SET_UID
+# ifdef SECURE
+    /* Drop "games" permissions */
+    bePlayer();
+# endif
+#endif
+
+    return result;
+}
+
+
 /*
  * Attempt to Load a "savefile"
  *
@@ -1556,7 +1669,7 @@ static bool save_floor_aux(savefile_ptr file, saved_floor_type *sf_ptr)
     savefile_write_u32b(file, file->v_check);
     savefile_write_u32b(file, file->x_check);
 
-    if (ferror(file->file) || (fflush(file->file) == EOF)) return FALSE;
+    if (savefile_error(file)) return FALSE;
     return TRUE;
 }
 
@@ -1581,7 +1694,11 @@ bool save_floor(saved_floor_type *sf_ptr, u32b mode)
     }
 
     sprintf(floor_savefile, "%s.F%02d", savefile, (int)sf_ptr->savefile_id);
-    file = savefile_open_write(floor_savefile);
+
+    /* Nothing here waits on the disk: the floor is queued until the game
+     * is idle, and saving the game, which reads the current floor straight
+     * back (SLF_SECOND), gets it from memory */
+    file = savefile_open_async(floor_savefile);
     if (file)
     {
         ok = save_floor_aux(file, sf_ptr);
@@ -1591,6 +1708,7 @@ bool save_floor(saved_floor_type *sf_ptr, u32b mode)
     /* Remove "broken" files */
     if (!ok)
     {
+        savefile_wait(floor_savefile);
         safe_setuid_grab();
         (void)fd_kill(floor_savefile);
         safe_setuid_drop();
@@ -3,6 +3,10 @@
 
 #include <assert.h>
 
+#ifdef SET_UID
+# include <sys/wait.h>
+#endif
+
 int version_compare(version_ptr left, version_ptr right)
 {
     if (left->major < right->major) return -1;
@@ -34,26 +38,382 @@ bool savefile_is_older_than(savefile_ptr file, byte major, byte minor, byte patc
     return FALSE;
 }
 
+/************************************************************************
+ * Block I/O and the compressed container
+ *
+ * Savefiles are read and written through a block buffer. When
+ * compress_savefile is set, the whole stream is instead kept in memory
+ * and written on close as:
+ *
+ *   "SAVZ" <u32b length> <u32b hash> <lz data>
+ *
+ * The stream is xor chained (see savefile_write_byte), which would hide
+ * every repeat from the compressor, so each byte is first xor'd with the
+ * one before it, giving back the plain bytes. The lz data is a series of
+ * groups: a flag byte, then eight items, each a literal byte (flag bit
+ * clear) or a match (bit set) of a u16b distance and a byte length-3.
+ * Readers detect the container by its magic, so both kinds always load.
+ ************************************************************************/
+#define _BLOCK_SIZE  0x10000
+#define _LZ_WINDOW   0xFFFF
+#define _LZ_MIN      3
+#define _LZ_MAX      (_LZ_MIN + 255)
+#define _LZ_HASH     0x8000
+#define _LZ_CHAIN    16
+
+/* No honest container comes near these. A match is three bytes of lz
+ * data that stand for at most _LZ_MAX bytes, so a declared length above
+ * that ratio can only come from a damaged (or hostile) file. */
+#define _CONTAINER_MAX  0x1000000
+
+static bool _container_fits(u32b n, int len)
+{
+    return n <= _CONTAINER_MAX && n <= (u32b)(len / _LZ_MIN + 1) * _LZ_MAX;
+}
+
+static const byte _magic[4] = { 'S', 'A', 'V', 'Z' };
+
+static u32b _hash(const byte *p, int n)
+{
+    u32b h = 2166136261UL;
+    int  i;
+    for (i = 0; i < n; i++)
+    {
+        h ^= p[i];
+        h *= 16777619UL;
+    }
+    return h;
+}
+
+static void _put_u32b(byte *p, u32b v)
+{
+    p[0] = v & 0xFF;
+    p[1] = (v >> 8) & 0xFF;
+    p[2] = (v >> 16) & 0xFF;
+    p[3] = (v >> 24) & 0xFF;
+}
+
+static u32b _get_u32b(const byte *p)
+{
+    return p[0] | ((u32b)p[1] << 8) | ((u32b)p[2] << 16) | ((u32b)p[3] << 24);
+}
+
+static int _lz_key(const byte *p)
+{
+    return ((p[0] << 10) ^ (p[1] << 5) ^ p[2]) & (_LZ_HASH - 1);
+}
+
+/* Compress src[0..n) into dest, which must hold n + n/8 + 1 bytes.
+ * Returns the compressed size. */
+static int _lz_compress(const byte *src, int n, byte *dest)
+{
+    int *head, *prev;
+    int  i = 0, out = 0, flag_pos = 0, items = 8;
+
+    C_MAKE(head, _LZ_HASH, int);
+    C_MAKE(prev, _LZ_WINDOW + 1, int);
+    for (i = 0; i < _LZ_HASH; i++) head[i] = -1;
+
+    i = 0;
+    while (i < n)
+    {
+        int best_len = 0, best_dist = 0;
+
+        if (items == 8)
+        {
+            flag_pos = out++;
+            dest[flag_pos] = 0;
+            items = 0;
+        }
+
+        if (i + _LZ_MIN <= n)
+        {
+            int key = _lz_key(src + i);
+            int cand = head[key];
+            int chain = _LZ_CHAIN;
+            int max = MIN(_LZ_MAX, n - i);
+
+            while (cand >= 0 && i - cand <= _LZ_WINDOW && chain--)
+            {
+                int len = 0;
+                while (len < max && src[cand + len] == src[i + len]) len++;
+                if (len > best_len)
+                {
+                    best_len = len;
+                    best_dist = i - cand;
+                    if (len == max) break;
+                }
+                cand = prev[cand % (_LZ_WINDOW + 1)];
+            }
+        }
+
+        if (best_len >= _LZ_MIN)
+        {
+            int j;
+            dest[flag_pos] |= 1 << items;
+            dest[out++] = best_dist & 0xFF;
+            dest[out++] = (best_dist >> 8) & 0xFF;
+            dest[out++] = best_len - _LZ_MIN;
+            for (j = 0; j < best_len; j++, i++)
+            {
+                if (i + _LZ_MIN <= n)
+                {
+                    int key = _lz_key(src + i);
+                    prev[i % (_LZ_WINDOW + 1)] = head[key];
+                    head[key] = i;
+                }
+            }
+        }
+        else
+        {
+            if (i + _LZ_MIN <= n)
+            {
+                int key = _lz_key(src + i);
+                prev[i % (_LZ_WINDOW + 1)] = head[key];
+                head[key] = i;
+            }
+            dest[out++] = src[i++];
+        }
+        items++;
+    }
+
+    C_KILL(head, _LZ_HASH, int);
+    C_KILL(prev, _LZ_WINDOW + 1, int);
+    return out;
+}
+
+/* Returns FALSE if src is not exactly n bytes worth of lz data */
+static bool _lz_decompress(const byte *src, int len, byte *dest, int n)
+{
+    int  i = 0, out = 0;
+    byte flags = 0;
+    int  items = 8;
+
+    while (out < n)
+    {
+        if (items == 8)
+        {
+            if (i >= len) return FALSE;
+            flags = src[i++];
+            items = 0;
+        }
+        if (flags & (1 << items))
+        {
+            int dist, cb;
+            if (i + 3 > len) return FALSE;
+            dist = src[i] | (src[i + 1] << 8);
+            cb = src[i + 2] + _LZ_MIN;
+            i += 3;
+            if (!dist || dist > out || out + cb > n) return FALSE;
+            for (; cb > 0; cb--, out++)
+                dest[out] = dest[out - dist];
+        }
+        else
+        {
+            if (i >= len) return FALSE;
+            dest[out++] = src[i++];
+        }
+        items++;
+    }
+    return i == len;
+}
+
+/* Read an entire compressed container into file->buf */
+static bool _read_container(savefile_ptr file)
+{
+    byte *data = NULL;
+    int   size = 0, len, n, i;
+    u32b  sum, want;
+
+    /* Gather the rest of the file; file->buf already holds the first block */
+    len = file->buf_len;
+    size = MAX(len, _BLOCK_SIZE) * 2;
+    C_MAKE(data, size, byte);
+    memcpy(data, file->buf, len);
+    for (;;)
+    {
+        if (len == size)
+        {
+            byte *tmp;
+            if (size >= _CONTAINER_MAX)
+            {
+                C_KILL(data, size, byte);
+                return FALSE;
+            }
+            C_MAKE(tmp, size * 2, byte);
+            memcpy(tmp, data, len);
+            C_KILL(data, size, byte);
+            data = tmp;
+            size *= 2;
+        }
+        n = fread(data + len, 1, size - len, file->file);
+        if (n <= 0) break;
+        len += n;
+    }
+
+    if (len < 12 || ferror(file->file))
+    {
+        C_KILL(data, size, byte);
+        return FALSE;
+    }
+
+    want = _get_u32b(data + 4);
+    sum = _get_u32b(data + 8);
+    if (!_container_fits(want, len - 12))
+    {
+        C_KILL(data, size, byte);
+        return FALSE;
+    }
+    n = want;
+
+    C_KILL(file->buf, file->buf_size, byte);
+    file->buf_size = MAX(n, 1);
+    C_MAKE(file->buf, file->buf_size, byte);
+
+    if (!_lz_decompress(data + 12, len - 12, file->buf, n))
+    {
+        C_KILL(data, size, byte);
+        return FALSE;
+    }
+    C_KILL(data, size, byte);
+
+    for (i = 1; i < n; i++)
+        file->buf[i] ^= file->buf[i - 1];
+
+    if (_hash(file->buf, n) != sum) return FALSE;
+
+    file->buf_len = n;
+    file->buf_pos = 0;
+    file->compress = TRUE;
+    return TRUE;
+}
+
+/* Refill the read buffer; returns the next byte or EOF */
+static int _fill(savefile_ptr file)
+{
+    if (file->compress) return EOF;
+    file->buf_pos = 0;
+    file->buf_len = fread(file->buf, 1, file->buf_size, file->file);
+    if (file->buf_len <= 0)
+    {
+        file->buf_len = 0;
+        return EOF;
+    }
+    return file->buf[file->buf_pos++];
+}
+
+static bool _flush(savefile_ptr file)
+{
+    if (file->buf_pos && fwrite(file->buf, 1, file->buf_pos, file->file) != (size_t)file->buf_pos)
+        file->error = TRUE;
+    file->buf_pos = 0;
+    return !file->error;
+}
+
+/* Write the whole stream as a compressed container */
+static bool _write_container(savefile_ptr file)
+{
+    byte *data;
+    byte  head[12];
+    int   n = file->buf_pos, len, i;
+
+    memcpy(head, _magic, 4);
+    _put_u32b(head + 4, n);
+    _put_u32b(head + 8, _hash(file->buf, n));
+
+    for (i = n - 1; i > 0; i--)
+        file->buf[i] ^= file->buf[i - 1];
+
+    C_MAKE(data, n + n/8 + 1, byte);
+    len = _lz_compress(file->buf, n, data);
+
+    if ( fwrite(head, 1, sizeof(head), file->file) != sizeof(head)
+      || fwrite(data, 1, len, file->file) != (size_t)len )
+    {
+        file->error = TRUE;
+    }
+    C_KILL(data, n + n/8 + 1, byte);
+    file->buf_pos = 0;
+    return !file->error;
+}
+
+static void _grow(savefile_ptr file)
+{
+    byte *tmp;
+    C_MAKE(tmp, file->buf_size * 2, byte);
+    memcpy(tmp, file->buf, file->buf_pos);
+    C_KILL(file->buf, file->buf_size, byte);
+    file->buf = tmp;
+    file->buf_size *= 2;
+}
+
+static int _getc(savefile_ptr file)
+{
+    if (file->buf_pos < file->buf_len)
+        return file->buf[file->buf_pos++];
+    return _fill(file);
+}
+
+static void _putc(savefile_ptr file, byte c)
+{
+    if (file->buf_pos == file->buf_size)
+    {
+        if (file->compress || file->async) _grow(file);
+        else _flush(file);
+    }
+    file->buf[file->buf_pos++] = c;
+}
+
+static bool _write_async(savefile_ptr file);
+static savefile_ptr _writer_find(const char *name);
+static void _free(savefile_ptr file);
+
+/************************************************************************
+ * Savefiles
+ ************************************************************************/
 savefile_ptr savefile_open_read(const char *name)
 {
     savefile_ptr result = NULL;
-    FILE *fff;
-    
-    safe_setuid_grab();
-    fff = my_fopen(name, "rb");
-    safe_setuid_drop();
+    savefile_ptr pending = _writer_find(name);
+    FILE *fff = NULL;
 
-    if (!fff) return NULL;
+    /* A file still being written is read straight from memory */
+    if (!pending)
+    {
+        safe_setuid_grab();
+        fff = my_fopen(name, "rb");
+        safe_setuid_drop();
+
+        if (!fff) return NULL;
+    }
 
     result = malloc(sizeof(savefile_t));
     memset(result, 0, sizeof(savefile_t));
     result->file = fff;
     result->type = SAVEFILE_READ;
+    result->buf_size = pending ? MAX(pending->buf_pos, 1) : _BLOCK_SIZE;
+    C_MAKE(result->buf, result->buf_size, byte);
+
+    if (pending)
+    {
+        memcpy(result->buf, pending->buf, pending->buf_pos);
+        result->buf_len = pending->buf_pos;
+        result->compress = TRUE;
+    }
+    else _fill(result);
+    result->buf_pos = 0;
+    if (fff && result->buf_len >= 4 && !memcmp(result->buf, _magic, 4) && !_read_container(result))
+    {
+        /* A damaged container reads as an empty (and failing) file */
+        result->buf_len = 0;
+        result->compress = TRUE;
+        result->error = TRUE;
+    }
 
-    result->version.major = getc(result->file);
-    result->version.minor = getc(result->file);
-    result->version.patch = getc(result->file);
-    result->version.extra = getc(result->file);
+    result->version.major = _getc(result);
+    result->version.minor = _getc(result);
+    result->version.patch = _getc(result);
+    result->version.extra = _getc(result);
     result->xor_byte = 0;
     savefile_read_byte(result);
     result->pos = 4;
@@ -63,12 +423,47 @@ savefile_ptr savefile_open_read(const char *name)
     return result;
 }
 
+static savefile_ptr _open_write(FILE *fff, const char *name)
+{
+    savefile_ptr result = malloc(sizeof(savefile_t));
+
+    memset(result, 0, sizeof(savefile_t));
+    result->file = fff;
+    result->type = SAVEFILE_WRITE;
+    result->buf_size = _BLOCK_SIZE;
+    C_MAKE(result->buf, result->buf_size, byte);
+    result->compress = compress_savefile;
+    if (name)
+    {
+        result->async = TRUE;
+        result->name = z_string_make(name);
+    }
+
+    /* Dump the file header */
+    _putc(result, VER_MAJOR);
+    _putc(result, VER_MINOR);
+    _putc(result, VER_PATCH);
+    _putc(result, VER_EXTRA);
+
+    result->xor_byte = 0;
+    result->pos = 3;
+    savefile_write_byte(result, randint0(256));
+
+    /* Reset the checksum */
+    result->v_check = 0;
+    result->x_check = 0;
+
+    return result;
+}
+
 savefile_ptr savefile_open_write(const char *name)
 {
-    savefile_ptr result = NULL;
     FILE *fff = NULL;
     int   fd = -1;
-    
+
+    /* The last write of this file must land first */
+    savefile_wait(name);
+
     safe_setuid_grab();
     fd_kill(name);
     safe_setuid_drop();
@@ -87,36 +482,207 @@ savefile_ptr savefile_open_write(const char *name)
 
     if (!fff) return NULL;
 
-    result = malloc(sizeof(savefile_t));
-    memset(result, 0, sizeof(savefile_t));
-    result->file = fff;
-    result->type = SAVEFILE_WRITE;
+    return _open_write(fff, NULL);
+}
 
-    /* Dump the file header */
-    putc(VER_MAJOR, result->file);
-    putc(VER_MINOR, result->file);
-    putc(VER_PATCH, result->file);
-    putc(VER_EXTRA, result->file);
+/* Like savefile_open_write, but nothing touches the disk until
+ * savefile_close(), which hands the stream to a background writer. */
+savefile_ptr savefile_open_async(const char *name)
+{
+    /* The last write of this file goes first */
+    savefile_wait(name);
+    return _open_write(NULL, name);
+}
 
-    result->xor_byte = 0;
-    result->pos = 3;
-    savefile_write_byte(result, randint0(256));
+bool savefile_close(savefile_ptr file)
+{
+    errr err = -1;
 
-    /* Reset the checksum */
-    result->v_check = 0;
-    result->x_check = 0;
+    if (file->async)
+    {
+        if (!file->error) return _write_async(file);
+    }
+    else
+    {
+        if (file->type == SAVEFILE_WRITE && !file->error)
+        {
+            if (file->compress) _write_container(file);
+            else _flush(file);
+        }
+        err = file->file ? my_fclose(file->file) : 0;
+        if (file->error) err = -1;
+    }
 
-    return result;
+    _free(file);
+    return err ? FALSE : TRUE;
 }
 
-bool savefile_close(savefile_ptr file)
+bool savefile_error(savefile_ptr file)
 {
-    errr err = -1;
-    if (file->file)
-        err = my_fclose(file->file);
+    return file->error || (file->file && ferror(file->file));
+}
 
+/************************************************************************
+ * Background writers
+ *
+ * An async savefile is built in memory (its stream grows like a
+ * compressed one), and savefile_close() forks a child to compress it,
+ * write it beside its target, fsync it and rename it into place, so a
+ * reader only ever sees the old file or the new one. The game goes on
+ * at once and keeps the stream until the child is done, so that
+ * savefile_open_read() can read a file being written from memory.
+ *
+ * savefile_poll() notes the writers that are done, without waiting, and
+ * only then calls the file's done hook (for the character, that marks
+ * it saved). savefile_wait() is the barrier: it blocks until the writer
+ * of a file, or every writer, is done. A file is waited for before it is
+ * written again or deleted, so two writes of it never land out of order,
+ * and save_player() waits for all of them. Without fork(), the same steps
+ * just run in savefile_close().
+ ************************************************************************/
+#define _MAX_WRITERS 8
+
+typedef struct {
+    int          pid;
+    savefile_ptr file;
+} _writer_t;
+
+static _writer_t _writers[_MAX_WRITERS];
+static int       _writer_ct = 0;
+
+static void _free(savefile_ptr file)
+{
+    z_string_free(file->name);
+    C_KILL(file->buf, file->buf_size, byte);
     free(file);
-    return err ? FALSE : TRUE;
+}
+
+/* Write the whole stream to file->name through a temporary file */
+static bool _write_atomic(savefile_ptr file)
+{
+    char tmp[1024];
+    bool ok;
+
+    strnfmt(tmp, sizeof(tmp), "%s.bg", file->name);
+
+    FILE_TYPE(FILE_TYPE_SAVE);
+    safe_setuid_grab();
+    fd_kill(tmp);
+    file->file = my_fopen(tmp, "wb");
+    safe_setuid_drop();
+    if (!file->file) return FALSE;
+
+    if (file->compress) _write_container(file);
+    else _flush(file);
+
+    ok = !file->error && fflush(file->file) != EOF;
+#ifdef SET_UID
+    if (ok && fsync(fileno(file->file))) ok = FALSE;
+#endif
+    if (my_fclose(file->file)) ok = FALSE;
+    file->file = NULL;
+
+    safe_setuid_grab();
+    if (ok) ok = !rename(tmp, file->name);
+    if (!ok) fd_kill(tmp);
+    safe_setuid_drop();
+
+    return ok;
+}
+
+static savefile_ptr _writer_find(const char *name)
+{
+    int i;
+    for (i = 0; i < _writer_ct; i++)
+    {
+        if (streq(_writers[i].file->name, name))
+            return _writers[i].file;
+    }
+    return NULL;
+}
+
+#ifdef SET_UID
+/* Reap writer i, blocking if asked. Returns FALSE if it is still running.
+ * The list is left whole first, since the done hook or a failure message
+ * may come back here. */
+static bool _reap(int i, bool block)
+{
+    _writer_t w = _writers[i];
+    int       status = 0;
+    int       pid;
+
+    do
+        pid = waitpid(w.pid, &status, block ? 0 : WNOHANG);
+    while (pid < 0 && errno == EINTR);
+
+    if (pid == 0) return FALSE;
+
+    for (; i < _writer_ct - 1; i++)
+        _writers[i] = _writers[i + 1];
+    _writer_ct--;
+
+    if (pid < 0 || !WIFEXITED(status) || WEXITSTATUS(status))
+        msg_format("<color:v>Error:</color> Failed to write <color:y>%s</color>.", w.file->name);
+    else if (w.file->done)
+        w.file->done();
+    _free(w.file);
+    return TRUE;
+}
+#endif
+
+static bool _write_async(savefile_ptr file)
+{
+    bool ok;
+#ifdef SET_UID
+    int  pid;
+
+    /* Make room */
+    savefile_poll();
+    if (_writer_ct == _MAX_WRITERS)
+        _reap(0, TRUE);
+
+    /* Make sure nothing buffered gets written twice */
+    fflush(NULL);
+
+    pid = fork();
+    if (pid == 0)
+        _exit(_write_atomic(file) ? 0 : 1);
+    if (pid > 0)
+    {
+        _writers[_writer_ct].pid = pid;
+        _writers[_writer_ct].file = file;
+        _writer_ct++;
+        return TRUE;
+    }
+#endif
+    ok = _write_atomic(file);
+    if (ok && file->done) file->done();
+    _free(file);
+    return ok;
+}
+
+void savefile_poll(void)
+{
+#ifdef SET_UID
+    int i;
+    for (i = _writer_ct - 1; i >= 0; i--)
+    {
+        if (i < _writer_ct) _reap(i, FALSE);
+    }
+#endif
+}
+
+void savefile_wait(const char *name)
+{
+#ifdef SET_UID
+    int i;
+    for (i = _writer_ct - 1; i >= 0; i--)
+    {
+        if (i >= _writer_ct) continue;
+        if (!name || streq(_writers[i].file->name, name))
+            _reap(i, TRUE);
+    }
+#endif
 }
 
 byte savefile_read_byte(savefile_ptr file)
@@ -125,7 +691,7 @@ byte savefile_read_byte(savefile_ptr file)
 
     assert(file->type == SAVEFILE_READ);
 
-    c = getc(file->file);
+    c = _getc(file);
     c = c & 0xFF;
     v = c ^ file->xor_byte;
     file->xor_byte = c;
@@ -141,7 +707,7 @@ void savefile_write_byte(savefile_ptr file, byte v)
     assert(file->type == SAVEFILE_WRITE);
 
     file->xor_byte ^= v;
-    putc(file->xor_byte, file->file);
+    _putc(file, file->xor_byte);
     file->v_check += v;
     file->x_check += file->xor_byte;
     file->pos++;
@@ -250,3 +816,98 @@ void savefile_read_skip(savefile_ptr file, int cb)
         savefile_read_byte(file);
 }
 
+
+/************************************************************************
+ * Debug
+ ************************************************************************/
+
+/*
+ * Debug -- write the current level (grid by grid, as wr_saved_floor does)
+ * through a compressed container in a scratch file and read it back. Also
+ * feed the reader a container that claims far more than its data could
+ * hold, which must be refused rather than allocated. Returns the number
+ * of bytes that came back wrong, plus one for each failed step.
+ */
+int savefile_verify(void)
+{
+    savefile_t w, r;
+    byte       head[12];
+    int        y, x, n, bad = 0;
+    FILE      *fff = tmpfile();
+
+    if (!fff) return 0;
+
+    memset(&w, 0, sizeof(w));
+    w.file = fff;
+    w.type = SAVEFILE_WRITE;
+    w.compress = TRUE;
+    w.buf_size = _BLOCK_SIZE;
+    C_MAKE(w.buf, w.buf_size, byte);
+    for (y = 0; y < cur_hgt; y++)
+    {
+        for (x = 0; x < cur_wid; x++)
+        {
+            cave_type *c_ptr = &cave[y][x];
+            savefile_write_u32b(&w, c_ptr->info);
+            savefile_write_s16b(&w, c_ptr->feat);
+            savefile_write_s16b(&w, c_ptr->o_idx);
+            savefile_write_s16b(&w, c_ptr->m_idx);
+            savefile_write_s16b(&w, c_ptr->mimic);
+        }
+    }
+    n = w.pos;
+    if (!_write_container(&w)) bad++;
+    C_KILL(w.buf, w.buf_size, byte);
+
+    memset(&r, 0, sizeof(r));
+    r.file = fff;
+    r.type = SAVEFILE_READ;
+    r.buf_size = _BLOCK_SIZE;
+    C_MAKE(r.buf, r.buf_size, byte);
+    rewind(fff);
+    _fill(&r);
+    if (!_read_container(&r) || r.buf_len != n) bad++;
+    else
+    {
+        for (y = 0; y < cur_hgt; y++)
+        {
+            for (x = 0; x < cur_wid; x++)
+            {
+                cave_type *c_ptr = &cave[y][x];
+                if (savefile_read_u32b(&r) != c_ptr->info) bad++;
+                if (savefile_read_s16b(&r) != c_ptr->feat) bad++;
+                if (savefile_read_s16b(&r) != c_ptr->o_idx) bad++;
+                if (savefile_read_s16b(&r) != c_ptr->m_idx) bad++;
+                if (savefile_read_s16b(&r) != c_ptr->mimic) bad++;
+            }
+        }
+    }
+    C_KILL(r.buf, r.buf_size, byte);
+
+    fclose(fff);
+
+    /* A few bytes of lz data claiming more than they could ever hold */
+    for (n = 0; n < 2; n++)
+    {
+        fff = tmpfile();
+        if (!fff) break;
+        memcpy(head, _magic, 4);
+        _put_u32b(head + 4, n ? 0x7FFFFFFF : 0x100000);
+        _put_u32b(head + 8, 0);
+        fwrite(head, 1, sizeof(head), fff);
+        fwrite(head, 1, sizeof(head), fff);
+        rewind(fff);
+
+        memset(&r, 0, sizeof(r));
+        r.file = fff;
+        r.type = SAVEFILE_READ;
+        r.buf_size = _BLOCK_SIZE;
+        C_MAKE(r.buf, r.buf_size, byte);
+        _fill(&r);
+        if (_container_fits(_get_u32b(head + 4), 12)) bad++;
+        if (_read_container(&r)) bad++;
+        C_KILL(r.buf, r.buf_size, byte);
+        fclose(fff);
+    }
+    return bad;
+}
@@ -15,6 +15,10 @@ enum {
     SAVEFILE_WRITE
 };
 
+/* Bytes go through a block buffer rather than getc/putc. A compressed
+ * savefile (see compress_savefile) is held whole in the buffer instead,
+ * and is (de)compressed on close (open), as is an async one, which is
+ * handed to a background writer on close. */
 typedef struct savefile_s {
     FILE     *file;
     int       type;     /* READ or WRITE */
@@ -23,11 +27,25 @@ typedef struct savefile_s {
     u32b      x_check;
     version_t version;
     int       pos;
+    byte     *buf;
+    int       buf_pos;
+    int       buf_len;  /* READ: bytes in buf */
+    int       buf_size;
+    bool      compress;
+    bool      error;
+    bool      async;
+    cptr      name;     /* async: the file to write */
+    void    (*done)(void); /* async: called once the file is on disk */
 } savefile_t, *savefile_ptr;
 
 extern savefile_ptr savefile_open_read(const char *name);
 extern savefile_ptr savefile_open_write(const char *name);
+extern savefile_ptr savefile_open_async(const char *name);
 extern bool         savefile_close(savefile_ptr file);
+extern bool         savefile_error(savefile_ptr file);
+extern void         savefile_poll(void);
+extern void         savefile_wait(const char *name);
+extern int          savefile_verify(void);
 
 extern bool         savefile_is_older_than(savefile_ptr file, byte major, byte minor, byte patch, byte extra);
 
@@ -1034,36 +1034,52 @@ bool detect_treasure(int range)
 }
 
 
+/*
+ * Scratch lists for the detection routines below, which never nest. They
+ * are made the first time they are needed and kept.
+ */
+static s16b *_detect_what(void)
+{
+    static s16b *what = NULL;
+
+    if (!what) C_MAKE(what, max_o_idx, s16b);
+    return what;
+}
+
+static s16b *_detect_who(void)
+{
+    static s16b *who = NULL;
+
+    if (!who) C_MAKE(who, max_m_idx, s16b);
+    return who;
+}
+
+
 /*
  * Detect all "gold" objects on the current panel
  */
 bool detect_objects_gold(int range)
 {
-    int i, y, x;
+    int j, n, y, x;
+    s16b *what;
     int range2 = range;
 
     bool detect = FALSE;
 
     if (d_info[dungeon_type].flags1 & DF1_DARKNESS) range2 /= 3;
 
+    what = _detect_what();
+    n = obj_in_radius(py, px, range2, what);
+
     /* Scan objects */
-    for (i = 1; i < o_max; i++)
+    for (j = 0; j < n; j++)
     {
-        object_type *o_ptr = &o_list[i];
-
-        /* Skip dead objects */
-        if (!o_ptr->k_idx) continue;
-
-        /* Skip held objects */
-        if (o_ptr->held_m_idx) continue;
+        object_type *o_ptr = &o_list[what[j]];
 
         /* Location */
         y = o_ptr->loc.y;
         x = o_ptr->loc.x;
 
-        /* Only detect nearby objects */
-        if (distance(py, px, y, x) > range2) continue;
-
         /* Detect "gold" objects */
         if (o_ptr->tval == TV_GOLD)
         {
@@ -1102,31 +1118,26 @@ bool detect_objects_gold(int range)
  */
 bool detect_objects_normal(int range)
 {
-    int i, y, x;
+    int j, n, y, x;
+    s16b *what;
     int range2 = range;
 
     bool detect = FALSE;
 
     if (d_info[dungeon_type].flags1 & DF1_DARKNESS) range2 /= 3;
 
+    what = _detect_what();
+    n = obj_in_radius(py, px, range2, what);
+
     /* Scan objects */
-    for (i = 1; i < o_max; i++)
+    for (j = 0; j < n; j++)
     {
-        object_type *o_ptr = &o_list[i];
-
-        /* Skip dead objects */
-        if (!o_ptr->k_idx) continue;
-
-        /* Skip held objects */
-        if (o_ptr->held_m_idx) continue;
+        object_type *o_ptr = &o_list[what[j]];
 
         /* Location */
         y = o_ptr->loc.y;
         x = o_ptr->loc.x;
 
-        /* Only detect nearby objects */
-        if (distance(py, px, y, x) > range2) continue;
-
         /* Detect "real" objects */
         if (o_ptr->tval != TV_GOLD)
         {
@@ -1172,30 +1183,25 @@ bool detect_objects_normal(int range)
  */
 bool detect_objects_magic(int range)
 {
-    int i, y, x, tv;
+    int j, n, y, x, tv;
+    s16b *what;
 
     bool detect = FALSE;
 
     if (d_info[dungeon_type].flags1 & DF1_DARKNESS) range /= 3;
 
+    what = _detect_what();
+    n = obj_in_radius(py, px, range, what);
+
     /* Scan all objects */
-    for (i = 1; i < o_max; i++)
+    for (j = 0; j < n; j++)
     {
-        object_type *o_ptr = &o_list[i];
-
-        /* Skip dead objects */
-        if (!o_ptr->k_idx) continue;
-
-        /* Skip held objects */
-        if (o_ptr->held_m_idx) continue;
+        object_type *o_ptr = &o_list[what[j]];
 
         /* Location */
         y = o_ptr->loc.y;
         x = o_ptr->loc.x;
 
-        /* Only detect nearby objects */
-        if (distance(py, px, y, x) > range) continue;
-
         /* Examine the tval */
         tv = o_ptr->tval;
 
@@ -1256,28 +1262,23 @@ bool detect_objects_magic(int range)
  */
 bool detect_monsters_normal(int range)
 {
-    int i, y, x;
+    int j, n;
+    s16b *who;
 
     bool flag = FALSE;
 
     if (d_info[dungeon_type].flags1 & DF1_DARKNESS) range /= 3;
 
+    who = _detect_who();
+    n = mon_in_radius(py, px, range, who);
+
     /* Scan monsters */
-    for (i = 1; i < m_max; i++)
+    for (j = 0; j < n; j++)
     {
+        int i = who[j];
         monster_type *m_ptr = &m_list[i];
         monster_race *r_ptr = &r_info[m_ptr->r_idx];
 
-        /* Skip dead monsters */
-        if (!m_ptr->r_idx) continue;
-
-        /* Location */
-        y = m_ptr->fy;
-        x = m_ptr->fx;
-
-        /* Only detect nearby monsters */
-        if (distance(py, px, y, x) > range) continue;
-
         /* Detect all non-invisible monsters */
         if (!(r_ptr->flags2 & RF2_INVISIBLE) || p_ptr->see_inv)
         {
@@ -1315,27 +1316,22 @@ bool detect_monsters_normal(int range)
  */
 bool detect_monsters_invis(int range)
 {
-    int i, y, x;
+    int j, n;
+    s16b *who;
     bool flag = FALSE;
 
     if (d_info[dungeon_type].flags1 & DF1_DARKNESS) range /= 3;
 
+    who = _detect_who();
+    n = mon_in_radius(py, px, range, who);
+
     /* Scan monsters */
-    for (i = 1; i < m_max; i++)
+    for (j = 0; j < n; j++)
     {
+        int i = who[j];
         monster_type *m_ptr = &m_list[i];
         monster_race *r_ptr = &r_info[m_ptr->r_idx];
 
-        /* Skip dead monsters */
-        if (!m_ptr->r_idx) continue;
-
-        /* Location */
-        y = m_ptr->fy;
-        x = m_ptr->fx;
-
-        /* Only detect nearby monsters */
-        if (distance(py, px, y, x) > range) continue;
-
         /* Detect invisible monsters */
         if (r_ptr->flags2 & RF2_INVISIBLE)
         {
@@ -1381,27 +1377,22 @@ bool detect_monsters_invis(int range)
  */
 bool detect_monsters_evil(int range)
 {
-    int i, y, x;
+    int j, n;
+    s16b *who;
     bool flag = FALSE;
 
     if (d_info[dungeon_type].flags1 & DF1_DARKNESS) range /= 3;
 
+    who = _detect_who();
+    n = mon_in_radius(py, px, range, who);
+
     /* Scan monsters */
-    for (i = 1; i < m_max; i++)
+    for (j = 0; j < n; j++)
     {
+        int i = who[j];
         monster_type *m_ptr = &m_list[i];
         monster_race *r_ptr = &r_info[m_ptr->r_idx];
 
-        /* Skip dead monsters */
-        if (!m_ptr->r_idx) continue;
-
-        /* Location */
-        y = m_ptr->fy;
-        x = m_ptr->fx;
-
-        /* Only detect nearby monsters */
-        if (distance(py, px, y, x) > range) continue;
-
         /* Detect evil monsters */
         if (r_ptr->flags3 & RF3_EVIL)
         {
@@ -1442,27 +1433,22 @@ bool detect_monsters_evil(int range)
  */
 bool detect_monsters_nonliving(int range)
 {
-    int     i, y, x;
+    int     j, n;
+    s16b    *who;
     bool    flag = FALSE;
 
     if (d_info[dungeon_type].flags1 & DF1_DARKNESS) range /= 3;
 
+    who = _detect_who();
+    n = mon_in_radius(py, px, range, who);
+
     /* Scan monsters */
-    for (i = 1; i < m_max; i++)
+    for (j = 0; j < n; j++)
     {
+        int i = who[j];
         monster_type *m_ptr = &m_list[i];
         monster_race *r_ptr = &r_info[m_ptr->r_idx];
 
-        /* Skip dead monsters */
-        if (!m_ptr->r_idx) continue;
-
-        /* Location */
-        y = m_ptr->fy;
-        x = m_ptr->fx;
-
-        /* Only detect nearby monsters */
-        if (distance(py, px, y, x) > range) continue;
-
         /* Detect non-living monsters */
         if (!monster_living(r_ptr))
         {
@@ -1504,23 +1490,21 @@ bool detect_monsters_nonliving(int range)
  */
 bool detect_monsters_living(int range, cptr msg)
 {
-    int     i, y, x;
+    int     j, n;
+    s16b    *who;
     bool    flag = FALSE;
 
     if (d_info[dungeon_type].flags1 & DF1_DARKNESS) range /= 3;
+    who = _detect_who();
+    n = mon_in_radius(py, px, range, who);
+
 
-    for (i = 1; i < m_max; i++)
+    for (j = 0; j < n; j++)
     {
+        int i = who[j];
         monster_type *m_ptr = &m_list[i];
         monster_race *r_ptr = &r_info[m_ptr->r_idx];
 
-        if (!m_ptr->r_idx) continue;
-
-        y = m_ptr->fy;
-        x = m_ptr->fx;
-
-        if (distance(py, px, y, x) > range) continue;
-
         if (monster_living(r_ptr))
         {
             /* Update monster recall window */
@@ -1542,27 +1526,22 @@ bool detect_monsters_living(int range, cptr msg)
 
 bool detect_monsters_magical(int range)
 {
-    int     i, y, x;
+    int     j, n;
+    s16b    *who;
     bool    flag = FALSE;
 
     if (d_info[dungeon_type].flags1 & DF1_DARKNESS) range /= 3;
 
+    who = _detect_who();
+    n = mon_in_radius(py, px, range, who);
+
     /* Scan monsters */
-    for (i = 1; i < m_max; i++)
+    for (j = 0; j < n; j++)
     {
+        int i = who[j];
         monster_type *m_ptr = &m_list[i];
         monster_race *r_ptr = &r_info[m_ptr->r_idx];
 
-        /* Skip dead monsters */
-        if (!m_ptr->r_idx) continue;
-
-        /* Location */
-        y = m_ptr->fy;
-        x = m_ptr->fx;
-
-        /* Only detect nearby monsters */
-        if (distance(py, px, y, x) > range) continue;
-
         /* Detect non-living monsters */
         if (monster_magical(r_ptr))
         {
@@ -1602,27 +1581,22 @@ bool detect_monsters_magical(int range)
  */
 bool detect_monsters_mind(int range)
 {
-    int     i, y, x;
+    int     j, n;
+    s16b    *who;
     bool    flag = FALSE;
 
     if (d_info[dungeon_type].flags1 & DF1_DARKNESS) range /= 3;
 
+    who = _detect_who();
+    n = mon_in_radius(py, px, range, who);
+
     /* Scan monsters */
-    for (i = 1; i < m_max; i++)
+    for (j = 0; j < n; j++)
     {
+        int i = who[j];
         monster_type *m_ptr = &m_list[i];
         monster_race *r_ptr = &r_info[m_ptr->r_idx];
 
-        /* Skip dead monsters */
-        if (!m_ptr->r_idx) continue;
-
-        /* Location */
-        y = m_ptr->fy;
-        x = m_ptr->fx;
-
-        /* Only detect nearby monsters */
-        if (distance(py, px, y, x) > range) continue;
-
         /* Detect non-living monsters */
         if (!(r_ptr->flags2 & RF2_EMPTY_MIND))
         {
@@ -1665,27 +1639,22 @@ bool detect_monsters_mind(int range)
  */
 bool detect_monsters_string(int range, cptr Match)
 {
-    int i, y, x;
+    int j, n;
+    s16b *who;
     bool flag = FALSE;
 
     if (d_info[dungeon_type].flags1 & DF1_DARKNESS) range /= 3;
 
+    who = _detect_who();
+    n = mon_in_radius(py, px, range, who);
+
     /* Scan monsters */
-    for (i = 1; i < m_max; i++)
+    for (j = 0; j < n; j++)
     {
+        int i = who[j];
         monster_type *m_ptr = &m_list[i];
         monster_race *r_ptr = &r_info[m_ptr->r_idx];
 
-        /* Skip dead monsters */
-        if (!m_ptr->r_idx) continue;
-
-        /* Location */
-        y = m_ptr->fy;
-        x = m_ptr->fx;
-
-        /* Only detect nearby monsters */
-        if (distance(py, px, y, x) > range) continue;
-
         /* Detect monsters with the same symbol */
         if (my_strchr(Match, r_ptr->d_char))
         {
@@ -1730,28 +1699,23 @@ bool detect_monsters_string(int range, cptr Match)
  */
 bool detect_monsters_xxx(int range, u32b match_flag)
 {
-    int  i, y, x;
+    int  j, n;
+    s16b *who;
     bool flag = FALSE;
     cptr desc_monsters = "weird monsters";
 
     if (d_info[dungeon_type].flags1 & DF1_DARKNESS) range /= 3;
 
+    who = _detect_who();
+    n = mon_in_radius(py, px, range, who);
+
     /* Scan monsters */
-    for (i = 1; i < m_max; i++)
+    for (j = 0; j < n; j++)
     {
+        int i = who[j];
         monster_type *m_ptr = &m_list[i];
         monster_race *r_ptr = &r_info[m_ptr->r_idx];
 
-        /* Skip dead monsters */
-        if (!m_ptr->r_idx) continue;
-
-        /* Location */
-        y = m_ptr->fy;
-        x = m_ptr->fx;
-
-        /* Only detect nearby monsters */
-        if (distance(py, px, y, x) > range) continue;
-
         /* Detect evil monsters */
         if (r_ptr->flags3 & (match_flag))
         {
@@ -1833,18 +1797,21 @@ bool detect_all(int range)
  */
 bool project_hack(int typ, int dam)
 {
-    int     i, x, y;
+    int     j, n, x, y;
+    int     r = project_length > 0 ? project_length : MAX_RANGE;
     int     flg = PROJECT_JUMP | PROJECT_KILL | PROJECT_HIDE;
     bool    obvious = FALSE;
+    s16b   *who;
 
+    /* Nothing further away is projectable */
+    C_MAKE(who, max_m_idx, s16b);
+    if (project_length < 0) n = mon_in_rect(0, 0, MAX_HGT - 1, MAX_WID - 1, who);
+    else n = mon_in_rect(py - r, px - r, py + r, px + r, who);
 
     /* Mark all (nearby) monsters */
-    for (i = 1; i < m_max; i++)
+    for (j = 0; j < n; j++)
     {
-        monster_type *m_ptr = &m_list[i];
-
-        /* Paranoia -- Skip dead monsters */
-        if (!m_ptr->r_idx) continue;
+        monster_type *m_ptr = &m_list[who[j]];
 
         /* Location */
         y = m_ptr->fy;
@@ -1858,9 +1825,9 @@ bool project_hack(int typ, int dam)
     }
 
     /* Affect all marked monsters */
-    for (i = 1; i < m_max; i++)
+    for (j = 0; j < n; j++)
     {
-        monster_type *m_ptr = &m_list[i];
+        monster_type *m_ptr = &m_list[who[j]];
 
         /* Skip unmarked monsters */
         if (!(m_ptr->mflag & (MFLAG_TEMP))) continue;
@@ -1875,6 +1842,7 @@ bool project_hack(int typ, int dam)
         /* Jump directly to the target monster */
         if (project(0, 0, y, x, dam, typ, flg, -1)) obvious = TRUE;
     }
+    C_KILL(who, max_m_idx, s16b);
 
     /* Result */
     return (obvious);
@@ -1990,7 +1958,7 @@ void aggravate_monsters(int who)
 
 
     /* Aggravate everyone nearby */
-    for (i = 1; i < m_max; i++)
+    for_each_live_mon(i)
     {
         monster_type    *m_ptr = &m_list[i];
 /*        monster_race    *r_ptr = &r_info[m_ptr->r_idx]; */
@@ -2139,7 +2107,7 @@ bool symbol_genocide(int power, bool player_cast)
         return FALSE;
 
     /* Delete the monsters of that "type" */
-    for (i = 1; i < m_max; i++)
+    for_each_live_mon(i)
     {
         monster_type *m_ptr = &m_list[i];
         monster_race *r_ptr = &r_info[m_ptr->r_idx];
@@ -2174,7 +2142,7 @@ bool mass_genocide(int power, bool player_cast)
     if (p_ptr->inside_arena || p_ptr->inside_battle) return FALSE;
 
     /* Delete the (nearby) monsters */
-    for (i = 1; i < m_max; i++)
+    for_each_live_mon(i)
     {
         monster_type *m_ptr = &m_list[i];
 
@@ -2212,7 +2180,7 @@ bool mass_genocide_undead(int power, bool player_cast)
     if (p_ptr->inside_arena || p_ptr->inside_battle) return FALSE;
 
     /* Delete the (nearby) monsters */
-    for (i = 1; i < m_max; i++)
+    for_each_live_mon(i)
     {
         monster_type *m_ptr = &m_list[i];
         monster_race *r_ptr = &r_info[m_ptr->r_idx];
@@ -2260,7 +2228,7 @@ bool probing(void)
     Term->scr->cv = 1;
 
     /* Probe all (nearby) monsters */
-    for (i = 1; i < m_max; i++)
+    for_each_live_mon(i)
     {
         monster_type *m_ptr = &m_list[i];
         monster_race *r_ptr = &r_info[m_ptr->r_idx];
@@ -3023,10 +2991,10 @@ bool earthquake_aux(int cy, int cx, int r, int m_idx)
                         int m_idx = cave[yy][xx].m_idx;
 
                         /* Update the old location */
-                        cave[yy][xx].m_idx = 0;
+                        cave_set_m_idx(yy, xx, 0);
 
                         /* Update the new location */
-                        cave[sy][sx].m_idx = m_idx;
+                        cave_set_m_idx(sy, sx, m_idx);
 
                         /* Move the monster */
                         m_ptr->fy = sy;
@@ -3187,7 +3155,7 @@ void discharge_minion(void)
     int i;
     bool okay = TRUE;
 
-    for (i = 1; i < m_max; i++)
+    for_each_live_mon(i)
     {
         monster_type *m_ptr = &m_list[i];
         if (!m_ptr->r_idx || !is_pet(m_ptr)) continue;
@@ -3198,7 +3166,7 @@ void discharge_minion(void)
         if (!get_check("You will blast all pets. Are you sure? "))
             return;
     }
-    for (i = 1; i < m_max; i++)
+    for_each_live_mon(i)
     {
         int dam;
         int typ = GF_PLASMA;
@@ -129,10 +129,10 @@ bool teleport_away(int m_idx, int dis, u32b mode)
     sound(SOUND_TPOTHER);
 
     /* Update the old location */
-    cave[oy][ox].m_idx = 0;
+    cave_set_m_idx(oy, ox, 0);
 
     /* Update the new location */
-    cave[ny][nx].m_idx = m_idx;
+    cave_set_m_idx(ny, nx, m_idx);
 
     /* Move the monster */
     m_ptr->fy = ny;
@@ -232,10 +232,10 @@ void teleport_monster_to(int m_idx, int ty, int tx, int power, u32b mode)
     sound(SOUND_TPOTHER);
 
     /* Update the old location */
-    cave[oy][ox].m_idx = 0;
+    cave_set_m_idx(oy, ox, 0);
 
     /* Update the new location */
-    cave[ny][nx].m_idx = m_idx;
+    cave_set_m_idx(ny, nx, m_idx);
 
     /* Move the monster */
     m_ptr->fy = ny;
@@ -1597,8 +1597,8 @@ void fetch(int dir, int wgt, bool require_los)
     }
 
     i = c_ptr->o_idx;
-    c_ptr->o_idx = o_ptr->next_o_idx;
-    cave[py][px].o_idx = i; /* 'move' it */
+    cave_set_o_idx(ty, tx, o_ptr->next_o_idx);
+    cave_set_o_idx(py, px, i); /* 'move' it */
     o_ptr->next_o_idx = 0;
     o_ptr->loc.y = (byte)py;
     o_ptr->loc.x = (byte)px;
@@ -2289,9 +2289,6 @@ option_type option_info[] =
     { &display_percentages,         FALSE,  OPT_PAGE_TEXT, 1, 10,
     "display_percentages",          "Display percentages rather than status bars" },
 
-    { &compress_savefile,           FALSE, OPT_PAGE_TEXT, 1, 26,
-    "compress_savefile",            "Compress messages in savefiles" },
-
     { &abbrev_extra,                FALSE, OPT_PAGE_TEXT, 2, 10,
     "abbrev_extra",                 "Describe obj's extra resistances by abbreviation" },
 
@@ -2336,6 +2333,10 @@ option_type option_info[] =
     { &last_words,                  TRUE,  OPT_PAGE_GAMEPLAY, 0, 28,
     "last_words",                   "Leave last words when your character dies" },
 
+    /* Set on the autosave screen (see do_cmd_options_autosave) */
+    { &compress_savefile,           FALSE, 255, 1, 26,
+    "compress_savefile",            "Compress the savefile" },
+
 #ifdef ALLOW_WIZARD
     { &allow_debug_opts,            FALSE, OPT_PAGE_GAMEPLAY, 6, 11,
     "allow_debug_opts",             "Allow use of debug/cheat options" },
@@ -0,0 +1,41 @@
+#!/bin/sh
+#
+# Replay the keystroke scripts in this directory with the test front end
+# (see main-test.c) and check each final checksum against expected.txt:
+# once plainly, once with the reference routines ("-r") and once with
+# every cache checked as the game goes ("-v", which must find no errors).
+#
+# Usage: tests/run.sh [path to poschengband]
+#
+# The game must have been configured with --enable-test. Runs use a
+# scratch user and save directory, so nothing of yours is touched.
+#
+
+cd "$(dirname "$0")/.." || exit 1
+prog=${1:-./poschengband}
+tmp=$(mktemp -d) || exit 1
+trap 'rm -rf "$tmp"' EXIT
+cp tests/user-test.prf "$tmp/"
+
+fail=0
+while read -r script seed turns want; do
+    case "$script" in ''|'#'*) continue ;; esac
+
+    for mode in "" -r -v; do
+        out=$("$prog" -mtest -n -uTest -du="$tmp" -ds="$tmp" -- \
+            -ktests/"$script" -s"$seed" -n"$turns" $mode 2>&1)
+        got=$(echo "$out" | sed -n 's/^checksum: //p')
+        bad=$(echo "$out" | grep '^verify .*: [1-9]')
+
+        if [ "$got" != "$want" ] || [ -n "$bad" ]; then
+            echo "FAIL $script $mode: checksum ${got:-none}, expected $want"
+            [ -n "$bad" ] && echo "$bad"
+            fail=1
+        else
+            echo "ok   $script $mode"
+        fi
+        rm -f "${tmp:?}"/*Test*
+    done
+done < tests/expected.txt
+
+exit $fail
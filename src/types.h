@@ -495,6 +495,7 @@ struct monster_race
     s16b weight;
     byte freq_spell;          /* Spell frequency */
     byte drop_theme;
+    byte move_class;          /* Where it may go (see mon_move_init()) */
 
     u32b flags1;              /* Flags 1 (general) */
     u32b flags2;              /* Flags 2 (abilities) */
@@ -693,6 +694,7 @@ struct monster_type
     bool ml;        /* Monster is "visible" */
 
     s16b hold_o_idx;    /* Object being held (if any) */
+    s16b next_m_idx;    /* Next dead monster on the free list (see m_pop()) */
 
     s16b target_y;        /* Can attack !los player */
     s16b target_x;        /* Can attack !los player */
@@ -1763,6 +1765,49 @@ typedef struct
 } cave_template_type;
 
 
+/*
+ * A level generation context: a complete level (the cave, the monster
+ * and object lists and their bookkeeping), what it was built for, and
+ * the level generation random stream. generate_cave() builds into one
+ * while the current level is left alone, and gen_ctx_swap() then makes
+ * it the current level.
+ */
+typedef struct
+{
+    cave_type    *cave[MAX_HGT];
+    s16b          cur_hgt;
+    s16b          cur_wid;
+    s16b          py;
+    s16b          px;
+    byte         *spatial_mon;
+    byte         *spatial_obj;
+
+    monster_type *m_list;
+    s16b          m_max;
+    s16b          m_cnt;
+    s16b          m_free_list;
+    s16b         *mproc_list[MAX_MTIMED];
+    s16b          mproc_max[MAX_MTIMED];
+    u32b         *m_idle;
+    u32b         *m_live;
+    s16b          num_repro;
+    s16b          num_repro_kill;
+    s16b          unique_count;
+    pack_info_t  *pack_info_list;
+    s16b          pack_info_free_list;
+    s16b          pack_info_count;
+
+    object_type  *o_list;
+    s16b          o_max;
+    s16b          o_cnt;
+    s16b          o_free_list;
+
+    byte          dungeon_type;
+    s16b          dun_level;
+    rand_stream_t rand;
+} gen_ctx_type;
+
+
 /*
  * A structure type for arena entry
  */
@@ -1579,30 +1579,147 @@ static bool macro__use[256];
 
 
 /*
- * Find the macro (if any) which exactly matches the given pattern
+ * The macro patterns are kept in a trie, so that inkey_aux() can match
+ * what has been typed so far in time proportional to its length rather
+ * than the number of macros. Each node is a pattern prefix; its
+ * children are found by hashing (node, next character). As macros are
+ * never removed, and new ones always get the highest index, the first
+ * macro below a node is simply the first one added there.
  */
-sint macro_find_exact(cptr pat)
+typedef struct {
+    s16b macro;     /* Macro with exactly this pattern, or -1 */
+    s16b below;     /* First macro with a longer pattern starting with this, or -1 */
+} _macro_node_t;
+
+static _macro_node_t *_macro_nodes = NULL;
+static int            _macro_nodes_num = 0;
+static int            _macro_nodes_max = 0;
+
+static u32b *_macro_edge_key = NULL;  /* (node << 8 | char) + 1, 0 if empty */
+static int  *_macro_edge_node = NULL;
+static int   _macro_edges_max = 0;    /* A power of two */
+
+static int _macro_edge(int node, byte c)
+{
+    u32b key = ((u32b)node << 8 | c) + 1;
+    int  mask = _macro_edges_max - 1;
+    int  i = (u32b)(key * 2654435761UL) >> 8 & mask;
+
+    while (_macro_edge_key[i] && _macro_edge_key[i] != key)
+        i = (i + 1) & mask;
+    return i;
+}
+
+static int _macro_child(int node, byte c)
 {
     int i;
 
-    /* Nothing possible */
-    if (!macro__use[(byte)(pat[0])])
+    if (!_macro_edges_max) return -1;
+    i = _macro_edge(node, c);
+    return _macro_edge_key[i] ? _macro_edge_node[i] : -1;
+}
+
+static int _macro_node_add(void)
+{
+    if (_macro_nodes_num == _macro_nodes_max)
     {
-        return (-1);
+        _macro_node_t *old = _macro_nodes;
+        int            max = MAX(256, 2 * _macro_nodes_max);
+
+        C_MAKE(_macro_nodes, max, _macro_node_t);
+        if (old)
+        {
+            C_COPY(_macro_nodes, old, _macro_nodes_max, _macro_node_t);
+            C_KILL(old, _macro_nodes_max, _macro_node_t);
+        }
+        _macro_nodes_max = max;
     }
+    _macro_nodes[_macro_nodes_num].macro = -1;
+    _macro_nodes[_macro_nodes_num].below = -1;
+    return _macro_nodes_num++;
+}
 
-    /* Scan the macros */
-    for (i = 0; i < macro__num; ++i)
+/* Keep the edge table at most half full */
+static void _macro_edges_grow(void)
+{
+    u32b *old_key = _macro_edge_key;
+    int  *old_node = _macro_edge_node;
+    int   old_max = _macro_edges_max;
+    int   i;
+
+    _macro_edges_max = MAX(512, 2 * old_max);
+    C_MAKE(_macro_edge_key, _macro_edges_max, u32b);
+    C_MAKE(_macro_edge_node, _macro_edges_max, int);
+
+    for (i = 0; i < old_max; i++)
     {
-        /* Skip macros which do not match the pattern */
-        if (!streq(macro__pat[i], pat)) continue;
+        int j;
 
-        /* Found one */
-        return (i);
+        if (!old_key[i]) continue;
+        j = _macro_edge((old_key[i] - 1) >> 8, (old_key[i] - 1) & 0xFF);
+        _macro_edge_key[j] = old_key[i];
+        _macro_edge_node[j] = old_node[i];
+    }
+    if (old_key)
+    {
+        C_KILL(old_key, old_max, u32b);
+        C_KILL(old_node, old_max, int);
     }
+}
+
+/* Add macro n to the trie under its pattern */
+static void _macro_trie_add(cptr pat, int n)
+{
+    int node;
 
-    /* No matches */
-    return (-1);
+    if (!_macro_nodes_num) _macro_node_add();
+
+    for (node = 0; *pat; pat++)
+    {
+        int child = _macro_child(node, (byte)*pat);
+
+        if (_macro_nodes[node].below < 0) _macro_nodes[node].below = n;
+        if (child < 0)
+        {
+            int i;
+
+            if (2 * (_macro_nodes_num + 1) > _macro_edges_max) _macro_edges_grow();
+            child = _macro_node_add();
+            i = _macro_edge(node, (byte)*pat);
+            _macro_edge_key[i] = ((u32b)node << 8 | (byte)*pat) + 1;
+            _macro_edge_node[i] = child;
+        }
+        node = child;
+    }
+    _macro_nodes[node].macro = n;
+}
+
+/* The node for the pattern, or -1 if no macro starts with it */
+static int _macro_trie_find(cptr pat)
+{
+    int node = _macro_nodes_num ? 0 : -1;
+
+    for (; *pat && node >= 0; pat++)
+        node = _macro_child(node, (byte)*pat);
+    return node;
+}
+
+
+/*
+ * Find the macro (if any) which exactly matches the given pattern
+ */
+sint macro_find_exact(cptr pat)
+{
+    int node;
+
+    /* Nothing possible */
+    if (!macro__use[(byte)(pat[0])])
+    {
+        return (-1);
+    }
+
+    node = _macro_trie_find(pat);
+    return (node < 0) ? -1 : _macro_nodes[node].macro;
 }
 
 
@@ -1611,7 +1728,7 @@ sint macro_find_exact(cptr pat)
  */
 static sint macro_find_check(cptr pat)
 {
-    int i;
+    int node;
 
     /* Nothing possible */
     if (!macro__use[(byte)(pat[0])])
@@ -1619,18 +1736,16 @@ static sint macro_find_check(cptr pat)
         return (-1);
     }
 
-    /* Scan the macros */
-    for (i = 0; i < macro__num; ++i)
-    {
-        /* Skip macros which do not contain the pattern */
-        if (!prefix(macro__pat[i], pat)) continue;
+    node = _macro_trie_find(pat);
+    if (node < 0) return (-1);
 
-        /* Found one */
-        return (i);
+    /* The exact match was added before anything below it, if at all */
+    if (_macro_nodes[node].macro >= 0 &&
+        (_macro_nodes[node].below < 0 || _macro_nodes[node].macro < _macro_nodes[node].below))
+    {
+        return _macro_nodes[node].macro;
     }
-
-    /* Nothing */
-    return (-1);
+    return _macro_nodes[node].below;
 }
 
 
@@ -1639,7 +1754,7 @@ static sint macro_find_check(cptr pat)
  */
 static sint macro_find_maybe(cptr pat)
 {
-    int i;
+    int node;
 
     /* Nothing possible */
     if (!macro__use[(byte)(pat[0])])
@@ -1647,21 +1762,8 @@ static sint macro_find_maybe(cptr pat)
         return (-1);
     }
 
-    /* Scan the macros */
-    for (i = 0; i < macro__num; ++i)
-    {
-        /* Skip macros which do not contain the pattern */
-        if (!prefix(macro__pat[i], pat)) continue;
-
-        /* Skip macros which exactly match the pattern XXX XXX */
-        if (streq(macro__pat[i], pat)) continue;
-
-        /* Found one */
-        return (i);
-    }
-
-    /* Nothing */
-    return (-1);
+    node = _macro_trie_find(pat);
+    return (node < 0) ? -1 : _macro_nodes[node].below;
 }
 
 
@@ -1670,7 +1772,7 @@ static sint macro_find_maybe(cptr pat)
  */
 static sint macro_find_ready(cptr pat)
 {
-    int i, t, n = -1, s = -1;
+    int node, n = -1;
 
     /* Nothing possible */
     if (!macro__use[(byte)(pat[0])])
@@ -1678,27 +1780,113 @@ static sint macro_find_ready(cptr pat)
         return (-1);
     }
 
-    /* Scan the macros */
-    for (i = 0; i < macro__num; ++i)
+    /* Follow the pattern as far as the trie goes */
+    for (node = 0; node >= 0 && node < _macro_nodes_num; )
     {
-        /* Skip macros which are not contained by the pattern */
-        if (!prefix(pat, macro__pat[i])) continue;
+        if (_macro_nodes[node].macro >= 0) n = _macro_nodes[node].macro;
+        if (!*pat) break;
+        node = _macro_child(node, (byte)*pat++);
+    }
 
-        /* Obtain the length of this macro */
-        t = strlen(macro__pat[i]);
+    /* Result */
+    return (n);
+}
 
-        /* Only track the "longest" pattern */
-        if ((n >= 0) && (s > t)) continue;
 
-        /* Track the entry */
-        n = i;
-        s = t;
-    }
+/*
+ * The plain way to answer the above, trying every macro in turn
+ * (see macro_replay())
+ */
+#define _MACRO_EXACT 0
+#define _MACRO_CHECK 1
+#define _MACRO_MAYBE 2
+#define _MACRO_READY 3
 
-    /* Result */
+static sint _macro_scan(cptr pat, int mode)
+{
+    int i, t, n = -1, s = -1;
+
+    if (!macro__use[(byte)(pat[0])]) return (-1);
+
+    for (i = 0; i < macro__num; ++i)
+    {
+        switch (mode)
+        {
+        case _MACRO_EXACT:
+            if (streq(macro__pat[i], pat)) return (i);
+            break;
+        case _MACRO_CHECK:
+            if (prefix(macro__pat[i], pat)) return (i);
+            break;
+        case _MACRO_MAYBE:
+            if (prefix(macro__pat[i], pat) && !streq(macro__pat[i], pat)) return (i);
+            break;
+        case _MACRO_READY:
+            if (!prefix(pat, macro__pat[i])) break;
+            t = strlen(macro__pat[i]);
+            if ((n >= 0) && (s > t)) break;
+            n = i;
+            s = t;
+            break;
+        }
+    }
     return (n);
 }
 
+static sint _macro_find(cptr pat, int mode, bool scan)
+{
+    if (scan) return _macro_scan(pat, mode);
+    switch (mode)
+    {
+    case _MACRO_EXACT: return macro_find_exact(pat);
+    case _MACRO_CHECK: return macro_find_check(pat);
+    case _MACRO_MAYBE: return macro_find_maybe(pat);
+    }
+    return macro_find_ready(pat);
+}
+
+/*
+ * Feed a stream of keys through the macro matching of inkey_aux(), as
+ * if they were typed all at once, using the trie or (scan) trying every
+ * macro. Returns a hash of all the answers, so the two can be compared.
+ */
+u32b macro_replay(cptr keys, bool scan)
+{
+    char buf[1024];
+    u32b h = 2166136261UL;
+
+    while (*keys)
+    {
+        int p = 0, k;
+
+        /* Save the first key, advance */
+        buf[p++] = *keys++;
+        buf[p] = '\0';
+
+        k = _macro_find(buf, _MACRO_CHECK, scan);
+        h = (h ^ (u32b)k) * 16777619UL;
+        if (k < 0) continue;
+
+        /* Take keys while a longer macro is possible */
+        while (*keys && p < (int)sizeof(buf) - 1)
+        {
+            k = _macro_find(buf, _MACRO_MAYBE, scan);
+            h = (h ^ (u32b)k) * 16777619UL;
+            if (k < 0) break;
+            buf[p++] = *keys++;
+            buf[p] = '\0';
+        }
+
+        k = _macro_find(buf, _MACRO_READY, scan);
+        h = (h ^ (u32b)k) * 16777619UL;
+        h = (h ^ (u32b)_macro_find(buf, _MACRO_EXACT, scan)) * 16777619UL;
+
+        /* Put back the keys past the macro */
+        keys -= p - ((k < 0) ? 1 : MAX(1, (int)strlen(macro__pat[k])));
+    }
+    return h;
+}
+
 
 /*
  * Add a macro definition (or redefinition).
@@ -1744,6 +1932,7 @@ errr macro_add(cptr pat, cptr act)
 
         /* Save the pattern */
         macro__pat[n] = z_string_make(pat);
+        _macro_trie_add(pat, n);
     }
 
     /* Save the action */
@@ -2356,19 +2545,66 @@ char inkey(void)
 
 /*
  * We use a global array for all inscriptions to reduce the memory
- * spent maintaining inscriptions. Of course, it is still possible
- * to run out of inscription memory, especially if too many different
- * inscriptions are used, but hopefully this will be rare.
+ * spent maintaining inscriptions.
  *
  * We use dynamic string allocation because otherwise it is necessary
- * to pre-guess the amount of quark activity. We limit the total
- * number of quarks, but this is much easier to "expand" as needed.
+ * to pre-guess the amount of quark activity. The array starts with
+ * room for QUARK_MAX quarks and grows as needed, up to what a quark
+ * index can hold.
  *
  * Any two items with the same inscription will have the same "quark"
  * index, which should greatly reduce the need for inscription space.
+ * The quarks are found with an open addressing hash table of indices,
+ * so adding one doesn't compare it against all the others.
+ *
+ * Quarks are not reference counted, since objects and monsters are
+ * copied about with plain assignments. Instead, quark_collect() marks
+ * the ones still in use and frees the rest for reuse.
  *
  * Note that "quark zero" is NULL and should not be "dereferenced".
  */
+#define _QUARK_LIMIT 0x7FFF
+
+static int   _quark_max = 0;        /* Size of quark__str[] */
+static s16b *_quark_table = NULL;   /* Hash table of quarks (0 for none) */
+static int   _quark_table_size = 0; /* A power of two */
+static int   _quark_count = 0;      /* Quarks in the table */
+static s16b *_quark_free = NULL;    /* Reclaimed quarks, ready for reuse */
+static int   _quark_free_num = 0;
+static byte *_quark_used = NULL;    /* Marks for quark_collect() */
+
+static u32b _quark_hash(cptr str)
+{
+    u32b h = 2166136261UL;
+
+    while (*str) h = (h ^ (byte)*str++) * 16777619UL;
+    return h;
+}
+
+/* The table slot holding str, or the empty one where it would go */
+static int _quark_slot(cptr str)
+{
+    int mask = _quark_table_size - 1;
+    int i = _quark_hash(str) & mask;
+
+    while (_quark_table[i] && !streq(quark__str[_quark_table[i]], str))
+        i = (i + 1) & mask;
+    return i;
+}
+
+static void _quark_rehash(int size)
+{
+    int i;
+
+    if (_quark_table) C_KILL(_quark_table, _quark_table_size, s16b);
+    _quark_table_size = size;
+    C_MAKE(_quark_table, _quark_table_size, s16b);
+
+    for (i = 1; i < quark__num; i++)
+    {
+        if (quark__str[i]) _quark_table[_quark_slot(quark__str[i])] = i;
+    }
+}
 
 /*
  * Initialize the quark array
@@ -2376,13 +2612,17 @@ char inkey(void)
 void quark_init(void)
 {
     /* Quark variables */
-    C_MAKE(quark__str, QUARK_MAX, cptr);
+    _quark_max = QUARK_MAX;
+    C_MAKE(quark__str, _quark_max, cptr);
+    C_MAKE(_quark_free, _quark_max, s16b);
 
     /* Prepare first quark, which is used when quark_add() is failed */
     quark__str[1] = z_string_make("");
 
     /* There is one quark (+ NULL) */
     quark__num = 2;
+    _quark_count = 1;
+    _quark_rehash(2 * QUARK_MAX);
 }
 
 
@@ -2391,23 +2631,45 @@ void quark_init(void)
  */
 s16b quark_add(cptr str)
 {
-    int i;
+    int  slot = _quark_slot(str);
+    s16b i;
 
     /* Look for an existing quark */
-    for (i = 1; i < quark__num; i++)
-    {
-        /* Check for equality */
-        if (streq(quark__str[i], str)) return (i);
-    }
+    if (_quark_table[slot]) return _quark_table[slot];
 
-    /* Return "" when no room is available */
-    if (quark__num == QUARK_MAX) return 1;
+    /* Reuse a reclaimed quark */
+    if (_quark_free_num)
+        i = _quark_free[--_quark_free_num];
 
     /* New maximal quark */
-    quark__num = i + 1;
+    else
+    {
+        /* Make room */
+        if (quark__num == _quark_max)
+        {
+            int   size = MIN(2 * _quark_max, _QUARK_LIMIT);
+            cptr *old = quark__str;
+
+            /* Return "" when no room is available */
+            if (size == _quark_max) return 1;
+
+            C_MAKE(quark__str, size, cptr);
+            C_COPY(quark__str, old, _quark_max, cptr);
+            C_KILL(old, _quark_max, cptr);
+            C_KILL(_quark_free, _quark_max, s16b);
+            C_MAKE(_quark_free, size, s16b);
+            _quark_max = size;
+        }
+        i = quark__num++;
+    }
 
     /* Add a new quark */
     quark__str[i] = z_string_make(str);
+    _quark_table[slot] = i;
+
+    /* Keep the table at most half full */
+    if (2 * ++_quark_count > _quark_table_size)
+        _quark_rehash(2 * _quark_table_size);
 
     /* Return the index */
     return (i);
@@ -2432,6 +2694,95 @@ cptr quark_str(s16b i)
 }
 
 
+/*
+ * Free the quarks no longer in use. Returns how many were freed.
+ *
+ * Every place a quark can be kept must be marked here: objects on the
+ * floor, in every inventory and in the pack overflow, the copies kept by
+ * the magic eater and the statistics, monster nicknames and the spell
+ * color table, as well as a few odd ones. Saved floors and the savefile keep
+ * the strings rather than quarks, so this is safe between turns.
+ */
+static void _quark_mark(u16b i)
+{
+    if (i < quark__num) _quark_used[i] = TRUE;
+}
+
+static void _quark_mark_obj(obj_ptr obj)
+{
+    _quark_mark(obj->inscription);
+    _quark_mark(obj->art_name);
+}
+
+static void _quark_mark_all(void)
+{
+    int i;
+
+    C_MAKE(_quark_used, quark__num, byte);
+    _quark_used[1] = TRUE;
+
+    for (i = 1; i < o_max; i++)
+    {
+        if (o_list[i].k_idx) _quark_mark_obj(&o_list[i]);
+    }
+    for (i = 1; i < m_max; i++)
+    {
+        if (m_list[i].r_idx) _quark_mark(m_list[i].nickname);
+    }
+    inv_all_for_each(_quark_mark_obj);
+    pack_overflow_for_each(_quark_mark_obj);
+    magic_eater_for_each_obj(_quark_mark_obj);
+    autopick_for_each_obj(_quark_mark_obj);
+    stats_for_each_obj(_quark_mark_obj);
+    _quark_mark(cap_nickname);
+    for (i = 0; i < MAX_GF; i++) _quark_mark(gf_color[i]);
+}
+
+int quark_collect(void)
+{
+    int i, n = 0;
+
+    _quark_mark_all();
+
+    for (i = 2; i < quark__num; i++)
+    {
+        if (!quark__str[i] || _quark_used[i]) continue;
+
+        z_string_free(quark__str[i]);
+        quark__str[i] = NULL;
+        _quark_free[_quark_free_num++] = i;
+        _quark_count--;
+        n++;
+    }
+    C_KILL(_quark_used, quark__num, byte);
+    _quark_used = NULL;
+
+    if (n) _quark_rehash(_quark_table_size);
+    return n;
+}
+
+/*
+ * Count the quarks in use that have been freed, and the quarks that the
+ * hash table would not find (for debugging)
+ */
+int quark_verify(void)
+{
+    int i, bad = 0;
+
+    _quark_mark_all();
+
+    for (i = 1; i < quark__num; i++)
+    {
+        if (_quark_used[i] && !quark__str[i]) bad++;
+        if (quark__str[i] && _quark_table[_quark_slot(quark__str[i])] != i) bad++;
+    }
+    C_KILL(_quark_used, quark__num, byte);
+    _quark_used = NULL;
+
+    return bad;
+}
+
+
 
 /*
  * Save the screen, and increase the "icky" depth.
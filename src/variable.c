@@ -78,6 +78,8 @@ bool arg_monochrome;        /* Command arg -- Request monochrome mode */
 bool arg_force_original;    /* Command arg -- Request original keyset */
 bool arg_force_roguelike;    /* Command arg -- Request roguelike keyset */
 bool arg_bigtile = FALSE;    /* Command arg -- Request big tile mode */
+u32b arg_seed = 0;            /* Command arg -- Seed for a new character */
+bool arg_reference = FALSE;    /* Command arg -- Take the reference routines */
 
 /*
  * Various things
@@ -89,6 +91,7 @@ bool character_saved;        /* The character was just saved to a savefile */
 
 bool character_icky;        /* The game is in an icky full screen mode */
 bool character_xtra;        /* The game is in an icky startup mode */
+bool update_hold;        /* Let update requests pile up (see handle_stuff) */
 
 bool creating_savefile;        /* New savefile is currently created */
 
@@ -157,9 +160,11 @@ bool hack_mind;
 
 s16b o_max = 1;            /* Number of allocated objects */
 s16b o_cnt = 0;            /* Number of live objects */
+s16b o_free_list = 0;      /* First dead object below o_max (see o_pop()) */
 
 s16b m_max = 1;            /* Number of allocated monsters */
 s16b m_cnt = 0;            /* Number of live monsters */
+s16b m_free_list = 0;      /* First dead monster below m_max (see m_pop()) */
 
 s16b hack_m_idx = 0;    /* Hack -- see "process_monsters()" */
 int hack_m_spell = 0;   /* Hack -- see process_monsters(), make_attack_spell() and project_p() */
@@ -173,6 +178,14 @@ s32b friend_align = 0;
 bool reinit_wilderness = FALSE;
 
 int current_flow_depth = 0;
+u32b los_memo_hits = 0;
+u32b los_memo_misses = 0;
+u32b mon_move_hits = 0;
+u32b mon_move_misses = 0;
+u32b map_redraw_grids = 0;      /* Grids redrawn on their own, or in batches */
+u32b map_redraw_frames = 0;     /* ... and how many of those there were */
+u32b map_redraw_full = 0;       /* Whole map redraws (prt_map()) */
+u32b map_redraw_merged = 0;     /* Grids a batch did not need to draw again */
 
 /*
  * Software options (set via the '=' command). See "tables.c"
@@ -239,7 +252,6 @@ bool display_food_bar;
 bool display_hp_bar;
 bool display_sp_bar;
 bool display_percentages;
-bool compress_savefile;    /* Compress messages in savefiles */
 bool abbrev_extra;    /* Describe obj's extra resistances by abbreviation */
 bool abbrev_all;    /* Describe obj's all resistances by abbreviation */
 bool exp_need;    /* Show the experience needed for next level */
@@ -258,6 +270,7 @@ bool always_small_levels;    /* Always create unusually small dungeon levels */
 bool empty_levels;    /* Allow empty 'arena' levels */
 bool bound_walls_perm;    /* Boundary walls become 'permanent wall' */
 bool last_words;    /* Leave last words when your character dies */
+bool compress_savefile;    /* Compress the savefile */
 
 #ifdef WORLD_SCORE
 bool send_score;    /* Send score dump to the world score server */
@@ -472,7 +485,7 @@ char *macro__buf;
 s16b quark__num;
 
 /*
- * The pointers to the quarks [QUARK_MAX]
+ * The pointers to the quarks [QUARK_MAX, growing as needed]
  */
 cptr *quark__str;
 
@@ -617,6 +630,13 @@ char angband_sound_name[SOUND_MAX][16] =
  */
 cave_type *cave[MAX_HGT];
 
+/*
+ * The number of grids holding a monster, and holding objects, in each
+ * block of the cave [SPATIAL_HGT * SPATIAL_WID]
+ */
+byte *spatial_mon;
+byte *spatial_obj;
+
 
 /*
  * The array of saved floors
@@ -659,6 +679,16 @@ s16b pack_info_count;
 s16b *mproc_list[MAX_MTIMED];
 s16b mproc_max[MAX_MTIMED]; /* Number of monsters to be processed */
 
+/*
+ * Bitmap of "idle" monsters skipped by process_monsters() [max_m_idx / 32]
+ */
+u32b *m_idle;
+
+/*
+ * Bitmap of "live" monsters, those with an r_idx [max_m_idx / 32]
+ */
+u32b *m_live;
+
 
 /*
  * The size of "alloc_kind_table" (at most max_k_idx * 4)
@@ -670,6 +700,12 @@ s16b alloc_kind_size;
  */
 alloc_entry *alloc_kind_table;
 
+/*
+ * A hash of the "prob2" column of "alloc_kind_table"
+ * (see get_obj_num_prep())
+ */
+u32b alloc_kind_stamp;
+
 
 /*
  * The size of "alloc_race_table" (at most max_r_idx)
@@ -681,6 +717,12 @@ s16b alloc_race_size;
  */
 alloc_entry *alloc_race_table;
 
+/*
+ * A hash of the "prob2" column of "alloc_race_table"
+ * (see get_mon_num_prep())
+ */
+u32b alloc_race_stamp;
+
 
 /*
  * Specify attr/char pairs for visual special effects
@@ -984,7 +984,7 @@ static void _pets_breathe_spell(int cmd, variant *res)
             msg_boundary();
         }
 
-        for (i = m_max - 1; i >= 1; i--)
+        for_each_live_mon_back(i)
         {
             monster_type *m_ptr = &m_list[i];
             monster_race *r_ptr;
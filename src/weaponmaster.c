@@ -58,7 +58,7 @@ static int _get_nearest_target_los(void)
     if (p_ptr->shooter_info.slot)
         rng = bow_range(equip_obj(p_ptr->shooter_info.slot));
 
-    for (i = m_max - 1; i >= 1; i--)
+    for_each_live_mon_back(i)
     {
         m_ptr = &m_list[i];
         if (!m_ptr->r_idx
@@ -90,7 +90,7 @@ static int _get_greater_many_shot_targets(int *targets, int max)
         rng = bow_range(equip_obj(p_ptr->shooter_info.slot));
 
     /* shoot *all* line of sight monsters */
-    for (i = m_max - 1; i >= 1; i--)
+    for_each_live_mon_back(i)
     {
         m_ptr = &m_list[i];
         if (!m_ptr->r_idx) continue;
@@ -121,7 +121,7 @@ static int _get_many_shot_targets(int *targets, int max)
         rng = bow_range(equip_obj(p_ptr->shooter_info.slot));
 
     /* pass 1: get line of sight monsters */
-    for (i = m_max - 1; i >= 1; i--)
+    for_each_live_mon_back(i)
     {
         m_ptr = &m_list[i];
         if (!m_ptr->r_idx) continue;
@@ -1772,6 +1772,7 @@ bool _design_monkey_clone(void)
 
     r_ptr->flags7 |= RF7_CAN_SWIM;
     if (p_ptr->levitation) r_ptr->flags7 |= RF7_CAN_FLY;
+    mon_move_update(r_ptr);
 
     r_ptr->r_xtra1 |= MR1_LORE;
 
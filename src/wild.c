@@ -299,6 +299,9 @@ static void _scroll_cave(int dx, int dy)
         /* ooops! */
     }
 
+    /* _scroll_grid() moves grids wholesale */
+    spatial_rebuild();
+
     px += dx;
     py += dy;
 
@@ -1637,7 +1640,7 @@ bool change_wild_mode(void)
         return TRUE;
     }
 
-    for (i = 1; i < m_max; i++)
+    for_each_live_mon(i)
     {
         monster_type *m_ptr = &m_list[i];
         monster_race *r_ptr;
@@ -14,6 +14,11 @@
 
 #include <assert.h>
 
+#ifdef SET_UID
+# include <sys/time.h>
+# include <sys/wait.h>
+#endif
+
 /* Statistics: Use the wizard commands '-' and '=' to gather statistics.
    The Wizard command '"' and 'A' will then show all found artifacts,
    including rand-arts. The character sheet will show statistics on object
@@ -60,6 +65,22 @@ void stats_add_ego(object_type *o_ptr)
     }
 }
 
+/* The copies keep their art_name quarks (see quark_collect()) */
+void stats_for_each_obj(obj_f f)
+{
+    int i;
+    if (_rand_arts)
+    {
+        for (i = 0; i < vec_length(_rand_arts); i++)
+            f(vec_get(_rand_arts, i));
+    }
+    if (_egos)
+    {
+        for (i = 0; i < vec_length(_egos); i++)
+            f(vec_get(_egos, i));
+    }
+}
+
 typedef struct {
     int total;
     int count;
@@ -1228,6 +1249,1013 @@ static void _wiz_gather_stats(int which_dungeon, int level, int reps)
     }
 }
 
+/* Batch statistics: The wizard command '_' runs the level generator over a
+   range of depths, several times per depth, and writes the monster and
+   object level tallies and the object, ego, rand-art and gold counts to a
+   CSV file (lib/user/stats.csv). The headless front end does the same with
+   "-mtest -- -g<min>,<max>,<reps>[,<workers>[,<dungeon>]]", and there
+   splits the work over one process per cpu (at most _BATCH_WORKERS). Each worker reseeds its RNG and plays on its own copy of
+   the game; the parent merges their results back into its own. Workers are
+   never forked from the interactive command, since they would share the
+   terminal (and could stop at a -more- prompt nobody can answer). */
+typedef struct {
+    _tally_t      monster_levels[MAX_DEPTH];
+    _tally_t      object_levels[MAX_DEPTH];
+    int           object_histogram[MAX_DEPTH];
+    counts_t      rand_arts;
+    gold_counts_t gold;
+} _batch_t;
+
+static counts_t     *_batch_base = NULL; /* k_info, then e_info */
+static counts_t      _batch_art_base;
+static gold_counts_t _batch_gold_base;
+
+static void _batch_save_counts(counts_t *counts)
+{
+    int i;
+    for (i = 0; i < max_k_idx; i++)
+        counts[i] = k_info[i].counts;
+    for (i = 0; i < max_e_idx; i++)
+        counts[max_k_idx + i] = e_info[i].counts;
+}
+
+static void _batch_add_counts(counts_t *dest, const counts_t *src, const counts_t *base)
+{
+    dest->generated += src->generated - base->generated;
+    dest->found += src->found - base->found;
+    dest->bought += src->bought - base->bought;
+    dest->used += src->used - base->used;
+    dest->destroyed += src->destroyed - base->destroyed;
+}
+
+static void _batch_add_gold(gold_counts_t *dest, const gold_counts_t *src, const gold_counts_t *base)
+{
+    dest->found += src->found - base->found;
+    dest->selling += src->selling - base->selling;
+    dest->buying += src->buying - base->buying;
+    dest->services += src->services - base->services;
+    dest->winnings += src->winnings - base->winnings;
+    dest->stolen += src->stolen - base->stolen;
+}
+
+/* Each worker takes every workers'th level, in order of depth */
+static void _batch_work(int which_dungeon, int min_depth, int reps, int levels, int worker, int workers)
+{
+    int i;
+    for (i = worker; i < levels; i += workers)
+        _wiz_gather_stats(which_dungeon, min_depth + i / reps, 1);
+}
+
+#ifdef SET_UID
+static int _batch_cpus(void)
+{
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return n > 0 ? (int)n : 1;
+}
+
+static bool _batch_write(int fd, const void *buf, int size)
+{
+    const char *p = buf;
+    while (size > 0)
+    {
+        int n = write(fd, p, size);
+        if (n <= 0) return FALSE;
+        p += n;
+        size -= n;
+    }
+    return TRUE;
+}
+
+static bool _batch_read(int fd, void *buf, int size)
+{
+    char *p = buf;
+    while (size > 0)
+    {
+        int n = read(fd, p, size);
+        if (n <= 0) return FALSE;
+        p += n;
+        size -= n;
+    }
+    return TRUE;
+}
+
+/* The forked worker: play its share and send back what it saw */
+static void _batch_child(int fd, u32b seed, int which_dungeon, int min_depth, int reps, int levels, int worker, int workers)
+{
+    _batch_t  b;
+    counts_t *counts;
+    bool      ok;
+
+    Rand_state_init(seed);
+    _batch_work(which_dungeon, min_depth, reps, levels, worker, workers);
+
+    C_COPY(b.monster_levels, _monster_levels, MAX_DEPTH, _tally_t);
+    C_COPY(b.object_levels, _object_levels, MAX_DEPTH, _tally_t);
+    C_COPY(b.object_histogram, _object_histogram, MAX_DEPTH, int);
+    b.rand_arts = stats_rand_art_counts;
+    b.gold = stats_gold_counts;
+
+    C_MAKE(counts, max_k_idx + max_e_idx, counts_t);
+    _batch_save_counts(counts);
+
+    ok = _batch_write(fd, &b, sizeof(b))
+      && _batch_write(fd, counts, (max_k_idx + max_e_idx) * sizeof(counts_t));
+
+    /* Leave without running any of the parent's exit handlers */
+    _exit(ok ? 0 : 1);
+}
+
+static bool _batch_merge(int fd)
+{
+    _batch_t  b;
+    counts_t *counts;
+    bool      ok;
+    int       i;
+
+    C_MAKE(counts, max_k_idx + max_e_idx, counts_t);
+    ok = _batch_read(fd, &b, sizeof(b))
+      && _batch_read(fd, counts, (max_k_idx + max_e_idx) * sizeof(counts_t));
+
+    if (ok)
+    {
+        for (i = 0; i < MAX_DEPTH; i++)
+        {
+            _monster_levels[i].total += b.monster_levels[i].total;
+            _monster_levels[i].count += b.monster_levels[i].count;
+            _object_levels[i].total += b.object_levels[i].total;
+            _object_levels[i].count += b.object_levels[i].count;
+            _object_histogram[i] += b.object_histogram[i];
+        }
+        for (i = 0; i < max_k_idx; i++)
+            _batch_add_counts(&k_info[i].counts, &counts[i], &_batch_base[i]);
+        for (i = 0; i < max_e_idx; i++)
+            _batch_add_counts(&e_info[i].counts, &counts[max_k_idx + i], &_batch_base[max_k_idx + i]);
+        _batch_add_counts(&stats_rand_art_counts, &b.rand_arts, &_batch_art_base);
+        _batch_add_gold(&stats_gold_counts, &b.gold, &_batch_gold_base);
+    }
+
+    C_KILL(counts, max_k_idx + max_e_idx, counts_t);
+    return ok;
+}
+#endif
+
+static void _batch_csv_counts(FILE *fff, int idx, cptr name, const counts_t *counts, const counts_t *base)
+{
+    counts_t c = {0};
+
+    _batch_add_counts(&c, counts, base);
+    if (!c.generated && !c.found && !c.bought && !c.used && !c.destroyed) return;
+
+    fprintf(fff, "%d,\"%s\",%ld,%ld,%ld,%ld,%ld\n", idx, name,
+        (long)c.generated, (long)c.found, (long)c.bought, (long)c.used, (long)c.destroyed);
+}
+
+static void _batch_csv(FILE *fff, int which_dungeon)
+{
+    gold_counts_t gold = {0};
+    char          buf[MAX_NLEN];
+    int           i;
+
+    fprintf(fff, "dungeon,depth,monsters,monster_level,objects,object_level,object_histogram\n");
+    for (i = 0; i < MAX_DEPTH; i++)
+    {
+        _tally_t mon = _monster_levels[i];
+        _tally_t obj = _object_levels[i];
+
+        if (!mon.count && !obj.count && !_object_histogram[i]) continue;
+        fprintf(fff, "%d,%d,%d,%.2f,%d,%.2f,%d\n", which_dungeon, i,
+            mon.count, mon.count ? (double)mon.total / mon.count : 0.0,
+            obj.count, obj.count ? (double)obj.total / obj.count : 0.0,
+            _object_histogram[i]);
+    }
+
+    fprintf(fff, "\nk_idx,object,generated,found,bought,used,destroyed\n");
+    for (i = 1; i < max_k_idx; i++)
+    {
+        if (!k_info[i].name) continue;
+        strip_name(buf, i);
+        _batch_csv_counts(fff, i, buf, &k_info[i].counts, &_batch_base[i]);
+    }
+
+    fprintf(fff, "\ne_idx,ego,generated,found,bought,used,destroyed\n");
+    for (i = 1; i < max_e_idx; i++)
+    {
+        if (!e_info[i].name) continue;
+        strip_name_aux(buf, e_name + e_info[i].name);
+        _batch_csv_counts(fff, i, buf, &e_info[i].counts, &_batch_base[max_k_idx + i]);
+    }
+
+    fprintf(fff, "\nrand_arts,generated,found,bought,used,destroyed\n");
+    fprintf(fff, "0,%ld,%ld,%ld,%ld,%ld\n",
+        (long)(stats_rand_art_counts.generated - _batch_art_base.generated),
+        (long)(stats_rand_art_counts.found - _batch_art_base.found),
+        (long)(stats_rand_art_counts.bought - _batch_art_base.bought),
+        (long)(stats_rand_art_counts.used - _batch_art_base.used),
+        (long)(stats_rand_art_counts.destroyed - _batch_art_base.destroyed));
+
+    _batch_add_gold(&gold, &stats_gold_counts, &_batch_gold_base);
+    fprintf(fff, "\ngold,found,selling,buying,services,winnings,stolen\n");
+    fprintf(fff, "0,%ld,%ld,%ld,%ld,%ld,%ld\n", (long)gold.found, (long)gold.selling,
+        (long)gold.buying, (long)gold.services, (long)gold.winnings, (long)gold.stolen);
+}
+
+/* The most processes one batch forks */
+#define _BATCH_WORKERS 64
+
+/* Generate reps levels at each depth from min_depth to max_depth of the
+   dungeon (within its own range of depths) using up to workers processes
+   (0 for one per cpu), and write the results to fff. Returns the number
+   of levels whose results were lost. */
+int wiz_batch_stats(FILE *fff, int which_dungeon, int min_depth, int max_depth, int reps, int workers)
+{
+    dungeon_info_type *d_ptr = &d_info[which_dungeon];
+    int   levels, lost = 0;
+#ifdef SET_UID
+    int   w;
+    int   fds[_BATCH_WORKERS];
+    pid_t pids[_BATCH_WORKERS];
+#endif
+
+    if (min_depth < MAX(1, d_ptr->mindepth)) min_depth = MAX(1, d_ptr->mindepth);
+    if (max_depth > d_ptr->maxdepth) max_depth = d_ptr->maxdepth;
+    if (max_depth >= MAX_DEPTH) max_depth = MAX_DEPTH - 1;
+    if (max_depth < min_depth || reps <= 0) return 0;
+    levels = (max_depth - min_depth + 1) * reps;
+
+#ifdef SET_UID
+    if (workers <= 0) workers = _batch_cpus();
+#endif
+    if (workers <= 0) workers = 1;
+    if (workers > _BATCH_WORKERS) workers = _BATCH_WORKERS;
+    if (workers > levels) workers = levels;
+
+    C_MAKE(_batch_base, max_k_idx + max_e_idx, counts_t);
+    _batch_save_counts(_batch_base);
+    _batch_art_base = stats_rand_art_counts;
+    _batch_gold_base = stats_gold_counts;
+
+    _stats_reset_monster_levels();
+    _stats_reset_object_levels();
+    statistics_hack = TRUE;
+
+    if (workers == 1)
+        _batch_work(which_dungeon, min_depth, reps, levels, 0, 1);
+#ifdef SET_UID
+    else
+    {
+        /* Start everybody before doing any work here */
+        for (w = 0; w < workers; w++)
+        {
+            int   pipe_fds[2];
+            u32b  seed = randint0(0x10000000);
+
+            pids[w] = -1;
+            if (pipe(pipe_fds) < 0) continue;
+
+            /* Make sure nothing buffered gets written twice */
+            fflush(NULL);
+
+            pids[w] = fork();
+            if (pids[w] == 0)
+            {
+                close(pipe_fds[0]);
+                _batch_child(pipe_fds[1], seed, which_dungeon, min_depth, reps, levels, w, workers);
+            }
+            close(pipe_fds[1]);
+            if (pids[w] < 0)
+                close(pipe_fds[0]);
+            else
+                fds[w] = pipe_fds[0];
+        }
+
+        /* Play the share of any worker that failed to start ourselves */
+        for (w = 0; w < workers; w++)
+        {
+            if (pids[w] < 0)
+                _batch_work(which_dungeon, min_depth, reps, levels, w, workers);
+        }
+
+        for (w = 0; w < workers; w++)
+        {
+            if (pids[w] < 0) continue;
+            if (!_batch_merge(fds[w]))
+                lost += (levels - w + workers - 1) / workers;
+            close(fds[w]);
+            waitpid(pids[w], NULL, 0);
+        }
+    }
+#endif
+
+    statistics_hack = FALSE;
+
+    _batch_csv(fff, which_dungeon);
+
+    C_KILL(_batch_base, max_k_idx + max_e_idx, counts_t);
+    return lost;
+}
+
+/* Benchmarks: Time some of the engine's hot spots on the current level
+   (from the test front end: see wiz_bench() below). Times are in
+   milliseconds of cpu. */
+static int _wiz_bench_ms(clock_t start)
+{
+    return (int)((clock() - start) * 1000 / CLOCKS_PER_SEC);
+}
+
+/* Wall time in microseconds, for benches that wait on the disk, which
+   clock() does not count */
+static long _wiz_bench_usec(void)
+{
+#ifdef SET_UID
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return tv.tv_sec * 1000000L + tv.tv_usec;
+#else
+    return (long)clock() * 1000000L / CLOCKS_PER_SEC;
+#endif
+}
+
+/* Take a random step, as the player would, but only onto bare floor so
+   that nothing is picked up, fought or set off on the way. The benches
+   put the player back with the same routine when they are done. Steps in
+   the wilderness would scroll it, so there the player stays put. */
+static void _wiz_bench_step(void)
+{
+    int d = ddd[randint0(8)];
+    int y = py + ddy[d];
+    int x = px + ddx[d];
+
+    if (!dun_level) return;
+    if (!in_bounds(y, x)) return;
+    if (!cave_naked_bold(y, x)) return;
+    if (!cave_have_flag_bold(y, x, FF_MOVE)) return;
+    if (cave_have_flag_bold(y, x, FF_HIT_TRAP)) return;
+
+    move_player_effect(y, x, MPE_DONT_PICKUP);
+}
+
+static void _wiz_bench_return(int y, int x)
+{
+    if (!player_bold(y, x)) move_player_effect(y, x, MPE_DONT_PICKUP);
+    handle_stuff();
+}
+
+/* A full size level of open floor inside permanent walls, built in a
+   level context of its own so the current level is left alone */
+static gen_ctx_type *_wiz_bench_ctx = NULL;
+
+static void _wiz_bench_open_level(void)
+{
+    int y, x;
+
+    if (!_wiz_bench_ctx) _wiz_bench_ctx = gen_ctx_alloc();
+    _wiz_bench_ctx->dungeon_type = dungeon_type;
+    _wiz_bench_ctx->dun_level = dun_level;
+    _wiz_bench_ctx->rand = Rand_state[RAND_STREAM_GEN];
+    gen_ctx_swap(_wiz_bench_ctx);
+
+    cur_hgt = MAX_HGT;
+    cur_wid = MAX_WID;
+    for (y = 0; y < cur_hgt; y++)
+    {
+        for (x = 0; x < cur_wid; x++)
+        {
+            cave_type *c_ptr = &cave[y][x];
+
+            WIPE(c_ptr, cave_type);
+            if (y == 0 || x == 0 || y == cur_hgt - 1 || x == cur_wid - 1)
+                c_ptr->feat = feat_permanent;
+            else
+                c_ptr->feat = feat_floor;
+        }
+    }
+    py = cur_hgt / 2;
+    px = cur_wid / 2;
+}
+
+static void _wiz_bench_flow(FILE *fff, int reps)
+{
+    int     i, pass, ms[2], bad = 0;
+    bool    old_reference = arg_reference;
+    byte   *walk_y, *walk_x;
+    clock_t start;
+
+    /* Build the open level, and a random walk about it from the middle */
+    _wiz_bench_open_level();
+    C_MAKE(walk_y, reps, byte);
+    C_MAKE(walk_x, reps, byte);
+    for (i = 0; i < reps; i++)
+    {
+        int d = ddd[randint0(8)];
+        int y = py + ddy[d];
+        int x = px + ddx[d];
+
+        if (cave_have_flag_bold(y, x, FF_MOVE))
+        {
+            py = y;
+            px = x;
+        }
+        walk_y[i] = py;
+        walk_x[i] = px;
+    }
+
+    /* Take the walk twice, updating the monster flow after each step:
+       first with the current pass, then with the reference one */
+    for (pass = 0; pass < 2; pass++)
+    {
+        arg_reference = pass;
+        forget_flow();
+        start = clock();
+        for (i = 0; i < reps; i++)
+        {
+            py = walk_y[i];
+            px = walk_x[i];
+            update_flow();
+        }
+        ms[pass] = _wiz_bench_ms(start);
+
+        /* Check where the current pass left off against the reference */
+        if (!pass) bad = flow_verify();
+    }
+    arg_reference = old_reference;
+
+    C_KILL(walk_y, reps, byte);
+    C_KILL(walk_x, reps, byte);
+
+    /* Back to the current level, whose flow must be redone */
+    gen_ctx_swap(_wiz_bench_ctx);
+    forget_flow();
+    p_ptr->update |= PU_FLOW;
+    handle_stuff();
+
+    fprintf(fff, "%d flow updates on an open %dx%d level: %d ms (%d.%03d ms each), "
+                 "%d ms (%d.%03d ms each) for the reference pass, %d mismatches.\n",
+        reps, MAX_WID, MAX_HGT,
+        ms[0], ms[0] / reps, (ms[0] * 1000 / reps) % 1000,
+        ms[1], ms[1] / reps, (ms[1] * 1000 / reps) % 1000, bad);
+}
+
+static void _wiz_bench_view(FILE *fff, int reps)
+{
+    int     old_y = py, old_x = px;
+    int     i, bad = 0;
+    clock_t spent = 0;
+
+    /* Wander about the level, recomputing the view after each step and
+       checking it against the reference los() */
+    for (i = 0; i < reps; i++)
+    {
+        clock_t start;
+
+        _wiz_bench_step();
+        start = clock();
+        update_view();
+        spent += clock() - start;
+
+        bad += view_verify();
+        delayed_visual_update();
+    }
+
+    _wiz_bench_return(old_y, old_x);
+
+    i = (int)(spent * 1000 / CLOCKS_PER_SEC);
+    fprintf(fff, "%d view updates in %d ms (%d.%03d ms each), %d mismatches.\n",
+        reps, i, i / reps, (i * 1000 / reps) % 1000, bad);
+}
+
+static void _wiz_bench_project(FILE *fff, int reps)
+{
+    int     i, j, pass, ms[2], n = 0;
+    u32b    hits = los_memo_hits, misses = los_memo_misses;
+    clock_t start;
+
+    /* Ask every monster whether it can cast at the player, first with the
+       memo wiped each round (as if the terrain kept changing), then warm */
+    for (pass = 0; pass < 2; pass++)
+    {
+        start = clock();
+        for (i = 0; i < reps; i++)
+        {
+            if (!pass) los_memo_wipe();
+            for (j = 1; j < m_max; j++)
+            {
+                monster_type *m_ptr = &m_list[j];
+
+                if (!m_ptr->r_idx) continue;
+                if (projectable(m_ptr->fy, m_ptr->fx, py, px)) n++;
+                if (los(m_ptr->fy, m_ptr->fx, py, px)) n++;
+            }
+        }
+        ms[pass] = _wiz_bench_ms(start);
+    }
+
+    fprintf(fff, "%d rounds: %d ms cold, %d ms warm; %u traces avoided, %u made (%d open).\n",
+        reps, ms[0], ms[1], los_memo_hits - hits, los_memo_misses - misses, n);
+}
+
+static void _wiz_bench_rand(FILE *fff, int reps)
+{
+    rand_stream_t state[RAND_STREAMS];
+    u32b    value = Rand_value;
+    int     i, ms[4];
+    s32b    sum = 0;
+    clock_t start;
+
+    reps *= 1000;
+
+    /* Leave the game's random numbers as they were */
+    memcpy(state, Rand_state, sizeof(Rand_state));
+
+    start = clock();
+    for (i = 0; i < reps; i++) sum += randint0(100);
+    ms[0] = _wiz_bench_ms(start);
+
+    start = clock();
+    for (i = 0; i < reps; i++) sum += damroll(3, 6);
+    ms[1] = _wiz_bench_ms(start);
+
+    start = clock();
+    for (i = 0; i < reps; i++) sum += randnor(100, 25);
+    ms[2] = _wiz_bench_ms(start);
+
+    /* The simple RNG, for comparison */
+    Rand_quick = TRUE;
+    start = clock();
+    for (i = 0; i < reps; i++) sum += randint0(100);
+    ms[3] = _wiz_bench_ms(start);
+    Rand_quick = FALSE;
+
+    memcpy(Rand_state, state, sizeof(Rand_state));
+    Rand_value = value;
+
+    fprintf(fff, "%d rolls in ms: randint0 %d, damroll(3,6) %d, randnor %d; simple randint0 %d (%d).\n",
+        reps, ms[0], ms[1], ms[2], ms[3], sum);
+}
+
+static void _wiz_bench_summon(FILE *fff, int reps)
+{
+    const int types[3] = { 0, SUMMON_DEMON, SUMMON_UNDEAD };
+    rand_stream_t state[RAND_STREAMS];
+    u32b    value = Rand_value;
+    s16b    uniques = unique_count;
+    int     i, ms[3], n = 0;
+    clock_t start, spent = 0;
+
+    /* Leave the game's random numbers as they were */
+    memcpy(state, Rand_state, sizeof(Rand_state));
+
+    /* Summon next to the player, sending each monster away again before
+       the next one so the level does not fill up */
+    for (i = 0; i < reps; i++)
+    {
+        start = clock();
+        if (summon_specific(-1, py, px, dun_level, types[i % 3], 0))
+        {
+            spent += clock() - start;
+            delete_monster_idx(hack_m_idx_ii);
+            n++;
+        }
+        else
+            spent += clock() - start;
+    }
+    ms[0] = (int)(spent * 1000 / CLOCKS_PER_SEC);
+
+    /* The bare allocation tables */
+    get_mon_num_prep(NULL, NULL);
+    start = clock();
+    for (i = 0; i < reps; i++) get_mon_num(dun_level);
+    ms[1] = _wiz_bench_ms(start);
+
+    get_obj_num_hook = NULL;
+    get_obj_num_prep();
+    start = clock();
+    for (i = 0; i < reps; i++) get_obj_num(dun_level);
+    ms[2] = _wiz_bench_ms(start);
+
+    memcpy(Rand_state, state, sizeof(Rand_state));
+    Rand_value = value;
+    unique_count = uniques;
+
+    fprintf(fff, "%d summons (%d placed) in %d ms (%d/sec); get_mon_num %d ms, get_obj_num %d ms.\n",
+        reps, n, ms[0], ms[0] ? (int)(reps * 1000L / ms[0]) : 0, ms[1], ms[2]);
+}
+
+static int _wiz_bench_breeder(int r_idx)
+{
+    int i;
+
+    /* A random member of the colony */
+    for (i = 0; i < 1000; i++)
+    {
+        int m_idx = randint1(m_max - 1);
+        if (m_list[m_idx].r_idx == r_idx) return m_idx;
+    }
+    return 0;
+}
+
+static void _wiz_bench_breed(FILE *fff, int reps)
+{
+    rand_stream_t state[RAND_STREAMS];
+    u32b    value = Rand_value;
+    s16b    repro = num_repro;
+    int     r_idx, i, ms, born = 0, died = 0;
+    clock_t start;
+
+    /* The first breeder that will do */
+    for (r_idx = 1; r_idx < max_r_idx; r_idx++)
+    {
+        monster_race *r_ptr = &r_info[r_idx];
+        if ((r_ptr->flags2 & RF2_MULTIPLY) && !(r_ptr->flags1 & RF1_UNIQUE) && r_ptr->name) break;
+    }
+    if (r_idx == max_r_idx) return;
+    if (!summon_named_creature(0, py, px, r_idx, PM_NO_KAGE)) return;
+
+    memcpy(state, Rand_state, sizeof(Rand_state));
+
+    /* Let the colony breed until the monster list is nearly full, then
+       kill off a good part of it (as a ball spell into the mass would)
+       and let it breed back, tidying up the list as dungeon() does */
+    start = clock();
+    for (i = 0; i < reps; i++)
+    {
+        int m_idx = _wiz_bench_breeder(r_idx);
+
+        if (!m_idx) break;
+        if (multiply_monster(m_idx, FALSE, 0)) born++;
+
+        if (m_cnt + 32 > max_m_idx)
+        {
+            int j;
+
+            for (j = m_max - 1; j >= 1; j--)
+            {
+                if (m_list[j].r_idx != r_idx || !one_in_(5)) continue;
+                delete_monster_idx(j);
+                died++;
+            }
+        }
+        if (m_cnt + MAX(32, m_max / 4) < m_max) compact_monsters(0);
+    }
+    ms = _wiz_bench_ms(start);
+
+    fprintf(fff, "%d births and %d deaths in %d ms; %d monsters in %d slots.\n",
+        born, died, ms, m_cnt, m_max - 1);
+
+    /* Clean up */
+    for (i = m_max - 1; i >= 1; i--)
+    {
+        if (m_list[i].r_idx == r_idx) delete_monster_idx(i);
+    }
+    memcpy(Rand_state, state, sizeof(Rand_state));
+    Rand_value = value;
+    num_repro = repro;
+    p_ptr->redraw |= PR_MAP;
+}
+
+/*
+ * Time the spatial index against sweeps of the monster and object lists,
+ * finding what is within detection range of the player
+ */
+static void _wiz_bench_nearby(FILE *fff, int reps)
+{
+    int   i, j, ms[4], n[4] = {0};
+    s16b *who;
+    clock_t start;
+
+    C_MAKE(who, MAX(max_m_idx, max_o_idx), s16b);
+
+    start = clock();
+    for (i = 0; i < reps; i++)
+    {
+        n[0] = 0;
+        for_each_live_mon(j)
+        {
+            if (distance(py, px, m_list[j].fy, m_list[j].fx) <= DETECT_RAD_DEFAULT) n[0]++;
+        }
+    }
+    ms[0] = _wiz_bench_ms(start);
+
+    start = clock();
+    for (i = 0; i < reps; i++) n[1] = mon_in_radius(py, px, DETECT_RAD_DEFAULT, who);
+    ms[1] = _wiz_bench_ms(start);
+
+    start = clock();
+    for (i = 0; i < reps; i++)
+    {
+        n[2] = 0;
+        for (j = 1; j < o_max; j++)
+        {
+            object_type *o_ptr = &o_list[j];
+
+            if (!o_ptr->k_idx || o_ptr->held_m_idx) continue;
+            if (distance(py, px, o_ptr->loc.y, o_ptr->loc.x) <= DETECT_RAD_DEFAULT) n[2]++;
+        }
+    }
+    ms[2] = _wiz_bench_ms(start);
+
+    start = clock();
+    for (i = 0; i < reps; i++) n[3] = obj_in_radius(py, px, DETECT_RAD_DEFAULT, who);
+    ms[3] = _wiz_bench_ms(start);
+
+    C_KILL(who, MAX(max_m_idx, max_o_idx), s16b);
+
+    fprintf(fff, "%d searches: monsters (%d) %d ms swept, %d ms indexed (%d); objects (%d) %d ms swept, %d ms indexed (%d); %d errors.\n",
+        reps, n[0], ms[0], ms[1], n[1], n[2], ms[2], ms[3], n[3], spatial_verify());
+}
+
+/*
+ * Time the terrain passability table against working each answer out,
+ * over every race and feature
+ */
+static void _wiz_bench_move(FILE *fff, int reps)
+{
+    int     i, r_idx, feat, ms[2], n = 0, bad = 0;
+    u32b    hits = mon_move_hits, misses = mon_move_misses;
+    clock_t start;
+
+    start = clock();
+    for (i = 0; i < reps; i++)
+    {
+        for (r_idx = 1; r_idx < max_r_idx; r_idx++)
+        {
+            monster_race *r_ptr = &r_info[r_idx];
+
+            if (!r_ptr->name) continue;
+            for (feat = 0; feat < max_f_idx; feat++)
+            {
+                if (monster_can_cross_terrain(feat, r_ptr, 0)) n++;
+            }
+        }
+    }
+    ms[0] = _wiz_bench_ms(start);
+
+    /* Both ways, for every pair */
+    start = clock();
+    for (i = 0; i < reps; i++) bad = mon_move_verify();
+    ms[1] = _wiz_bench_ms(start);
+
+    mon_move_hits = hits;
+    mon_move_misses = misses;
+
+    fprintf(fff, "%d passes (%d passable): %d ms from the table, %d ms worked out and compared; %d errors.\n",
+        reps, n / reps, ms[0], ms[1], bad);
+}
+
+/*
+ * Time is_autopick() over every object on the level and in the pack:
+ * with its cache, without it, and against trying every rule in turn
+ */
+static void _wiz_bench_autopick_pass(bool cache, int *n)
+{
+    int i;
+
+    *n = 0;
+    for (i = 1; i < o_max + pack_max(); i++)
+    {
+        object_type *o_ptr = (i < o_max) ? &o_list[i] : pack_obj(i - o_max + 1);
+
+        if (!o_ptr || !o_ptr->k_idx) continue;
+        if (!cache) autopick_forget();
+        if (is_autopick(o_ptr) >= 0) (*n)++;
+    }
+}
+
+static void _wiz_bench_autopick(FILE *fff, int reps)
+{
+    int     i, ms[3], n = 0, bad = 0;
+    clock_t start;
+
+    start = clock();
+    for (i = 0; i < reps; i++) _wiz_bench_autopick_pass(FALSE, &n);
+    ms[0] = _wiz_bench_ms(start);
+
+    start = clock();
+    for (i = 0; i < reps; i++) _wiz_bench_autopick_pass(TRUE, &n);
+    ms[1] = _wiz_bench_ms(start);
+
+    /* Every rule in turn, compared with the compiled answer */
+    start = clock();
+    for (i = 0; i < reps; i++) bad = autopick_verify();
+    ms[2] = _wiz_bench_ms(start);
+
+    fprintf(fff, "%d passes (%d matched of %d rules): %d ms compiled, %d ms cached, %d ms scanned and compared; %d errors.\n",
+        reps, n, max_autopick, ms[0], ms[1], ms[2], bad);
+}
+
+static long _wiz_bench_file_size(cptr name)
+{
+    long  size = 0;
+    FILE *fp = my_fopen(name, "rb");
+
+    if (fp)
+    {
+        fseek(fp, 0, SEEK_END);
+        size = ftell(fp);
+        my_fclose(fp);
+    }
+    return size;
+}
+
+/*
+ * Time save_player() with and without compression, then what an
+ * autosave on arrival costs: the floor and the game are handed to
+ * background writers, and the game goes on while they write. The time
+ * then spent waiting for the writers is what the game no longer waits.
+ */
+static void _wiz_bench_save(FILE *fff, int reps)
+{
+    int     i, pass, ms[2];
+    long    handed = 0, written = 0, start_usec;
+    long    size[2];
+    bool    old = compress_savefile;
+    clock_t start;
+    saved_floor_type *sf_ptr = get_sf_ptr(p_ptr->floor_id);
+
+    for (pass = 0; pass < 2; pass++)
+    {
+        compress_savefile = pass;
+        start = clock();
+        for (i = 0; i < reps; i++)
+            save_player();
+        ms[pass] = _wiz_bench_ms(start);
+        size[pass] = _wiz_bench_file_size(savefile);
+    }
+    compress_savefile = old;
+    save_player();
+
+    for (i = 0; i < reps; i++)
+    {
+        start_usec = _wiz_bench_usec();
+        if (sf_ptr) save_floor(sf_ptr, 0);
+        save_player_async();
+        handed += _wiz_bench_usec() - start_usec;
+
+        start_usec = _wiz_bench_usec();
+        savefile_wait(NULL);
+        written += _wiz_bench_usec() - start_usec;
+    }
+
+    fprintf(fff, "%d saves: %d ms for %ld bytes, %d ms compressed to %ld bytes.\n",
+        reps, ms[0], size[0], ms[1], size[1]);
+    fprintf(fff, "%d autosaves%s: %ld ms on arrival, %ld ms more in the background.\n",
+        reps, sf_ptr ? " with a floor" : "", handed / 1000, written / 1000);
+}
+
+/*
+ * Time adding new quarks, finding them again, and freeing them
+ */
+static void _wiz_bench_quark(FILE *fff, int reps)
+{
+    int     i, ms[3], freed, bad = 0;
+    s16b   *q;
+    char    buf[32];
+    clock_t start;
+
+    C_MAKE(q, reps, s16b);
+
+    start = clock();
+    for (i = 0; i < reps; i++)
+    {
+        sprintf(buf, "@bench%d", i);
+        q[i] = quark_add(buf);
+    }
+    ms[0] = _wiz_bench_ms(start);
+
+    start = clock();
+    for (i = 0; i < reps; i++)
+    {
+        sprintf(buf, "@bench%d", i);
+        if (quark_add(buf) != q[i] || !streq(quark_str(q[i]), buf)) bad++;
+    }
+    ms[1] = _wiz_bench_ms(start);
+
+    /* Nothing holds them */
+    start = clock();
+    freed = quark_collect();
+    ms[2] = _wiz_bench_ms(start);
+
+    C_KILL(q, reps, s16b);
+
+    fprintf(fff, "%d quarks: %d ms added, %d ms found again, %d ms to free %d; %d errors.\n",
+        reps, ms[0], ms[1], ms[2], freed, bad);
+}
+
+/*
+ * Time matching a long stream of keys against the macros, with the
+ * trie and by trying every macro
+ */
+#define _BENCH_KEYS 10000
+static void _wiz_bench_keys(FILE *fff, int reps)
+{
+    int     i = 0, ms[2];
+    u32b    h[2] = {0};
+    char   *keys;
+    clock_t start;
+
+    if (!macro__num)
+    {
+        fprintf(fff, "There are no macros.\n");
+        return;
+    }
+
+    /* Mostly macro triggers, some cut short, between ordinary keys */
+    C_MAKE(keys, _BENCH_KEYS + 1, char);
+    while (i < _BENCH_KEYS)
+    {
+        if (one_in_(3))
+            keys[i++] = 'a' + randint0(26);
+        else
+        {
+            cptr pat = macro__pat[randint0(macro__num)];
+            int  n = strlen(pat);
+
+            if (one_in_(4)) n = randint1(n);
+            while (n-- && i < _BENCH_KEYS) keys[i++] = *pat++;
+        }
+    }
+
+    start = clock();
+    for (i = 0; i < reps; i++) h[0] = macro_replay(keys, FALSE);
+    ms[0] = _wiz_bench_ms(start);
+
+    start = clock();
+    for (i = 0; i < reps; i++) h[1] = macro_replay(keys, TRUE);
+    ms[1] = _wiz_bench_ms(start);
+
+    C_KILL(keys, _BENCH_KEYS + 1, char);
+
+    fprintf(fff, "%d passes over %d keys, %d macros: %d ms by the trie, %d ms scanned; %d errors.\n",
+        reps, _BENCH_KEYS, macro__num, ms[0], ms[1], h[0] != h[1] ? 1 : 0);
+}
+
+/*
+ * Time calc_bonuses() with the equipment bonus cache and with every slot
+ * worked out afresh, then compare the two
+ */
+static void _wiz_bench_bonuses(FILE *fff, int reps)
+{
+    int     i, ms[2], bad;
+    clock_t start;
+
+    start = clock();
+    for (i = 0; i < reps; i++)
+    {
+        equip_forget_bonuses();
+        calc_bonuses();
+    }
+    ms[0] = _wiz_bench_ms(start);
+
+    start = clock();
+    for (i = 0; i < reps; i++) calc_bonuses();
+    ms[1] = _wiz_bench_ms(start);
+
+    bad = equip_verify_bonuses();
+
+    fprintf(fff, "%d passes, %d slots: %d ms afresh, %d ms cached; %d errors.\n",
+        reps, equip_count_used(), ms[0], ms[1], bad);
+}
+
+static struct
+{
+    cptr name;
+    int  reps;
+    void (*fn)(FILE *fff, int reps);
+} _wiz_benches[] =
+{
+    { "flow", 10000, _wiz_bench_flow },
+    { "view", 10000, _wiz_bench_view },
+    { "project", 1000, _wiz_bench_project },
+    { "rand", 10000, _wiz_bench_rand },
+    { "summon", 10000, _wiz_bench_summon },
+    { "breed", 10000, _wiz_bench_breed },
+    { "nearby", 10000, _wiz_bench_nearby },
+    { "move", 10, _wiz_bench_move },
+    { "save", 20, _wiz_bench_save },
+    { "autopick", 1000, _wiz_bench_autopick },
+    { "quark", 20000, _wiz_bench_quark },
+    { "keys", 100, _wiz_bench_keys },
+    { "bonuses", 10000, _wiz_bench_bonuses },
+    { NULL, 0, NULL }
+};
+
+/* Run the named benchmark (or all of them, for "all") <reps> times (or
+   a default number of times, if <reps> is not positive), printing the
+   results to <fff>. Returns FALSE if there is no such benchmark. */
+bool wiz_bench(FILE *fff, cptr name, int reps)
+{
+    int  i;
+    bool found = FALSE;
+
+    for (i = 0; _wiz_benches[i].name; i++)
+    {
+        if (!streq(name, "all") && !streq(name, _wiz_benches[i].name)) continue;
+        fprintf(fff, "%s: ", _wiz_benches[i].name);
+        _wiz_benches[i].fn(fff, reps > 0 ? reps : _wiz_benches[i].reps);
+        found = TRUE;
+    }
+    return found;
+}
+
 /*
  * Ask for and parse a "debug command"
  * The "command_arg" may have been set.
@@ -1689,6 +2717,34 @@ void do_cmd_debug(void)
         do_cmd_redraw();
         break;
     }
+    case '_':
+    {
+        /* Batch statistics over a range of depths (see above: no workers) */
+        int  which_dungeon = dungeon_type ? dungeon_type : DUNGEON_ANGBAND;
+        int  min_depth = get_quantity("Min Depth? ", MAX_DEPTH - 1);
+        int  max_depth = get_quantity("Max Depth? ", MAX_DEPTH - 1);
+        int  reps = get_quantity("How many reps per depth? ", 10000);
+        int  lost;
+        char buf[1024];
+        FILE *fff;
+
+        path_build(buf, sizeof(buf), ANGBAND_DIR_USER, "stats.csv");
+        fff = my_fopen(buf, "w");
+        if (!fff)
+        {
+            msg_format("Failed to open %s.", buf);
+            break;
+        }
+
+        lost = wiz_batch_stats(fff, which_dungeon, min_depth, max_depth, reps, 1);
+        my_fclose(fff);
+
+        if (lost)
+            msg_format("Lost the results of %d levels.", lost);
+        msg_format("Wrote %s.", buf);
+        do_cmd_redraw();
+        break;
+    }
     default:
         msg_print("That is not a valid debug command.");
         break;
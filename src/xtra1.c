@@ -5158,6 +5158,9 @@ void update_stuff(void)
     if (character_icky) return;
 
 
+    /* Draw each grid changed below just once, at the end */
+    lite_spot_batch_begin();
+
     if (p_ptr->update & (PU_UN_LITE))
     {
         p_ptr->update &= ~(PU_UN_LITE);
@@ -5220,6 +5223,8 @@ void update_stuff(void)
         p_ptr->update &= ~(PU_MONSTERS);
         update_monsters(FALSE);
     }
+
+    lite_spot_batch_end();
 }
 
 /*
@@ -5472,7 +5477,7 @@ void window_stuff(void)
  */
 void handle_stuff(void)
 {
-    if (p_ptr->update) update_stuff();
+    if (p_ptr->update && !update_hold) update_stuff();
     if (p_ptr->redraw) redraw_stuff();
     if (p_ptr->window) window_stuff();
 }
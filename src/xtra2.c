@@ -2443,7 +2443,7 @@ bool mon_take_hit(int m_idx, int dam, bool *fear, cptr note)
     if (p_ptr->prace == RACE_MON_RING && !p_ptr->riding)
     {
         m_ptr->mflag2 |= MFLAG2_AWARE;
-        for (i = 1; i < m_max; i++)
+        for_each_live_mon(i)
         {
             monster_type *m_ptr2 = &m_list[i];
 
@@ -42,6 +42,13 @@
  * automatically used instead of the "complex" RNG, and when you are
  * done, you de-activate it via "Rand_quick = FALSE" or choose a new
  * seed via "Rand_value = seed".
+ *
+ * The "complex" RNG is now PCG32 (O'Neill), which is better than the old
+ * degree 63 additive generator and about as fast. It runs as several
+ * independent streams (see RAND_STREAM_*), each with its own state and
+ * increment, and the one in use is chosen with Rand_stream_set(). The
+ * "simple" RNG is unchanged, since flavors and the wilderness depend on
+ * its exact output.
  */
 
 
@@ -65,14 +72,47 @@ u32b Rand_value;
 
 
 /*
- * Current "index" for the "complex" RNG
+ * Current "state" of each stream of the "complex" RNG
+ */
+rand_stream_t Rand_state[RAND_STREAMS];
+
+/*
+ * The stream in use
  */
-u16b Rand_place;
+int Rand_stream = RAND_STREAM_GAME;
 
 /*
- * Current "state" table for the "complex" RNG
+ * The state of the stream in use
  */
-u32b Rand_state[RAND_DEG];
+static rand_stream_t *Rand_cur = &Rand_state[RAND_STREAM_GAME];
+
+
+/*
+ * Cycle the "complex" RNG, giving 32 random bits (PCG32, "XSH RR")
+ */
+static inline u32b Rand_next(void)
+{
+    unsigned long long old = Rand_cur->state;
+    u32b x = (u32b)(((old >> 18) ^ old) >> 27);
+    u32b r = (u32b)(old >> 59);
+
+    Rand_cur->state = old * 6364136223846793005ULL + Rand_cur->inc;
+
+    return (x >> r) | (x << ((0U - r) & 31));
+}
+
+
+/*
+ * Scramble a 32 bit value (the "splitmix" finalizer)
+ */
+static u32b Rand_mix(u32b *x)
+{
+    u32b z = (*x += 0x9E3779B9);
+
+    z = (z ^ (z >> 16)) * 0x85EBCA6B;
+    z = (z ^ (z >> 13)) * 0xC2B2AE35;
+    return (z ^ (z >> 16));
+}
 
 
 /*
@@ -80,34 +120,91 @@ u32b Rand_state[RAND_DEG];
  */
 void Rand_state_init(u32b seed)
 {
-    int i, j;
+    Rand_state_init_from(RAND_STREAM_GAME, seed);
+}
+
+
+/*
+ * Initialize the streams from "first" on using a new seed, leaving the
+ * ones before alone (for savefiles older than the later streams)
+ */
+void Rand_state_init_from(int first, u32b seed)
+{
+    int i;
+
+    /* Every stream gets its own state, and its own (odd) increment */
+    for (i = first; i < RAND_STREAMS; i++)
+    {
+        Rand_state[i].state = Rand_mix(&seed);
+        Rand_state[i].state = (Rand_state[i].state << 32) | Rand_mix(&seed);
+        Rand_state[i].inc = Rand_mix(&seed);
+        Rand_state[i].inc = (Rand_state[i].inc << 32) | Rand_mix(&seed) | 1;
+    }
+
+    Rand_stream_set(RAND_STREAM_GAME);
+}
+
+
+/*
+ * Initialize the "complex" RNG from the state of the old one
+ */
+void Rand_state_init_old(u16b place, const u32b *table)
+{
+    u32b seed = place;
+    int i;
+
+    for (i = 0; i < RAND_DEG; i++) seed = Rand_mix(&seed) ^ table[i];
+
+    Rand_state_init(seed);
+}
+
+
+/*
+ * Draw from another stream of the "complex" RNG
+ *
+ * Returns the stream that was in use, to be restored when done.
+ */
+int Rand_stream_set(int stream)
+{
+    int old = Rand_stream;
 
-    /* Seed the table */
-    Rand_state[0] = seed;
+    Rand_stream = stream;
+    Rand_cur = &Rand_state[stream];
+    return (old);
+}
 
-    /* Propagate the seed */
-    for (i = 1; i < RAND_DEG; i++) Rand_state[i] = LCRNG(Rand_state[i-1]);
 
-    /* Cycle the table ten times per degree */
-    for (i = 0; i < RAND_DEG * 10; i++)
+/*
+ * Extract a "random" number from 0 to m-1 using the "complex" RNG
+ *
+ * This scales a 32-bit number up to a 64-bit fixed point product and
+ * keeps the high half, rejecting the few low halves that would make
+ * some results more likely than others (Lemire's method). It has no
+ * bias, and usually needs no division at all.
+ */
+static u32b Rand_range(u32b m)
+{
+    unsigned long long p;
+
+    while (1)
     {
-        /* Acquire the next index */
-        j = Rand_place + 1;
-        if (j == RAND_DEG) j = 0;
+        p = (unsigned long long)Rand_next() * m;
 
-        /* Update the table, extract an entry */
-        Rand_state[j] += Rand_state[Rand_place];
+        /* Nearly always */
+        if ((u32b)p >= m) break;
 
-        /* Advance the index */
-        Rand_place = j;
+        /* Reject the lowest (2^32 % m) values */
+        if ((u32b)p >= (0U - m) % m) break;
     }
+
+    return (u32b)(p >> 32);
 }
 
 
 /*
  * Extract a "random" number from 0 to m-1, via "division"
  *
- * This method selects "random" 28-bit numbers, and then uses
+ * The "simple" RNG selects "random" 28-bit numbers, and then uses
  * division to drop those numbers into "m" different partitions,
  * plus a small non-partition to reduce bias, taking as the final
  * value the first "good" partition that a number falls into.
@@ -122,50 +219,23 @@ s32b Rand_div(u32b m)
     /* Hack -- simple case */
     if (m <= 1) return (0);
 
+    /* Use the complex RNG */
+    if (!Rand_quick) return (s32b)Rand_range(m);
+
     /* Partition size */
     n = (0x10000000 / m);
 
-    /* Use a simple RNG */
-    if (Rand_quick)
+    /* Use the simple RNG */
+    while (1)
     {
-        /* Wait for it */
-        while (1)
-        {
-            /* Cycle the generator */
-            r = (Rand_value = LCRNG(Rand_value));
+        /* Cycle the generator */
+        r = (Rand_value = LCRNG(Rand_value));
 
-            /* Mutate a 28-bit "random" number */
-            r = (r >> 4) / n;
+        /* Mutate a 28-bit "random" number */
+        r = (r >> 4) / n;
 
-            /* Done */
-            if (r < m) break;
-        }
-    }
-
-    /* Use a complex RNG */
-    else
-    {
-        /* Wait for it */
-        while (1)
-        {
-            int j;
-
-            /* Acquire the next index */
-            j = Rand_place + 1;
-            if (j == RAND_DEG) j = 0;
-
-            /* Update the table, extract an entry */
-            r = (Rand_state[j] += Rand_state[Rand_place]);
-
-            /* Hack -- extract a 28-bit "random" number */
-            r = (r >> 4) / n;
-
-            /* Advance the index */
-            Rand_place = j;
-
-            /* Done */
-            if (r < m) break;
-        }
+        /* Done */
+        if (r < m) break;
     }
 
     /* Use the value */
@@ -252,6 +322,7 @@ s16b randnor(int mean, int stand)
 {
     s16b tmp;
     s16b offset;
+    bool neg;
 
     s16b low = 0;
     s16b high = RANDNOR_NUM;
@@ -259,8 +330,21 @@ s16b randnor(int mean, int stand)
     /* Paranoia */
     if (stand < 1) return (mean);
 
-    /* Roll for probability */
-    tmp = (s16b)randint0(32768);
+    /* Roll for probability (and for the sign) */
+    if (Rand_quick)
+    {
+        tmp = (s16b)randint0(32768);
+        neg = (randint0(100) < 50);
+    }
+
+    /* One draw of the complex RNG has bits enough for both */
+    else
+    {
+        u32b r = Rand_next();
+
+        tmp = (s16b)(r & 0x7FFF);
+        neg = (r >> 31) ? TRUE : FALSE;
+    }
 
     /* Binary Search */
     while (low < high)
@@ -284,7 +368,7 @@ s16b randnor(int mean, int stand)
     offset = (s16b)((long)stand * (long)low / RANDNOR_STD);
 
     /* One half should be negative */
-    if (randint0(100) < 50) return (mean - offset);
+    if (neg) return (mean - offset);
 
     /* One half should be positive */
     return (mean + offset);
@@ -298,7 +382,25 @@ s16b randnor(int mean, int stand)
 s16b damroll(int num, int sides)
 {
     int i, sum = 0;
-    for (i = 0; i < num; i++) sum += randint1(sides);
+    u32b t;
+
+    if (Rand_quick || sides <= 1)
+    {
+        for (i = 0; i < num; i++) sum += randint1(sides);
+        return (sum);
+    }
+
+    /* As Rand_range(), but working out the rejection limit only once */
+    t = (0U - (u32b)sides) % (u32b)sides;
+    for (i = 0; i < num; i++)
+    {
+        unsigned long long p;
+
+        do p = (unsigned long long)Rand_next() * (u32b)sides;
+        while ((u32b)p < t);
+
+        sum += (int)(p >> 32) + 1;
+    }
     return (sum);
 }
 
@@ -20,11 +20,35 @@
 
 
 /*
- * Random Number Generator -- Degree of "complex" RNG -- see "misc.c"
- * This value is hard-coded at 63 for a wide variety of reasons.
+ * Random Number Generator -- Degree of the old "complex" RNG
+ * Only needed to read it from old savefiles.
  */
 #define RAND_DEG 63
 
+/*
+ * Random Number Generator -- Independent streams of the "complex" RNG
+ * Each part of the game draws from its own stream, so that (say) an
+ * extra roll in combat does not change the next level generated.
+ */
+#define RAND_STREAM_GAME    0    /* Everything else */
+#define RAND_STREAM_GEN     1    /* Level generation */
+#define RAND_STREAM_AI      2    /* Monster turns */
+#define RAND_STREAM_COMBAT  3    /* Melee and missile attacks */
+#define RAND_STREAM_VIEW    4    /* Map display (never affects play) */
+#define RAND_STREAMS        5
+
+
+/**** Available types ****/
+
+/*
+ * The state of one stream of the "complex" RNG (PCG32)
+ */
+typedef struct
+{
+    unsigned long long state;
+    unsigned long long inc;    /* Always odd */
+} rand_stream_t;
+
 
 
 
@@ -85,13 +109,16 @@
 
 extern bool Rand_quick;
 extern u32b Rand_value;
-extern u16b Rand_place;
-extern u32b Rand_state[RAND_DEG];
+extern rand_stream_t Rand_state[RAND_STREAMS];
+extern int Rand_stream;
 
 
 /**** Available Functions ****/
 
 extern void Rand_state_init(u32b seed);
+extern void Rand_state_init_from(int first, u32b seed);
+extern void Rand_state_init_old(u16b place, const u32b *table);
+extern int Rand_stream_set(int stream);
 extern s32b Rand_div(u32b m);
 extern s16b randnor(int mean, int stand);
 extern s16b damroll(int num, int sides);